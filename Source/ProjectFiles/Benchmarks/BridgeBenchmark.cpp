@@ -0,0 +1,153 @@
+/*******************************************************
+	Benchmark for the bridge index in BridgeIndex.h.
+	Doesn't need the game or Windows, and is not part of Code.vcxproj.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source BridgeBenchmark.cpp -o BridgeBenchmark && ./BridgeBenchmark
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source BridgeBenchmark.cpp
+
+	Builds indexes of 10k and 500k bridge cells laid out like real bridges (3 wide, 1 high, wandering over the map)
+	and times the same queries against both, which should cost about the same. Also prints the heap bytes per cell
+	and how well the save runs compress. Returns 1 if a query gives a different answer than a brute force scan.
+*******************************************************/
+
+#include "BridgeIndex.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <set>
+#include <tuple>
+
+static std::atomic<uint64_t> AllocatedBytes = 0;
+
+void* operator new(size_t Size)
+{
+	AllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+	if (void* Memory = std::malloc(Size ? Size : 1)) return Memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* Memory) noexcept { std::free(Memory); }
+void operator delete(void* Memory, size_t) noexcept { std::free(Memory); }
+
+using namespace ModAPI;
+
+using Clock = std::chrono::steady_clock;
+
+static double Microseconds(Clock::time_point Since)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - Since).count();
+}
+
+// Bridge cells along a random walk, all of them replaced air except every tenth segment which replaced foliage
+static std::vector<std::pair<CoordinateInBlocks, BlockInfo>> MakeBridges(size_t Cells, uint32_t Seed)
+{
+	std::mt19937 Random(Seed);
+	std::vector<std::pair<CoordinateInBlocks, BlockInfo>> Result;
+	CoordinateInBlocks At(0, 0, 200);
+
+	for (int Segment = 0; Result.size() < Cells; Segment++) {
+		const BlockInfo Original(Segment % 10 == 0 ? EBlockType::GrassFoliage : EBlockType::Air);
+		const int DX = int(Random() % 3) - 1, DY = DX == 0 ? (Random() % 2 ? 1 : -1) : 0;
+		for (int Step = 0; Step < 40 && Result.size() < Cells; Step++) {
+			At = At + CoordinateInBlocks(DX, DY, 0);
+			for (int Side = -1; Side <= 1 && Result.size() < Cells; Side++) {
+				Result.emplace_back(At + CoordinateInBlocks(DY * Side, DX * Side, 0), Original);
+			}
+		}
+		At.Z = int16_t(std::clamp(At.Z + int(Random() % 3) - 1, 100, 300));
+	}
+	return Result;
+}
+
+static bool Run(size_t Cells)
+{
+	const auto Cloud = MakeBridges(Cells, 7);
+
+	const uint64_t BytesBefore = AllocatedBytes.load();
+	Clock::time_point Start = Clock::now();
+	Bridges::Index Index;
+	for (const auto& [At, Original] : Cloud) Index.Add(At, Original);
+	const double AddMicroseconds = Microseconds(Start);
+	const uint64_t IndexBytes = AllocatedBytes.load() - BytesBefore;
+
+	std::printf("%zu cells (%zu distinct) in %zu chunks, %.1f bytes per cell, Add %.0f ns per cell\n", Cells, Index.Size(),
+		Index.ChunkCount(), double(IndexBytes) / Index.Size(), AddMicroseconds * 1000 / Cloud.size());
+
+	// Contains, hits and misses
+	std::mt19937 Random(1);
+	const int Lookups = 1000000;
+	size_t Hits = 0;
+	Start = Clock::now();
+	for (int i = 0; i < Lookups; i++) {
+		const auto& [At, Original] = Cloud[Random() % Cloud.size()];
+		Hits += Index.Contains(At + CoordinateInBlocks(0, 0, int16_t(i & 1)));
+	}
+	std::printf("	Contains            %7.1f ns (%zu of %d hit)\n", Microseconds(Start) * 1000 / Lookups, Hits, Lookups);
+
+	// Clouds near me, radius 8 around points on the bridge
+	const int Queries = 20000;
+	size_t Found = 0;
+	Start = Clock::now();
+	for (int i = 0; i < Queries; i++) {
+		Index.ForEachNear(Cloud[Random() % Cloud.size()].first, 8, [&](const CoordinateInBlocks&, const BlockInfo&) { Found++; });
+	}
+	std::printf("	ForEachNear(8)      %7.2f us (%.0f cells each)\n", Microseconds(Start) / Queries, double(Found) / Queries);
+
+	// Against a brute force scan around one point, the walk crosses itself so the same cell can be in Cloud twice
+	bool Passed = true;
+	const CoordinateInBlocks Center = Cloud[Cloud.size() / 2].first;
+	std::set<std::tuple<int64_t, int64_t, int16_t>> Expected;
+	size_t Actual = 0;
+	for (const auto& [At, Original] : Cloud) {
+		if ((At - Center).GetLengthSquared() <= 8 * 8) Expected.emplace(At.X, At.Y, At.Z);
+	}
+	Index.ForEachNear(Center, 8, [&](const CoordinateInBlocks&, const BlockInfo&) { Actual++; });
+	if (Expected.size() != Actual) {
+		std::printf("	FAIL: ForEachNear found %zu cells, brute force %zu\n", Actual, Expected.size());
+		Passed = false;
+	}
+
+	// Save runs, then again after one cell changed
+	Start = Clock::now();
+	auto Snapshot = Index.SnapshotRuns();
+	const double FirstSnapshot = Microseconds(Start);
+	size_t RunCount = 0, RunCells = 0;
+	for (const auto& Runs : Snapshot) {
+		RunCount += Runs->size();
+		for (const Bridges::Run& Current : *Runs) RunCells += Current.Length;
+	}
+	Index.Remove(Cloud[Cloud.size() / 3].first);
+	Start = Clock::now();
+	Snapshot = Index.SnapshotRuns();
+	std::printf("	SnapshotRuns        %7.0f us first, %.0f us after one change, %zu runs (%.1f cells per run)\n", FirstSnapshot,
+		Microseconds(Start), RunCount, double(RunCells) / RunCount);
+	if (RunCells != Index.Size() + 1) {
+		std::printf("	FAIL: runs hold %zu cells, the index %zu\n", RunCells, Index.Size() + 1);
+		Passed = false;
+	}
+
+	// Remove bridge segment, one segment from the middle of the walk
+	const CoordinateInBlocks SegmentStart = Cloud[Cloud.size() / 2].first;
+	Start = Clock::now();
+	Bridges::SegmentRemoval Removal(Index, SegmentStart);
+	size_t Steps = 1;
+	while (!Removal.Step(Index, 256, [](const CoordinateInBlocks&, const BlockInfo&) {})) Steps++;
+	std::printf("	SegmentRemoval      %7.2f us per cell (%zu cells in %zu steps)\n", Microseconds(Start) / std::max<size_t>(Removal.GetRemovedCount(), 1),
+		Removal.GetRemovedCount(), Steps);
+	if (Index.Contains(SegmentStart)) {
+		std::printf("	FAIL: the segment is still there\n");
+		Passed = false;
+	}
+	return Passed;
+}
+
+int main()
+{
+	const bool Small = Run(10000);
+	const bool Large = Run(500000);
+	return Small && Large ? 0 : 1;
+}
@@ -0,0 +1,293 @@
+/*******************************************************
+	Replays a flight recorder dump (see FlightRecorder.h) through the whole mod on a headless host, and prints the
+	ticks that led up to the anomaly that wrote it.
+
+	The host only knows what the dump does: the player's feet, hands and head every tick, the block under the feet
+	as the fall guard read it, the platform when the dump was written and every platform write before that. The
+	platform and the blocks it replaced at the first recorded tick are worked out backwards from those, everything
+	else is air. The mod starts from the recorded platform height and gets the recorded ticks one by one, with the
+	radius, shape, plane and bridge settings the player had on each. Every replayed tick is compared with the
+	recorded one: cells placed, restored and refused, rescues and the platform height. The gesture engine and the
+	footprint's motion tracker start without any history, so the first ticks can differ.
+
+	Returns 1 if the dump can't be read. Doesn't need the game or Windows, and is not part of Code.vcxproj. Writes
+	FlightReplay.txt, the mod's save file, to the working directory, and the replay's own dumps next to it.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source FlightReplay.cpp -o FlightReplay -lpthread && ./FlightReplay <dump.flight> [ticks shown]
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source FlightReplay.cpp && FlightReplay <dump.flight> [ticks shown]
+
+	Ticks shown is how many ticks up to the anomaly are printed, 40 without it.
+*******************************************************/
+
+struct ReplayHost;
+#define CLOUDWALKER_HOST_BACKEND ReplayHost
+#include "HostBackend.h"
+
+using namespace ModAPI;
+
+// The player and the world come from the dump, everything else is HostBackends::Null
+struct ReplayHost : HostBackends::Null {
+	static void Log(const wchar_t* String);
+	static BlockInfo GetBlock(const CoordinateInBlocks& At);
+	static bool SetBlock(const CoordinateInBlocks& At, const BlockInfo& BlockType, BlockInfo& OutReplacedType);
+	static CoordinateInCentimeters GetPlayerLocation();
+	static bool SetPlayerLocation(const CoordinateInCentimeters& To);
+	static CoordinateInCentimeters GetPlayerLocationHead();
+	static CoordinateInCentimeters GetHandLocation(bool LeftHand);
+	static const wchar_t* GetWorldName();
+	static bool ModuleDirectory(std::wstring& Out);
+};
+
+// GameAPI.cpp has an empty main of its own
+#define main ModMain
+#include "Mod.cpp"
+#include "GameAPI.cpp"
+#undef main
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+
+const int Default_Ticks_Shown = 40;
+
+namespace Replay {
+
+	// Every block the dump says anything about, the rest of the world is air
+	std::unordered_map<uint64_t, BlockInfo> World;
+
+	FlightRecorder::TickRecord Recorded;	// The tick being replayed
+	CoordinateInCentimeters Player;
+	CoordinateInCentimeters Head;
+	CoordinateInCentimeters LeftHand;
+	CoordinateInCentimeters RightHand;
+
+	uint64_t Key(const CoordinateInBlocks& At)
+	{
+		return (uint64_t(At.X) & 0xFFFFFF) | ((uint64_t(At.Y) & 0xFFFFFF) << 24) | ((uint64_t(At.Z) & 0xFFFF) << 48);
+	}
+
+	CoordinateInCentimeters FromFeet(const int32_t (&Offset)[3])
+	{
+		return CoordinateInCentimeters(Player.X + Offset[0], Player.Y + Offset[1], uint16_t(int32_t(Player.Z) + Offset[2]));
+	}
+
+	// What the host answers while Recorded is replayed
+	void Enter(const FlightRecorder::TickRecord& Record)
+	{
+		Recorded = Record;
+		if (Record.Has(FlightRecorder::PlayerRead)) Player = Record.Player();
+		if (Record.Has(FlightRecorder::HandsRead)) {
+			Head = FromFeet(Record.Head);
+			LeftHand = FromFeet(Record.LeftHand);
+			RightHand = FromFeet(Record.RightHand);
+		}
+	}
+
+	// What the player chose with their tools, as it was at the end of the recorded tick
+	void ApplySettings(const FlightRecorder::TickRecord& Record)
+	{
+		platformRadius = std::clamp(int(Record.PlatformRadius), Minimum_Platform_Radius, Maximum_Platform_Radius);
+		platformShape = Footprints::Shape(std::min<uint8_t>(Record.PlatformShape, uint8_t(Footprints::Shape::Count) - 1));
+		singlePlanePlatform = Record.Has(FlightRecorder::SinglePlane);
+		bridgeMode = Record.Has(FlightRecorder::Bridging);
+	}
+
+	// The platform and the world as they were before the first recorded tick, undoing every write from the last one back
+	void Rebuild(const FlightRecorder::Dump& Input, std::vector<Cloud>& Platform)
+	{
+		std::unordered_map<uint64_t, Cloud> Cells;
+		for (const FlightRecorder::CellRecord& Cell : Input.Platform) Cells.emplace(Key(Cell.At()), Cloud(Cell.At(), Cell.Block()));
+
+		for (auto Edit = Input.Edits.rbegin(); Edit != Input.Edits.rend(); ++Edit) {
+			if (Edit->Kind == uint8_t(FlightRecorder::EditKind::Placed)) Cells.erase(Key(Edit->At()));
+			else if (Edit->Kind == uint8_t(FlightRecorder::EditKind::Restored)) Cells[Key(Edit->At())] = Cloud(Edit->At(), Edit->Block());
+		}
+
+		World.clear();
+		Platform.clear();
+		for (const auto& [CellKey, Cell] : Cells) {
+			World[CellKey] = BlockInfo(Cloud_Block);
+			Platform.push_back(Cell);
+		}
+
+		// Where the first write placed a cloud, the block it replaced was there before
+		for (const FlightRecorder::EditRecord& Edit : Input.Edits) {
+			World.emplace(Key(Edit.At()), Edit.Kind == uint8_t(FlightRecorder::EditKind::Placed) ? Edit.Block() : BlockInfo(Cloud_Block));
+		}
+	}
+}
+
+// Host functions
+//********************************
+void ReplayHost::Log(const wchar_t* String)
+{
+	std::printf("  log: %ls\n", String);
+}
+
+// A block the dump doesn't know about is air, except the one under the feet the fall guard read on this tick
+BlockInfo ReplayHost::GetBlock(const CoordinateInBlocks& At)
+{
+	auto Found = Replay::World.find(Replay::Key(At));
+	if (Found != Replay::World.end()) return Found->second;
+
+	if (Replay::Recorded.Has(FlightRecorder::PlayerRead)) {
+		const CoordinateInBlocks UnderFoot = Replay::Recorded.Player() - CoordinateInCentimeters(0, 0, 25);
+		if (UnderFoot == At) return Replay::Recorded.UnderFoot();
+	}
+	return BlockInfo(EBlockType::Air);
+}
+
+bool ReplayHost::SetBlock(const CoordinateInBlocks& At, const BlockInfo& BlockType, BlockInfo& OutReplacedType)
+{
+	OutReplacedType = GetBlock(At);
+	if (At.Z < World_Min_Height || At.Z > World_Max_Height) return false;
+	Replay::World[Replay::Key(At)] = BlockType;
+	return true;
+}
+
+CoordinateInCentimeters ReplayHost::GetPlayerLocation()
+{
+	return Replay::Player;
+}
+
+// Only until the next tick, which puts the player where the game had them
+bool ReplayHost::SetPlayerLocation(const CoordinateInCentimeters& To)
+{
+	Replay::Player = To;
+	return true;
+}
+
+CoordinateInCentimeters ReplayHost::GetPlayerLocationHead()
+{
+	return Replay::Head;
+}
+
+CoordinateInCentimeters ReplayHost::GetHandLocation(bool LeftHand)
+{
+	return LeftHand ? Replay::LeftHand : Replay::RightHand;
+}
+
+const wchar_t* ReplayHost::GetWorldName()
+{
+	return L"FlightReplay";
+}
+
+// The save file goes to the working directory
+bool ReplayHost::ModuleDirectory(std::wstring& Out)
+{
+	Out.clear();
+	return true;
+}
+
+// Printing
+//********************************
+void PrintFlags(const FlightRecorder::TickRecord& Record)
+{
+	const struct { FlightRecorder::Flag Which; char Letter; } Letters[] = {
+		{ FlightRecorder::CloudWalking, 'w' }, { FlightRecorder::SinglePlane, '1' }, { FlightRecorder::GestureEngaged, 'g' },
+		{ FlightRecorder::Descending, 'v' }, { FlightRecorder::Autopilot, 'a' }, { FlightRecorder::Bridging, 'b' }, { FlightRecorder::Rescued, 'R' }, { FlightRecorder::Caught, 'C' }
+	};
+	for (const auto& Letter : Letters) std::printf("%c", Record.Has(Letter.Which) ? Letter.Letter : '.');
+}
+
+void PrintTick(const FlightRecorder::TickRecord& Record, const FlightRecorder::TickRecord& Replayed)
+{
+	std::printf("%8llu %9lld %9lld %6d %4d/%-6u %5d r%u ", (unsigned long long) Record.Tick, (long long) Record.PlayerX, (long long) Record.PlayerY,
+		int(Record.PlayerZ), int(Record.UnderFootType), Record.UnderFootCustomBlockID, int(Record.PlatformHeight), unsigned(Record.PlatformRadius));
+	PrintFlags(Record);
+	std::printf(" %+3d %4u %4u %3u %6d %6d %6d  | %4u %4u ", int(Record.ClimbBlocks), unsigned(Record.Placed), unsigned(Record.Restored),
+		unsigned(Record.FailedWrites), Record.TickMicroseconds, Record.SaveSnapshotMicroseconds, Record.SaveWriteMicroseconds,
+		unsigned(Replayed.Placed), unsigned(Replayed.Restored));
+	PrintFlags(Replayed);
+	for (size_t Kind = 0; Kind < size_t(FlightRecorder::Anomaly::Count); Kind++) {
+		if (Record.Anomalies & (1 << Kind)) std::printf(" %ls", FlightRecorder::Anomaly_Names[Kind]);
+	}
+	std::printf("\n");
+}
+
+bool IsSameTick(const FlightRecorder::TickRecord& Record, const FlightRecorder::TickRecord& Replayed)
+{
+	return Record.Placed == Replayed.Placed && Record.Restored == Replayed.Restored && Record.FailedWrites == Replayed.FailedWrites
+		&& Record.Has(FlightRecorder::Rescued) == Replayed.Has(FlightRecorder::Rescued) && Record.PlatformHeight == Replayed.PlatformHeight;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		std::printf("usage: FlightReplay <dump.flight> [ticks shown]\n");
+		return 1;
+	}
+	const size_t TicksShown = argc > 2 ? size_t(std::strtoul(argv[2], nullptr, 10)) : Default_Ticks_Shown;
+
+	std::ifstream File(argv[1], std::ios::binary);
+	if (!File.is_open()) {
+		std::printf("Can't open %s\n", argv[1]);
+		return 1;
+	}
+	const std::vector<uint8_t> Bytes((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+	FlightRecorder::Dump Input;
+	if (!FlightRecorder::Decode(Bytes.data(), Bytes.size(), Input) || Input.Ticks.empty() || Input.Header.Reason >= uint32_t(FlightRecorder::Anomaly::Count)) {
+		std::printf("%s is not a flight recorder dump of version %u\n", argv[1], FlightRecorder::File_Version);
+		return 1;
+	}
+
+	const FlightRecorder::FileHeader& Header = Input.Header;
+	const FlightRecorder::TickRecord& First = Input.Ticks.front();
+	int64_t TickTotal = 0, TickMax = 0, SaveMax = 0;
+	for (const FlightRecorder::TickRecord& Record : Input.Ticks) {
+		TickTotal += Record.TickMicroseconds;
+		TickMax = std::max<int64_t>(TickMax, Record.TickMicroseconds);
+		SaveMax = std::max<int64_t>(SaveMax, std::max(Record.SaveSnapshotMicroseconds, Record.SaveWriteMicroseconds));
+	}
+	std::printf("%ls at tick %llu: ticks %llu to %llu (%.1f s), %zu platform writes, %zu platform cells at the end\n",
+		FlightRecorder::Anomaly_Names[Header.Reason], (unsigned long long) Header.ReasonTick, (unsigned long long) First.Tick,
+		(unsigned long long) Input.Ticks.back().Tick, double(Input.Ticks.size()) / TickRate, Input.Edits.size(), Input.Platform.size());
+	std::printf("ticks took %lld us on average, %lld us at most, the slowest save %lld us\n\n",
+		(long long) (TickTotal / int64_t(Input.Ticks.size())), (long long) TickMax, (long long) SaveMax);
+
+	// The tasks run on the same ticks as in the game when the scheduler's tick is the same modulo every period
+	jobPool.Start();
+	ScheduleTasks();
+	ConfigureGestures();
+	uint64_t Cycle = 1;
+	for (const Scheduling::Task& Task : scheduler.GetTasks()) Cycle = std::lcm(Cycle, uint64_t(Task.PeriodTicks));
+	while (scheduler.GetTicks() % Cycle != First.Tick % Cycle) Event_Tick();
+
+	Replay::Rebuild(Input, platformCoords);
+	platformBoundsDirty = true;
+	platformHeight = First.PlatformHeight;
+	cloudWalkingEnabled = First.Has(FlightRecorder::CloudWalking);
+
+	// Flags: w cloud walking, 1 single plane, g gesture, v descending, a autopilot, b bridging, R rescued, C caught sinking
+	std::printf("    tick    feet X    feet Y feet Z under foot  plat  r flags   climb put back fail tick us  save snapshot/write | replayed\n");
+	size_t Same = 0;
+	uint64_t FirstDifference = 0;
+	bool Differed = false, Reproduced = false;
+	for (size_t i = 0; i < Input.Ticks.size(); i++) {
+		const FlightRecorder::TickRecord& Record = Input.Ticks[i];
+		Replay::Enter(Record);
+		Replay::ApplySettings(Record);
+		Event_Tick();
+		const FlightRecorder::TickRecord& Replayed = flightRecorder.Last();
+
+		if (IsSameTick(Record, Replayed)) Same++;
+		else if (!Differed) {
+			Differed = true;
+			FirstDifference = Record.Tick;
+		}
+		if (Record.Tick == Header.ReasonTick) Reproduced = (Replayed.Anomalies & (1 << Header.Reason)) != 0;
+
+		if (Record.Tick <= Header.ReasonTick && Header.ReasonTick - Record.Tick < TicksShown) PrintTick(Record, Replayed);
+	}
+
+	std::printf("\n%zu of %zu ticks replayed with the same writes, rescues and platform height", Same, Input.Ticks.size());
+	if (Differed) std::printf(", the first difference at tick %llu", (unsigned long long) FirstDifference);
+	std::printf("\nthe %ls at tick %llu %s in the replay\n", FlightRecorder::Anomaly_Names[Header.Reason], (unsigned long long) Header.ReasonTick,
+		Reproduced ? "happened again" : "did not happen");
+
+	jobPool.Join();
+	return 0;
+}
@@ -0,0 +1,260 @@
+/*******************************************************
+	Replays walking traces under every platform footprint (Footprint.h) and reports, per shape and radius, the cells
+	placed and restored per tick, the cells in each platform, the ticks the player's block wasn't covered and the
+	closest the player came to the edge. The platform is rebuilt every Platform_Tick_Interval ticks around the
+	player's block, as RunPlatformMaintenance does. Returns 1 if, on any trace, a stretched footprint leaves the
+	player uncovered on more ticks than the disc of the same radius, or lets them closer to the edge than the smallest
+	disc does. Doesn't need the game or Windows, and is not part of Code.vcxproj.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source FootprintReplay.cpp -o FootprintReplay && ./FootprintReplay [trace.csv ...]
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source FootprintReplay.cpp
+
+	A trace is one sample per tick at 40 ticks a second: tick,x,y with the player's feet in cm. Lines that don't start
+	with a digit (or a minus) are skipped. Without arguments a fixed set of synthetic traces (walking with head sway,
+	stops, reversals, running, autopilot flights) is replayed, --write <file> saves those as CSV.
+*******************************************************/
+
+#include "GameUtilities.cpp"
+#include "Footprint.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+struct TraceSample {
+	int64_t Tick = 0;
+	int64_t X = 0;
+	int64_t Y = 0;
+};
+
+struct Trace {
+	std::string Name;
+	std::vector<TraceSample> Samples;
+};
+
+const int Minimum_Platform_Radius = 2;
+const int Maximum_Platform_Radius = 4;
+const int Platform_Tick_Interval = 4;
+const int Trace_Ticks = 2400;
+
+// One leg of a synthetic trace: Ticks ticks at Speed cm per tick, turning by Turn radians first
+struct Leg {
+	int Ticks;
+	double Speed;
+	double Turn;
+};
+
+Trace MakeSyntheticTrace(const char* Name, uint64_t Seed, const std::vector<Leg>& Legs, int64_t SwayCm, double Wander)
+{
+	RandomStream Random = MakeRandomStream(Seed);
+	auto Sway = [&]() { return SwayCm == 0 ? int64_t(0) : int64_t(Random.Next() % uint64_t(2 * SwayCm + 1)) - SwayCm; };
+
+	Trace Output;
+	Output.Name = Name;
+	double X = 1000, Y = 2000, Heading = 0.35;
+	int64_t Tick = 0;
+
+	while (Tick < Trace_Ticks) {
+		for (const Leg& Step : Legs) {
+			Heading += Step.Turn;
+			for (int i = 0; i < Step.Ticks && Tick < Trace_Ticks; i++) {
+				if (Wander > 0) Heading += (double(Random.Next() % 2001) / 1000.0 - 1.0) * Wander;
+				X += std::cos(Heading) * Step.Speed;
+				Y += std::sin(Heading) * Step.Speed;
+				Output.Samples.push_back(TraceSample{ Tick++, int64_t(std::lround(X)) + Sway(), int64_t(std::lround(Y)) + Sway() });
+			}
+		}
+	}
+	return Output;
+}
+
+std::vector<Trace> MakeSyntheticTraces()
+{
+	const double Quarter = 1.5707963267948966;
+
+	std::vector<Trace> Traces;
+	Traces.push_back(MakeSyntheticTrace("walking straight", 1, { { 400, 5, 0 } }, 2, 0));
+	Traces.push_back(MakeSyntheticTrace("wandering", 2, { { 400, 4, 0 } }, 2, 0.1));
+	Traces.push_back(MakeSyntheticTrace("strolling", 8, { { 400, 3, 0 } }, 3, 0.05));
+	Traces.push_back(MakeSyntheticTrace("zigzag", 3, { { 80, 5, Quarter * 2 / 3 }, { 80, 5, -Quarter * 4 / 3 } }, 2, 0));
+	Traces.push_back(MakeSyntheticTrace("stop and go", 4, { { 120, 5, 0.5 }, { 80, 0, 0 } }, 3, 0));
+	Traces.push_back(MakeSyntheticTrace("reversals", 5, { { 120, 5, 0 }, { 120, 5, 2 * Quarter } }, 2, 0));
+	Traces.push_back(MakeSyntheticTrace("running, sharp turns", 6, { { 60, 12, Quarter }, { 60, 12, -Quarter } }, 3, 0));
+	Traces.push_back(MakeSyntheticTrace("autopilot", 7, { { 200, 10, Quarter / 2 } }, 0, 0));
+	return Traces;
+}
+
+bool ReadTrace(const char* Path, Trace& Output)
+{
+	std::ifstream File(Path);
+	if (!File.is_open()) return false;
+
+	Output.Name = Path;
+	std::string Line;
+	while (std::getline(File, Line)) {
+		if (Line.empty() || ((Line[0] < '0' || Line[0] > '9') && Line[0] != '-')) continue;
+
+		std::replace(Line.begin(), Line.end(), ',', ' ');
+		std::istringstream Fields(Line);
+		TraceSample Sample;
+		Fields >> Sample.Tick >> Sample.X >> Sample.Y;
+		Output.Samples.push_back(Sample);
+	}
+	return true;
+}
+
+void WriteTrace(std::ofstream& File, const Trace& Input)
+{
+	File << "# " << Input.Name << "\n";
+	for (const TraceSample& Sample : Input.Samples) File << Sample.Tick << "," << Sample.X << "," << Sample.Y << "\n";
+}
+
+struct ReplayResult {
+	uint64_t Updates = 0;
+	uint64_t Ticks = 0;
+	uint64_t Placed = 0;
+	uint64_t Restored = 0;
+	uint64_t Cells = 0;			// Summed over updates
+	uint64_t Uncovered = 0;		// Ticks the block under the player wasn't part of the platform
+	double MinimumMargin = 1e9;	// cm from the player to the nearest cell that isn't part of the platform
+};
+
+// The game's block for a position in cm
+int64_t ToBlock(int64_t Centimeters)
+{
+	return DivideRoundNearest<50>(Centimeters);
+}
+
+double DistanceToBlock(int64_t X, int64_t Y, int64_t BlockX, int64_t BlockY)
+{
+	const double OutX = std::max({ 0.0, double(BlockX * 50 - 25 - X), double(X - (BlockX * 50 + 25)) });
+	const double OutY = std::max({ 0.0, double(BlockY * 50 - 25 - Y), double(Y - (BlockY * 50 + 25)) });
+	return std::sqrt(OutX * OutX + OutY * OutY);
+}
+
+ReplayResult Replay(const Trace& Input, const Footprints::Tables& Tables, Footprints::Shape Kind, int Radius)
+{
+	ReplayResult Result;
+	Footprints::MotionTracker Tracker(Tables.GetConfig());
+	const Footprints::Footprint* Current = nullptr;
+	int64_t CenterX = 0, CenterY = 0;
+
+	for (const TraceSample& Sample : Input.Samples) {
+		if (Current == nullptr || Sample.Tick % Platform_Tick_Interval == 0) {
+			const Footprints::Footprint& Next = Tables.Get(Kind, Radius, Tracker.Update(Sample.Tick, Sample.X, Sample.Y));
+			const int64_t NextX = ToBlock(Sample.X), NextY = ToBlock(Sample.Y);
+
+			for (const Footprints::Offset& Cell : Next.Cells) {
+				if (Current == nullptr || !Current->Contains(NextX + Cell.X - CenterX, NextY + Cell.Y - CenterY)) Result.Placed++;
+			}
+			if (Current != nullptr) {
+				for (const Footprints::Offset& Cell : Current->Cells) {
+					if (!Next.Contains(CenterX + Cell.X - NextX, CenterY + Cell.Y - NextY)) Result.Restored++;
+				}
+			}
+			Current = &Next;
+			CenterX = NextX;
+			CenterY = NextY;
+			Result.Updates++;
+			Result.Cells += Next.Cells.size();
+		}
+
+		Result.Ticks++;
+		const int64_t BlockX = ToBlock(Sample.X), BlockY = ToBlock(Sample.Y);
+		if (!Current->Contains(BlockX - CenterX, BlockY - CenterY)) {
+			Result.Uncovered++;
+			Result.MinimumMargin = 0;
+			continue;
+		}
+
+		for (int64_t Y = BlockY - Footprints::Max_Reach - 1; Y <= BlockY + Footprints::Max_Reach + 1; Y++) {
+			for (int64_t X = BlockX - Footprints::Max_Reach - 1; X <= BlockX + Footprints::Max_Reach + 1; X++) {
+				if (Current->Contains(X - CenterX, Y - CenterY)) continue;
+				Result.MinimumMargin = std::min(Result.MinimumMargin, DistanceToBlock(Sample.X, Sample.Y, X, Y));
+			}
+		}
+	}
+	return Result;
+}
+
+void PrintResult(const char* Name, const ReplayResult& Result)
+{
+	std::printf("    %-8s %6.2f cells placed + %6.2f restored per tick, %5.1f cells, %4llu ticks uncovered, closest %3.0f cm to the edge\n", Name,
+		double(Result.Placed) / double(Result.Ticks), double(Result.Restored) / double(Result.Ticks), double(Result.Cells) / double(Result.Updates),
+		(unsigned long long) Result.Uncovered, Result.MinimumMargin);
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<Trace> Traces;
+	const char* WritePath = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--write") == 0 && i + 1 < argc) {
+			WritePath = argv[++i];
+			continue;
+		}
+
+		Trace Input;
+		if (!ReadTrace(argv[i], Input)) {
+			std::printf("Can't open %s\n", argv[i]);
+			return 1;
+		}
+		Traces.push_back(std::move(Input));
+	}
+	if (Traces.empty()) Traces = MakeSyntheticTraces();
+
+	if (WritePath != nullptr) {
+		std::ofstream File(WritePath);
+		for (const Trace& Input : Traces) WriteTrace(File, Input);
+	}
+
+	const Footprints::Tables Tables(Minimum_Platform_Radius, Maximum_Platform_Radius);
+	const size_t Shapes = size_t(Footprints::Shape::Count);
+	const int Radii = Maximum_Platform_Radius - Minimum_Platform_Radius + 1;
+	std::vector<ReplayResult> Totals(Shapes * Radii);
+	size_t Worse = 0;
+
+	for (const Trace& Input : Traces) {
+		std::printf("%s (%zu ticks)\n", Input.Name.c_str(), Input.Samples.size());
+		const double SmallestDiscMargin = Replay(Input, Tables, Footprints::Shape::Disc, Minimum_Platform_Radius).MinimumMargin;
+		for (int Radius = Minimum_Platform_Radius; Radius <= Maximum_Platform_Radius; Radius++) {
+			std::printf("  radius %d\n", Radius);
+			uint64_t DiscUncovered = 0;
+			for (size_t Kind = 0; Kind < Shapes; Kind++) {
+				const ReplayResult Result = Replay(Input, Tables, Footprints::Shape(Kind), Radius);
+				char Name[16];
+				std::snprintf(Name, sizeof(Name), "%ls", Footprints::Shape_Names[Kind]);
+				PrintResult(Name, Result);
+
+				if (Footprints::Shape(Kind) == Footprints::Shape::Disc) DiscUncovered = Result.Uncovered;
+				else if (Result.Uncovered > DiscUncovered || Result.MinimumMargin < SmallestDiscMargin) Worse++;
+
+				ReplayResult& Total = Totals[Kind * Radii + (Radius - Minimum_Platform_Radius)];
+				Total.Updates += Result.Updates;
+				Total.Ticks += Result.Ticks;
+				Total.Placed += Result.Placed;
+				Total.Restored += Result.Restored;
+				Total.Cells += Result.Cells;
+				Total.Uncovered += Result.Uncovered;
+				Total.MinimumMargin = std::min(Total.MinimumMargin, Result.MinimumMargin);
+			}
+		}
+	}
+
+	std::printf("\nall traces\n");
+	for (int Radius = Minimum_Platform_Radius; Radius <= Maximum_Platform_Radius; Radius++) {
+		std::printf("  radius %d\n", Radius);
+		for (size_t Kind = 0; Kind < Shapes; Kind++) {
+			char Name[16];
+			std::snprintf(Name, sizeof(Name), "%ls", Footprints::Shape_Names[Kind]);
+			PrintResult(Name, Totals[Kind * Radii + (Radius - Minimum_Platform_Radius)]);
+		}
+	}
+
+	if (Worse > 0) std::printf("FAIL: %zu stretched footprints protected the player less than the disc\n", Worse);
+	return Worse == 0 ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+/*******************************************************
+	Replays hand traces through the altitude gesture engine (GestureEngine.h) and the tick counter it replaced, and
+	reports the latency from input to the first block of movement, how many blocks each moved and how many of those
+	were not asked for. Returns 1 if, on any trace, the engine moves more blocks nobody asked for than the old
+	counter, or its own latency measurement (Engine::GetLatency) counts a different number of gestures or a minimum
+	or maximum outside what the replay saw. The engine can only start its clock on the first sample it can see the
+	input in, so where a glitch hides the first wanted sample it measures a tick less than the replay.
+	Doesn't need the game or Windows, and is not part of Code.vcxproj.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source GestureReplay.cpp -o GestureReplay && ./GestureReplay [trace.csv ...]
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source GestureReplay.cpp
+
+	A trace is one sample per tick: tick,leftX,leftY,leftZ,rightX,rightY,rightZ,headX,headY,headZ,wanted
+	where wanted is 1/-1 while the player is asking to climb/descend and 0 otherwise. Lines that don't start with a
+	digit are skipped. Without arguments a fixed set of synthetic traces (tracking jitter, single sample glitches)
+	is replayed, --write <file> saves those as CSV.
+*******************************************************/
+
+#include "GameUtilities.cpp"
+#include "GestureEngine.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+struct TraceSample {
+	Gestures::HandSample Hands;
+	int Wanted = 0;
+};
+
+struct Trace {
+	std::string Name;
+	std::vector<TraceSample> Samples;
+};
+
+const int Player_Height = 175;
+const double Rise_Height_Trigger_Threshold = .30;
+const int Legacy_Tick_Interval = 5;
+
+// Event_Tick before the gesture engine, progressToBlock included
+struct LegacyGestures {
+	int ProgressToBlock = 0;
+
+	int Update(const Gestures::HandSample& Sample)
+	{
+		int64_t distanceX = Sample.RightHand.X - Sample.LeftHand.X;
+		int64_t distanceY = Sample.RightHand.Y - Sample.LeftHand.Y;
+		int16_t distanceZ = Sample.RightHand.Z - Sample.LeftHand.Z;
+		int distance = int(std::sqrt(double((distanceX * distanceX) + (distanceY * distanceY) + (distanceZ * distanceZ))));
+
+		if (distance > 15) return 0;
+
+		ProgressToBlock++;
+		if (ProgressToBlock < Legacy_Tick_Interval) return 0;
+
+		ProgressToBlock = 0;
+		return Sample.RightHand.Z >= Sample.Head.Z - (Player_Height * Rise_Height_Trigger_Threshold) ? 1 : -1;
+	}
+};
+
+struct ReplayResult {
+	uint64_t Gestures = 0;
+	int64_t LatencyTotal = 0;
+	int64_t LatencyMin = INT64_MAX;
+	int64_t LatencyMax = 0;
+	int64_t BlocksMoved = 0;
+	int64_t UnwantedBlocks = 0;
+	int64_t WrongWayBlocks = 0;
+};
+
+// Latency is measured the same way for both: from the first tick of each wanted stretch to the first block it moved
+template<typename Gesture>
+ReplayResult Replay(const Trace& Input, Gesture&& Update)
+{
+	ReplayResult Result;
+	int64_t WantedSince = -1;
+	int PreviousWanted = 0;
+
+	for (const TraceSample& Sample : Input.Samples) {
+		if (Sample.Wanted != PreviousWanted) WantedSince = Sample.Wanted != 0 ? Sample.Hands.Tick : -1;
+		PreviousWanted = Sample.Wanted;
+
+		int Blocks = Update(Sample.Hands);
+		if (Blocks == 0) continue;
+
+		Result.BlocksMoved += std::abs(Blocks);
+		if (Sample.Wanted == 0) Result.UnwantedBlocks += std::abs(Blocks);
+		else if ((Blocks > 0) != (Sample.Wanted > 0)) Result.WrongWayBlocks += std::abs(Blocks);
+
+		if (WantedSince >= 0 && (Blocks > 0) == (Sample.Wanted > 0)) {
+			int64_t Latency = Sample.Hands.Tick - WantedSince;
+			Result.Gestures++;
+			Result.LatencyTotal += Latency;
+			Result.LatencyMin = std::min(Result.LatencyMin, Latency);
+			Result.LatencyMax = std::max(Result.LatencyMax, Latency);
+			WantedSince = -1;
+		}
+	}
+	return Result;
+}
+
+// Hands apart at rest, then a gesture: hands come together over a few ticks and the right hand goes to RiseOffset.
+// The gesture is wanted from the first sample with the hands within 15cm.
+struct SyntheticGesture {
+	int RestTicks;
+	int HoldTicks;
+	int64_t RiseOffset;	// cm of the right hand above (positive) or below the rise line
+};
+
+Trace MakeSyntheticTrace(const char* Name, uint64_t Seed, const std::vector<SyntheticGesture>& Gestures, int64_t JitterCm, int GlitchEvery)
+{
+	RandomStream Random = MakeRandomStream(Seed);
+	auto Jitter = [&]() { return JitterCm == 0 ? int64_t(0) : int64_t(Random.Next() % uint64_t(2 * JitterCm + 1)) - JitterCm; };
+
+	Trace Output;
+	Output.Name = Name;
+
+	const CoordinateInCentimeters Head = CoordinateInCentimeters(1000, 2000, 5175);
+	const int64_t RiseLine = Head.Z - int64_t(Player_Height * Rise_Height_Trigger_Threshold);
+	const int64_t Approach_Ticks = 3;
+	int64_t Tick = 0;
+
+	auto Push = [&](int64_t Gap, int64_t RightZ, int Wanted) {
+		TraceSample Sample;
+		Sample.Hands.Tick = Tick++;
+		Sample.Hands.Head = Head;
+		Sample.Hands.LeftHand = CoordinateInCentimeters(Head.X + 30 + Jitter(), Head.Y - Gap / 2 + Jitter(), uint16_t(RightZ + Jitter()));
+		Sample.Hands.RightHand = CoordinateInCentimeters(Head.X + 30 + Jitter(), Head.Y + Gap / 2 + Jitter(), uint16_t(RightZ + Jitter()));
+
+		// Tracking glitch: one hand jumps for a single sample
+		if (GlitchEvery > 0 && Random.Next() % uint64_t(GlitchEvery) == 0) {
+			Sample.Hands.LeftHand.Y += (Gap > 20 ? 1 : -1) * (Gap > 20 ? Gap - 4 : 40);
+		}
+		Sample.Wanted = Wanted;
+		Output.Samples.push_back(Sample);
+	};
+
+	for (const SyntheticGesture& Gesture : Gestures) {
+		for (int i = 0; i < Gesture.RestTicks; i++) Push(50, RiseLine - 30, 0);
+		int Wanted = Gesture.RiseOffset > 0 ? 1 : -1;
+		for (int64_t i = 1; i <= Approach_Ticks; i++) {
+			int64_t Gap = 50 - 45 * i / Approach_Ticks;
+			Push(Gap, RiseLine + Gesture.RiseOffset * i / Approach_Ticks, Gap <= 15 ? Wanted : 0);
+		}
+		for (int i = 0; i < Gesture.HoldTicks; i++) Push(5, RiseLine + Gesture.RiseOffset, Wanted);
+	}
+	for (int i = 0; i < 20; i++) Push(50, RiseLine - 30, 0);
+
+	return Output;
+}
+
+std::vector<Trace> MakeSyntheticTraces()
+{
+	const std::vector<SyntheticGesture> Mixed = {
+		{ 30, 20, 20 }, { 25, 15, -20 }, { 40, 8, 60 }, { 12, 30, -60 }, { 33, 4, 12 }, { 27, 50, 30 }, { 18, 10, -10 },
+	};
+
+	std::vector<Trace> Traces;
+	Traces.push_back(MakeSyntheticTrace("clean", 1, Mixed, 0, 0));
+	Traces.push_back(MakeSyntheticTrace("jitter 2cm", 2, Mixed, 2, 0));
+	Traces.push_back(MakeSyntheticTrace("jitter 3cm + glitches", 3, Mixed, 3, 15));
+	Traces.push_back(MakeSyntheticTrace("short taps", 4, { { 20, 2, 20 }, { 21, 3, -20 }, { 19, 2, 40 }, { 23, 3, -40 } }, 2, 0));
+	return Traces;
+}
+
+bool ReadTrace(const char* Path, Trace& Output)
+{
+	std::ifstream File(Path);
+	if (!File.is_open()) return false;
+
+	Output.Name = Path;
+	std::string Line;
+	while (std::getline(File, Line)) {
+		if (Line.empty() || Line[0] < '0' || Line[0] > '9') continue;
+
+		std::replace(Line.begin(), Line.end(), ',', ' ');
+		std::istringstream Fields(Line);
+		TraceSample Sample;
+		int64_t Values[10] = {};
+		for (int64_t& Value : Values) Fields >> Value;
+		Fields >> Sample.Wanted;
+
+		Sample.Hands.Tick = Values[0];
+		Sample.Hands.LeftHand = CoordinateInCentimeters(Values[1], Values[2], uint16_t(Values[3]));
+		Sample.Hands.RightHand = CoordinateInCentimeters(Values[4], Values[5], uint16_t(Values[6]));
+		Sample.Hands.Head = CoordinateInCentimeters(Values[7], Values[8], uint16_t(Values[9]));
+		Output.Samples.push_back(Sample);
+	}
+	return true;
+}
+
+void WriteTrace(std::ofstream& File, const Trace& Input)
+{
+	File << "# " << Input.Name << "\n";
+	for (const TraceSample& Sample : Input.Samples) {
+		const Gestures::HandSample& Hands = Sample.Hands;
+		File << Hands.Tick << "," << Hands.LeftHand.X << "," << Hands.LeftHand.Y << "," << Hands.LeftHand.Z << ","
+			<< Hands.RightHand.X << "," << Hands.RightHand.Y << "," << Hands.RightHand.Z << ","
+			<< Hands.Head.X << "," << Hands.Head.Y << "," << Hands.Head.Z << "," << Sample.Wanted << "\n";
+	}
+}
+
+void PrintResult(const char* Name, const ReplayResult& Result, uint64_t WantedGestures)
+{
+	if (Result.Gestures == 0) {
+		std::printf("  %-8s latency -/-/- ticks (0 of %llu gestures moved)", Name, (unsigned long long) WantedGestures);
+	}
+	else {
+		std::printf("  %-8s latency %lld/%.2f/%lld ticks (%llu of %llu gestures moved)", Name, (long long) Result.LatencyMin,
+			double(Result.LatencyTotal) / double(Result.Gestures), (long long) Result.LatencyMax,
+			(unsigned long long) Result.Gestures, (unsigned long long) WantedGestures);
+	}
+	std::printf(", %lld blocks, %lld unwanted, %lld wrong way\n", (long long) Result.BlocksMoved, (long long) Result.UnwantedBlocks, (long long) Result.WrongWayBlocks);
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<Trace> Traces;
+	const char* WritePath = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--write") == 0 && i + 1 < argc) {
+			WritePath = argv[++i];
+			continue;
+		}
+
+		Trace Input;
+		if (!ReadTrace(argv[i], Input)) {
+			std::printf("Can't open %s\n", argv[i]);
+			return 1;
+		}
+		Traces.push_back(std::move(Input));
+	}
+	if (Traces.empty()) Traces = MakeSyntheticTraces();
+
+	if (WritePath != nullptr) {
+		std::ofstream File(WritePath);
+		for (const Trace& Input : Traces) WriteTrace(File, Input);
+	}
+
+	uint64_t Updates = 0;
+	double UpdateNanoseconds = 0;
+	size_t Failures = 0;
+
+	for (const Trace& Input : Traces) {
+		uint64_t WantedGestures = 0;
+		for (size_t i = 0; i < Input.Samples.size(); i++) {
+			if (Input.Samples[i].Wanted != 0 && (i == 0 || Input.Samples[i - 1].Wanted != Input.Samples[i].Wanted)) WantedGestures++;
+		}
+
+		Gestures::Engine Engine;
+		Engine.Settings.RiseOffset = int64_t(Player_Height * Rise_Height_Trigger_Threshold);
+		LegacyGestures Legacy;
+
+		auto start = std::chrono::steady_clock::now();
+		ReplayResult Engined = Replay(Input, [&](const Gestures::HandSample& Sample) { return Engine.Update(Sample); });
+		UpdateNanoseconds += double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		Updates += Input.Samples.size();
+
+		ReplayResult Legacied = Replay(Input, [&](const Gestures::HandSample& Sample) { return Legacy.Update(Sample); });
+
+		std::printf("%s (%zu ticks)\n", Input.Name.c_str(), Input.Samples.size());
+		PrintResult("engine", Engined, WantedGestures);
+		PrintResult("legacy", Legacied, WantedGestures);
+
+		const Gestures::LatencyStats& Measured = Engine.GetLatency();
+		if (Measured.Gestures > 0) {
+			std::printf("  engine's own measurement: %lld/%.2f/%lld ticks from input to first block over %llu gestures\n",
+				(long long) Measured.MinTicks, double(Measured.TotalTicks) / double(Measured.Gestures), (long long) Measured.MaxTicks,
+				(unsigned long long) Measured.Gestures);
+		}
+
+		if (Engined.UnwantedBlocks > Legacied.UnwantedBlocks) {
+			std::printf("  FAIL: the engine moved blocks nobody asked for\n");
+			Failures++;
+		}
+		if (Measured.Gestures != Engined.Gestures || (Measured.Gestures > 0 && (Measured.MinTicks < Engined.LatencyMin || Measured.MaxTicks > Engined.LatencyMax))) {
+			std::printf("  FAIL: the engine's own latency measurement doesn't agree with the replay\n");
+			Failures++;
+		}
+	}
+
+	if (Updates > 0) std::printf("\nEngine::Update: %.1f ns per sample (including replay bookkeeping)\n", UpdateNanoseconds / double(Updates));
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/*******************************************************
+	Benchmark for FindNearest and FindAllWithin in GameAPI.cpp.
+
+	Builds GameAPI.cpp against CountingHost, a host backend (see HostBackend.h) whose GetBlock reads a generated world
+	and counts the calls. For each kind of query the mod makes it prints the GetBlock calls per query and the time per
+	query, next to the same query done the old way: build the coordinate list with GetAllCoordinatesInRadius (or walk
+	the column one block at a time), read every cell and pick the result. Returns 1 if a search result is not as near
+	as the nearest match the full scan found, or if it misses a match inside the radius.
+
+	Doesn't need the game or Windows, and is not part of Code.vcxproj.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source SearchBenchmark.cpp -o SearchBenchmark -lpthread && ./SearchBenchmark
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source SearchBenchmark.cpp && SearchBenchmark
+*******************************************************/
+
+struct CountingHost;
+#define CLOUDWALKER_HOST_BACKEND CountingHost
+#include "HostBackend.h"
+
+using namespace ModAPI;
+
+struct CountingHost : HostBackends::Null {
+	static BlockInfo GetBlock(const CoordinateInBlocks& At);
+};
+
+// GameAPI.cpp has an empty main of its own
+#define main GameAPIMain
+#include "GameAPI.cpp"
+#undef main
+
+#include "BlockProperties.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+const int Ground_Height = 100;
+const int Query_Count = 20000;
+const UniqueID Cloud_Block = 429171;
+
+constexpr auto Properties = BlockProperty::MakeBlockPropertyTable<1>({ { { Cloud_Block, BlockProperty::Cloud | BlockProperty::Solid } } });
+
+static uint64_t Reads = 0;
+
+static uint32_t Hash(int64_t X, int64_t Y, int64_t Z)
+{
+	uint64_t Value = uint64_t(X) * 0x9E3779B97F4A7C15ull ^ uint64_t(Y) * 0xC2B2AE3D27D4EB4Full ^ uint64_t(Z) * 0x165667B19E3779F9ull;
+	Value ^= Value >> 29;
+	return uint32_t(Value * 0xBF58476D1CE4E5B9ull >> 32);
+}
+
+// Hills of stone under grass with a few trees, and clouds left floating in the air here and there
+BlockInfo CountingHost::GetBlock(const CoordinateInBlocks& At)
+{
+	Reads++;
+	const int Ground = Ground_Height + int(Hash(At.X >> 3, At.Y >> 3, 0) % 4);
+	if (At.Z < Ground) return EBlockType::Stone;
+	if (At.Z == Ground) return EBlockType::Grass;
+	if (At.Z <= Ground + 8 && Hash(At.X, At.Y, 1) % 199 == 7) return EBlockType::TreeWood;
+	if (Hash(At.X, At.Y, At.Z) % 1500 == 0) return BlockInfo(Cloud_Block);
+	return EBlockType::Air;
+}
+
+struct Result {
+	double ReadsPerQuery = 0;
+	double MicrosecondsPerQuery = 0;
+	size_t Found = 0;
+};
+
+static Result Measure(const std::vector<CoordinateInBlocks>& Points, const std::function<size_t(const CoordinateInBlocks&)>& Query)
+{
+	const uint64_t ReadsBefore = Reads;
+	const auto Start = std::chrono::steady_clock::now();
+	Result Measured;
+	for (const CoordinateInBlocks& At : Points) Measured.Found += Query(At);
+	Measured.MicrosecondsPerQuery = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start).count() / Points.size();
+	Measured.ReadsPerQuery = double(Reads - ReadsBefore) / Points.size();
+	return Measured;
+}
+
+static void Print(const char* Name, const Result& Old, const Result& New)
+{
+	std::printf("%-40s %8.1f -> %7.1f GetBlock calls per query, %7.2f -> %6.2f us, %zu -> %zu found\n", Name, Old.ReadsPerQuery, New.ReadsPerQuery,
+		Old.MicrosecondsPerQuery, New.MicrosecondsPerQuery, Old.Found, New.Found);
+}
+
+// The squared distance of the nearest match the way the mod used to find it, -1 if there is none
+static int64_t NearestByFullScan(const CoordinateInBlocks& At, int32_t Radius, uint8_t AnyOf)
+{
+	int64_t Best = -1;
+	for (const CoordinateInBlocks& Cell : GetAllCoordinatesInRadius(At, Radius)) {
+		if (!Properties.Is(GetBlock(Cell), AnyOf)) continue;
+		const int64_t Distance = (Cell - At).GetLengthSquared();
+		if (Best < 0 || Distance < Best) Best = Distance;
+	}
+	return Best;
+}
+
+int main()
+{
+	std::vector<CoordinateInBlocks> Standing, Floating;
+	for (int i = 0; i < Query_Count; i++) {
+		const int64_t X = int64_t(Hash(i, 0, 2) % 100000) - 50000, Y = int64_t(Hash(i, 0, 3) % 100000) - 50000;
+		Standing.push_back(CoordinateInBlocks(X, Y, int16_t(Ground_Height + 4 + Hash(i, 0, 4) % 4)));
+		Floating.push_back(CoordinateInBlocks(X, Y, int16_t(Ground_Height + 30 + Hash(i, 0, 5) % 100)));
+	}
+
+	// The old scans are asymmetric (-Radius to Radius - 1), so the new search can only be nearer or as near
+	size_t Wrong = 0;
+	for (const CoordinateInBlocks& At : Floating) {
+		CoordinateInBlocks Found;
+		const bool Hit = FindNearest(At, 10, Properties.Matching(BlockProperty::Cloud), Found);
+		const int64_t Expected = NearestByFullScan(At, 10, BlockProperty::Cloud);
+		Wrong += Hit ? (Expected >= 0 && (Found - At).GetLengthSquared() > Expected) || (Found - At).GetLengthSquared() > 100 : Expected >= 0;
+	}
+
+	const Result OldGround = Measure(Standing, [&](const CoordinateInBlocks& At) { return size_t(NearestByFullScan(At, 8, BlockProperty::Solid) >= 0); });
+	const Result NewGround = Measure(Standing, [&](const CoordinateInBlocks& At) {
+		CoordinateInBlocks Found;
+		return size_t(FindNearest(At, 8, Properties.Matching(BlockProperty::Solid), Found));
+	});
+	Print("nearest solid block within 8, on foot", OldGround, NewGround);
+
+	const Result OldCloud = Measure(Floating, [&](const CoordinateInBlocks& At) { return size_t(NearestByFullScan(At, 10, BlockProperty::Cloud) >= 0); });
+	const Result NewCloud = Measure(Floating, [&](const CoordinateInBlocks& At) {
+		CoordinateInBlocks Found;
+		return size_t(FindNearest(At, 10, Properties.Matching(BlockProperty::Cloud), Found));
+	});
+	Print("nearest cloud within 10, in the air", OldCloud, NewCloud);
+
+	const Result OldPurge = Measure(Floating, [&](const CoordinateInBlocks& At) {
+		size_t Found = 0;
+		for (const CoordinateInBlocks& Cell : GetAllCoordinatesInRadius(At, 10)) Found += Properties.Is(GetBlock(Cell), BlockProperty::Cloud);
+		return Found;
+	});
+	std::vector<CoordinateInBlocks> Clouds;
+	const Result NewPurge = Measure(Floating, [&](const CoordinateInBlocks& At) {
+		Clouds.clear();
+		return FindAllWithin(At, 10, Properties.Matching(BlockProperty::Cloud), Clouds);
+	});
+	Print("all clouds within 10 (purge)", OldPurge, NewPurge);
+	if (NewPurge.Found < OldPurge.Found) Wrong++;
+
+	const Result OldFirstFour = OldPurge;
+	const Result NewFirstFour = Measure(Floating, [&](const CoordinateInBlocks& At) {
+		Clouds.clear();
+		return FindAllWithin(At, 10, Properties.Matching(BlockProperty::Cloud), Clouds, 4);
+	});
+	Print("first 4 clouds within 10", OldFirstFour, NewFirstFour);
+
+	const Result OldColumn = Measure(Floating, [&](const CoordinateInBlocks& At) {
+		for (int Z = At.Z; Z > 0; Z--) {
+			if (Properties.Is(GetBlock(CoordinateInBlocks(At.X, At.Y, int16_t(Z))), BlockProperty::Solid)) return size_t(1);
+		}
+		return size_t(0);
+	});
+	const Result NewColumn = Measure(Floating, [&](const CoordinateInBlocks& At) {
+		CoordinateInBlocks Found;
+		return size_t(FindNearest(At, At.Z - 1, Properties.Matching(BlockProperty::Solid), Found, SearchShape::ColumnDown));
+	});
+	Print("solid block straight down (teleport)", OldColumn, NewColumn);
+	if (NewColumn.Found != OldColumn.Found) Wrong++;
+
+	const BlockSearchStats& Stats = GetBlockSearchStats();
+	std::printf("all searches: %llu queries, %.1f GetBlock calls and %.2f matches per query on average\n", (unsigned long long) Stats.Queries,
+		double(Stats.Reads) / Stats.Queries, double(Stats.Matches) / Stats.Queries);
+
+	if (Wrong > 0) std::printf("FAIL: %zu searches found less or farther than the full scan\n", Wrong);
+	return Wrong == 0 ? 0 : 1;
+}
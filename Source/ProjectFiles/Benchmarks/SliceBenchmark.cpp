@@ -0,0 +1,182 @@
+/*******************************************************
+	Benchmark for the world slice files in WorldSlice.h.
+	Doesn't need the game or Windows, and is not part of Code.vcxproj.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source SliceBenchmark.cpp -o SliceBenchmark && ./SliceBenchmark [slice file]
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source SliceBenchmark.cpp && SliceBenchmark [slice file]
+
+	Builds a 256 x 256 x 128 block slice of layered ground (bottom stone, stone with ore veins, dirt, grass with
+	flowers and foliage, trees, torches in every rotation and some mod blocks), writes it to SliceBenchmark.slice in
+	the working directory, reads it back and times every step. Given a slice file captured in the game, it also
+	times loading that one. Returns 1 if a cell reads back different from what was put in, or if loading takes a
+	second or more.
+*******************************************************/
+
+#include "WorldSlice.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace ModAPI;
+
+using Clock = std::chrono::steady_clock;
+
+static double Milliseconds(Clock::time_point Since)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - Since).count();
+}
+
+static uint32_t Hash(int64_t X, int64_t Y, int64_t Z)
+{
+	uint64_t Value = uint64_t(X) * 0x9E3779B97F4A7C15ull ^ uint64_t(Y) * 0xC2B2AE3D27D4EB4Full ^ uint64_t(Z) * 0x165667B19E3779F9ull;
+	Value ^= Value >> 29;
+	return uint32_t(Value * 0xBF58476D1CE4E5B9ull >> 32);
+}
+
+static BlockInfo Terrain(const CoordinateInBlocks& At)
+{
+	const int Ground = 160 + int(Hash(At.X >> 4, At.Y >> 4, 0) % 12);
+	const uint32_t Noise = Hash(At.X, At.Y, At.Z);
+
+	if (At.Z < 104) return EBlockType::BottomStone;
+	if (At.Z < Ground - 4) {
+		if (Noise % 97 == 0) return EBlockType::Ore_Coal;
+		if (Noise % 211 == 0) return EBlockType::Ore_Iron;
+		if (Noise % 503 == 0) return EBlockType::Ore_Copper;
+		return EBlockType::Stone;
+	}
+	if (At.Z < Ground) return EBlockType::Dirt;
+	if (At.Z == Ground) return Hash(At.X >> 3, At.Y >> 3, 1) % 9 == 0 ? EBlockType::Sand : EBlockType::Grass;
+
+	const bool Tree = Hash(At.X, At.Y, 2) % 173 == 0;
+	if (Tree && At.Z <= Ground + 8) return EBlockType::TreeWood;
+	if (At.Z == Ground + 1) {
+		if (Noise % 7 == 0) return EBlockType::GrassFoliage;
+		if (Noise % 53 == 0) return EBlockType::Flower1;
+		if (Noise % 401 == 0) return BlockInfo(EBlockType::Torch, ERotation(Noise % 5));
+		if (Noise % 907 == 0) return BlockInfo(UniqueID(3039));
+	}
+	return EBlockType::Air;
+}
+
+static bool Run(const CoordinateInBlocks& Origin, uint32_t ChunksAcross, uint32_t ChunksHigh, const std::filesystem::path& Path)
+{
+	const int Across = int(ChunksAcross) * Slices::Chunk_Size, High = int(ChunksHigh) * Slices::Chunk_Size;
+
+	// Captured standing on the ground in the middle, as the capture tool in the game would be
+	CoordinateInBlocks Center = Origin + CoordinateInBlocks(Across / 2, Across / 2, int16_t(High - 1));
+	while (Center.Z > Origin.Z && Terrain(Center - CoordinateInBlocks(0, 0, 1)).Type == EBlockType::Air) Center.Z--;
+
+	Clock::time_point Start = Clock::now();
+	Slices::Builder Builder(Origin, ChunksAcross, ChunksAcross, ChunksHigh, Center);
+	for (int Z = 0; Z < High; Z++) {
+		for (int Y = 0; Y < Across; Y++) {
+			for (int X = 0; X < Across; X++) {
+				const CoordinateInBlocks At = Origin + CoordinateInBlocks(X, Y, int16_t(Z));
+				Builder.Set(At, Terrain(At));
+			}
+		}
+	}
+	const double SetMilliseconds = Milliseconds(Start);
+
+	Start = Clock::now();
+	const std::vector<uint8_t> Bytes = Builder.Encode();
+	const double EncodeMilliseconds = Milliseconds(Start);
+
+	if (FILE* File = std::fopen(Path.string().c_str(), "wb")) {
+		std::fwrite(Bytes.data(), 1, Bytes.size(), File);
+		std::fclose(File);
+	}
+
+	std::printf("%zu blocks, %zu kinds, %zu KB (%.3f bytes per block, %.0fx smaller than BlockInfo)\n", Builder.GetCellCount(),
+		Builder.GetPaletteSize(), Bytes.size() / 1024, double(Bytes.size()) / Builder.GetCellCount(),
+		double(Builder.GetCellCount() * sizeof(BlockInfo)) / Bytes.size());
+	std::printf("	Set                 %7.1f ns per block\n", SetMilliseconds * 1e6 / Builder.GetCellCount());
+	std::printf("	Encode              %7.1f ms\n", EncodeMilliseconds);
+
+	Slices::Reader Reader;
+	std::vector<uint8_t> Loaded;
+	const double LoadMilliseconds = [&]() {
+		const Clock::time_point LoadStart = Clock::now();
+		Loaded.resize(std::filesystem::file_size(Path));
+		if (FILE* File = std::fopen(Path.string().c_str(), "rb")) {
+			Loaded.resize(std::fread(Loaded.data(), 1, Loaded.size(), File));
+			std::fclose(File);
+		}
+		return Reader.Open(Loaded.data(), Loaded.size()) ? Milliseconds(LoadStart) : -1.0;
+	}();
+	if (LoadMilliseconds < 0) {
+		std::printf("	FAIL: the file doesn't open\n");
+		return false;
+	}
+	std::printf("	Read file and Open  %7.1f ms\n", LoadMilliseconds);
+
+	// Random lookups, then walking columns top down the way the soak test looks for the ground
+	std::mt19937 Random(1);
+	std::vector<CoordinateInBlocks> Points(1000000);
+	for (CoordinateInBlocks& At : Points) At = Origin + CoordinateInBlocks(int64_t(Random() % Across), int64_t(Random() % Across), int16_t(Random() % High));
+	uint64_t Sum = 0;
+	Start = Clock::now();
+	for (int Pass = 0; Pass < 10; Pass++) {
+		for (const CoordinateInBlocks& At : Points) Sum += uint8_t(Reader.Get(At).Type);
+	}
+	std::printf("	Get, random         %7.1f ns (checksum %llu)\n", Milliseconds(Start) * 1e6 / (10 * Points.size()), (unsigned long long) Sum);
+
+	Start = Clock::now();
+	for (const CoordinateInBlocks& At : Points) {
+		for (int Z = High - 1; Z >= 0; Z--) Sum += uint8_t(Reader.Get(CoordinateInBlocks(At.X, At.Y, int16_t(Origin.Z + Z))).Type);
+	}
+	std::printf("	Get, columns        %7.1f ns (checksum %llu)\n", Milliseconds(Start) * 1e6 / (double(High) * Points.size()), (unsigned long long) Sum);
+
+	// Every cell against the source, plus a ring of cells just outside the box
+	size_t Wrong = 0;
+	for (int Z = -1; Z <= High; Z++) {
+		for (int Y = -1; Y <= Across; Y++) {
+			for (int X = -1; X <= Across; X++) {
+				const CoordinateInBlocks At = Origin + CoordinateInBlocks(X, Y, int16_t(Z));
+				const BlockInfo Expected = Builder.Contains(At) ? Terrain(At) : BlockInfo();
+				const BlockInfo Actual = Reader.Get(At);
+				Wrong += Expected.Type != Actual.Type || Expected.Rotation != Actual.Rotation || Expected.CustomBlockID != Actual.CustomBlockID;
+			}
+		}
+	}
+	if (Wrong > 0) std::printf("	FAIL: %zu cells read back wrong\n", Wrong);
+	if (LoadMilliseconds >= 1000) std::printf("	FAIL: loading took a second or more\n");
+	return Wrong == 0 && LoadMilliseconds < 1000;
+}
+
+static bool Load(const char* Path)
+{
+	const Clock::time_point Start = Clock::now();
+	std::error_code Error;
+	std::vector<uint8_t> Loaded(std::filesystem::file_size(Path, Error));
+	FILE* File = Error ? nullptr : std::fopen(Path, "rb");
+	if (File == nullptr) {
+		std::printf("FAIL: can't read %s\n", Path);
+		return false;
+	}
+	Loaded.resize(std::fread(Loaded.data(), 1, Loaded.size(), File));
+	std::fclose(File);
+
+	Slices::Reader Reader;
+	if (!Reader.Open(Loaded.data(), Loaded.size())) {
+		std::printf("FAIL: %s isn't a slice file\n", Path);
+		return false;
+	}
+	const double LoadMilliseconds = Milliseconds(Start);
+
+	const CoordinateInBlocks Size = Reader.GetSize(), Origin = Reader.GetOrigin(), Center = Reader.GetCenter();
+	std::printf("%s: %lld x %lld x %d blocks at %lld, %lld, %d (captured at %lld, %lld, %d), %zu kinds, %zu KB, read and opened in %.1f ms\n", Path,
+		(long long) Size.X, (long long) Size.Y, int(Size.Z), (long long) Origin.X, (long long) Origin.Y, int(Origin.Z), (long long) Center.X,
+		(long long) Center.Y, int(Center.Z), Reader.GetPaletteSize(), Loaded.size() / 1024, LoadMilliseconds);
+	return LoadMilliseconds < 1000;
+}
+
+int main(int argc, char** argv)
+{
+	const bool Passed = Run(CoordinateInBlocks(-1000, 2000, 96), 16, 8, "SliceBenchmark.slice");
+	const bool Captured = argc > 1 ? Load(argv[1]) : true;
+	return Passed && Captured ? 0 : 1;
+}
@@ -0,0 +1,1106 @@
+/*******************************************************
+	Soak test for the whole mod.
+
+	Builds Mod.cpp and GameAPI.cpp against SimulatedHost, a host backend (see HostBackend.h) over a simulated
+	world instead of the game, and plays it for a long time: walking over hilly ground, altitude gestures, radius changes, toggling,
+	purges, teleports, bridge mode and taking bridges down, leaving and reloading the world, and crashes (all mod
+	state thrown away without Event_OnExit, then a reload from whatever the last save wrote). Two simulated client
+	mods ask for temporary floors through the command ring (see CommandRing.h): one from the tick thread, one from a
+	thread of its own pushing as fast as the ring lets it.
+
+	Given a slice file written by the mod's capture tool (see WorldSlice.h), the world is that slice wherever it
+	reaches, moved so the player starts where the slice was captured, and the generated terrain everywhere else.
+
+	Every Check_Interval ticks the whole simulated world is scanned for Cloud_Block cells the mod has no record
+	of, neither in platformCoords, the bridge index nor in the saved clouds it is still reconciling. Those would stay in the world
+	forever. The run fails (returns 1) on any orphaned cloud, on platform cells a finished purge left as holes, on a
+	climb gesture from the ground that doesn't get the platform up, on a sledgehammer hit that marks an autopilot target
+	without the autopilot armed, on floors still up after the final drain, on the command ring still published after
+	the final Event_OnExit, on saved clouds left in the world after loading a save with Large_Save_Clouds of them, on
+	platformCoords growing past what two platforms can hold, on bridge cells missing after the final save and reload,
+	on a scripted flight with a single platform
+	plane that doesn't take fewer writes or takes more fall rescues than with two, or on memory growing over the
+	second half of the run by more than the bridge cells, floor clouds and changed world cells added then need.
+
+	Doesn't need the game or Windows, and is not part of Code.vcxproj. Writes SoakWorld.txt, the mod's save file,
+	to the working directory.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source SoakTest.cpp -o SoakTest -lpthread && ./SoakTest [ticks] [seed] [slice file]
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source SoakTest.cpp && SoakTest [ticks] [seed] [slice file]
+*******************************************************/
+
+struct SimulatedHost;
+#define CLOUDWALKER_HOST_BACKEND SimulatedHost
+#include "HostBackend.h"
+
+using namespace ModAPI;
+
+// Everything the mod asks the game for comes from the World namespace below, the rest is HostBackends::Null
+struct SimulatedHost : HostBackends::Null {
+	static void Log(const wchar_t* String);
+	static BlockInfo GetBlock(const CoordinateInBlocks& At);
+	static bool SetBlock(const CoordinateInBlocks& At, const BlockInfo& BlockType, BlockInfo& OutReplacedType);
+	static CoordinateInCentimeters GetPlayerLocation();
+	static bool SetPlayerLocation(const CoordinateInCentimeters& To);
+	static CoordinateInCentimeters GetPlayerLocationHead();
+	static CoordinateInCentimeters GetHandLocation(bool LeftHand);
+	static const wchar_t* GetWorldName();
+	static bool ModuleDirectory(std::wstring& Out);
+	static SharedMemoryHandleC GetSharedMemoryPointer(const wchar_t* Key, bool CreateIfNotExist, bool WaitUntilExist);
+	static void ReleaseSharedMemoryPointer(SharedMemoryHandleC& Handle);
+};
+
+// GameAPI.cpp has an empty main of its own
+#define main ModMain
+#include "Mod.cpp"
+#include "GameAPI.cpp"
+#undef main
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const uint64_t Default_Ticks = 1000000;
+const uint64_t Check_Interval = 10000;
+const size_t Platform_Coords_Bound = 2 * (2 * Maximum_Platform_Radius + 1) * (2 * Maximum_Platform_Radius + 1);
+const size_t Memory_Growth_Slack = 2 * 1024 * 1024;	// allocator and page granularity on top of StoredEntries::Bytes
+const int Walk_Speed = 5;				// cm per tick at most, 2 m/s
+const int Fall_Speed = 25;				// cm per tick
+const int Ground_Height = 100;			// blocks
+const int Tree_Height = 10;
+const int Spire_Height = 30;
+const int Climb_Test_Blocks = 60;
+const int64_t Flight_Start_X = -400;	// blocks
+const int64_t Flight_Start_Y = 900;
+const size_t Large_Save_Clouds = 10000;
+
+// Simulated world
+//********************************
+namespace World {
+
+	struct Cell {
+		CoordinateInBlocks At;
+		BlockInfo Block;
+	};
+
+	// Everything that differs from the generated terrain
+	std::unordered_map<uint64_t, Cell> Changed;
+
+	CoordinateInCentimeters Player = CoordinateInCentimeters(0, 0, uint16_t(Ground_Height * 50 + 25));
+	bool GestureActive = false;
+	int GestureOffset = 0;				// cm the right hand is above the rise line
+	uint64_t LogLines = 0;
+	uint64_t Warnings = 0;
+	uint64_t Writes = 0;
+
+	// Pointers mods left in shared memory, by key
+	std::unordered_map<std::wstring, void*> SharedMemory;
+
+	// Captured world, At + SliceShift is where a cell was in the world it came from
+	Slices::Reader Slice;
+	CoordinateInBlocks SliceShift;
+	int TerrainTop = Ground_Height + Spire_Height;
+
+	uint64_t Key(const CoordinateInBlocks& At)
+	{
+		return (uint64_t(At.X) & 0xFFFFFF) | ((uint64_t(At.Y) & 0xFFFFFF) << 24) | ((uint64_t(At.Z) & 0xFFFF) << 48);
+	}
+
+	uint32_t Hash(int64_t X, int64_t Y)
+	{
+		uint64_t Value = uint64_t(X) * 0x9E3779B97F4A7C15ull ^ uint64_t(Y) * 0xC2B2AE3D27D4EB4Full;
+		Value ^= Value >> 29;
+		return uint32_t(Value * 0xBF58476D1CE4E5B9ull >> 32);
+	}
+
+	// Rolling hills of stone under grass, with foliage on some of the grass, trees and now and then a spire of rock
+	// taller than the autopilot likes to climb
+	BlockInfo Terrain(const CoordinateInBlocks& At)
+	{
+		if (At.Z < World_Min_Height || At.Z > World_Max_Height) return EBlockType::Invalid;
+
+		if (Slice.Contains(At + SliceShift)) {
+			// Clouds in the capture belong to the mod that was running then, to this one they would be orphans
+			const BlockInfo Captured = Slice.Get(At + SliceShift);
+			return Captured.Type == EBlockType::ModBlock && Captured.CustomBlockID == Cloud_Block ? BlockInfo(EBlockType::Air) : Captured;
+		}
+
+		const int Ground = Ground_Height + int(Hash(At.X >> 3, At.Y >> 3) % 4);
+		if (At.Z < Ground) return EBlockType::Stone;
+		if (At.Z <= Ground + Spire_Height && Hash(At.X >> 2, At.Y >> 2) % 151 == 11) return EBlockType::Stone;
+		if (At.Z == Ground) return EBlockType::Grass;
+		if (At.Z <= Ground + Tree_Height && Hash(At.X, At.Y) % 199 == 7) return EBlockType::TreeWood;
+		if (At.Z == Ground + 1 && Hash(At.X, At.Y) % 5 == 0) return EBlockType::GrassFoliage;
+		return EBlockType::Air;
+	}
+
+	BlockInfo Get(const CoordinateInBlocks& At)
+	{
+		auto Found = Changed.find(Key(At));
+		return Found != Changed.end() ? Found->second.Block : Terrain(At);
+	}
+
+	bool IsSame(const BlockInfo& A, const BlockInfo& B)
+	{
+		return A.Type == B.Type && A.CustomBlockID == B.CustomBlockID;
+	}
+
+	bool IsCloud(const BlockInfo& Block)
+	{
+		return Block.Type == EBlockType::ModBlock && Block.CustomBlockID == Cloud_Block;
+	}
+
+	// Anything the player can stand on
+	bool IsSupportive(const BlockInfo& Block)
+	{
+		return Block.Type != EBlockType::Air && Block.Type != EBlockType::GrassFoliage && Block.Type != EBlockType::Invalid;
+	}
+
+	int RandomInt(RandomStream& Random, int Min, int Max)
+	{
+		return Min + int(Random.Next() % uint64_t(Max - Min + 1));
+	}
+
+	// Walks, steps up one block at a time and falls when nothing is underfoot
+	void MovePlayer(RandomStream& Random, double& Heading)
+	{
+		Heading += double(RandomInt(Random, -10, 10)) / 100.0;
+		const int Speed = RandomInt(Random, 0, Walk_Speed);
+		CoordinateInCentimeters Next = Player;
+		Next.X += int64_t(std::cos(Heading) * Speed);
+		Next.Y += int64_t(std::sin(Heading) * Speed);
+
+		const CoordinateInBlocks Feet = CoordinateInCentimeters(Next.X, Next.Y, uint16_t(Next.Z + 10));
+		if (IsSupportive(Get(Feet))) {
+			const CoordinateInBlocks AboveFeet = CoordinateInBlocks(Feet.X, Feet.Y, int16_t(Feet.Z + 1));
+			if (IsSupportive(Get(AboveFeet))) {
+				Heading += 3.14159;
+				return;
+			}
+			Next.Z = uint16_t(AboveFeet.Z * 50 + 25 - 50);
+		}
+
+		const CoordinateInBlocks UnderFoot = CoordinateInCentimeters(Next.X, Next.Y, uint16_t(Next.Z - 25));
+		if (IsSupportive(Get(UnderFoot))) Next.Z = uint16_t(UnderFoot.Z * 50 + 25);
+		else if (Next.Z > Fall_Speed + 25) Next.Z = uint16_t(Next.Z - Fall_Speed);
+		Player = Next;
+	}
+
+	// What the game does to a player standing still: pushes them up out of blocks, lets them fall when nothing is underfoot
+	void SettlePlayer()
+	{
+		CoordinateInBlocks Feet = CoordinateInCentimeters(Player.X, Player.Y, uint16_t(Player.Z + 10));
+		while (IsSupportive(Get(Feet))) {
+			Player.Z = uint16_t(Feet.Z * 50 + 25);
+			Feet.Z++;
+		}
+
+		const CoordinateInBlocks UnderFoot = CoordinateInCentimeters(Player.X, Player.Y, uint16_t(Player.Z - 25));
+		if (!IsSupportive(Get(UnderFoot)) && Player.Z > Fall_Speed + 25) Player.Z = uint16_t(Player.Z - Fall_Speed);
+	}
+}
+
+// Host functions
+//********************************
+void SimulatedHost::Log(const wchar_t* String)
+{
+	World::LogLines++;
+	if (std::wcsstr(String, L"[Warning]") || std::wcsstr(String, L"[Error]")) {
+		World::Warnings++;
+		std::printf("  %ls\n", String);
+	}
+}
+
+BlockInfo SimulatedHost::GetBlock(const CoordinateInBlocks& At)
+{
+	return World::Get(At);
+}
+
+// Fires the AnyBlock events the game fires for every change
+bool SimulatedHost::SetBlock(const CoordinateInBlocks& At, const BlockInfo& BlockType, BlockInfo& OutReplacedType)
+{
+	OutReplacedType = World::Get(At);
+	if (At.Z < World_Min_Height || At.Z > World_Max_Height) return false;
+	World::Writes++;
+
+	if (World::IsSame(BlockType, World::Terrain(At))) World::Changed.erase(World::Key(At));
+	else World::Changed[World::Key(At)] = World::Cell{ At, BlockType };
+
+	if (OutReplacedType.Type != EBlockType::Air) Event_AnyBlockDestroyed(At, OutReplacedType, false);
+	if (BlockType.Type != EBlockType::Air) Event_AnyBlockPlaced(At, BlockType, false);
+	return true;
+}
+
+CoordinateInCentimeters SimulatedHost::GetPlayerLocation()
+{
+	return World::Player;
+}
+
+bool SimulatedHost::SetPlayerLocation(const CoordinateInCentimeters& To)
+{
+	World::Player = To;
+	return true;
+}
+
+CoordinateInCentimeters SimulatedHost::GetPlayerLocationHead()
+{
+	return CoordinateInCentimeters(World::Player.X, World::Player.Y, uint16_t(World::Player.Z + playerHeight));
+}
+
+// Together at GestureOffset above the rise line while gesturing, otherwise apart at the hips
+CoordinateInCentimeters SimulatedHost::GetHandLocation(bool LeftHand)
+{
+	const CoordinateInCentimeters Head = GetPlayerLocationHead();
+	const int64_t Side = LeftHand ? -1 : 1;
+
+	if (World::GestureActive) {
+		const int64_t RiseLine = int64_t(Head.Z) - int64_t(playerHeight * Rise_Height_Trigger_Threshold);
+		return CoordinateInCentimeters(Head.X + 30, Head.Y + Side * 3, uint16_t(RiseLine + World::GestureOffset));
+	}
+	return CoordinateInCentimeters(Head.X + 10, Head.Y + Side * 25, uint16_t(Head.Z - 80));
+}
+
+const wchar_t* SimulatedHost::GetWorldName()
+{
+	return L"SoakWorld";
+}
+
+// The save file goes to the working directory
+bool SimulatedHost::ModuleDirectory(std::wstring& Out)
+{
+	Out.clear();
+	return true;
+}
+
+// The handle points at the stored pointer, releasing it stores whatever the mod set
+SharedMemoryHandleC SimulatedHost::GetSharedMemoryPointer(const wchar_t* Key, bool CreateIfNotExist, bool /*WaitUntilExist*/)
+{
+	static void* Missing = nullptr;
+	auto Found = World::SharedMemory.find(Key);
+	if (Found == World::SharedMemory.end()) {
+		if (!CreateIfNotExist) return SharedMemoryHandleC{ &Missing, nullptr, false };
+		Found = World::SharedMemory.emplace(Key, nullptr).first;
+	}
+	return SharedMemoryHandleC{ &Found->second, const_cast<wchar_t*>(Found->first.c_str()), true };
+}
+
+void SimulatedHost::ReleaseSharedMemoryPointer(SharedMemoryHandleC& Handle)
+{
+	World::SharedMemory[Handle.Key] = *Handle.Pointer;
+}
+
+// Mod state
+//********************************
+// Everything the mod keeps in memory, as a crash would lose it. The background save that might be running
+// is allowed to finish first, a torn save file is a different problem.
+// What Internals::E_Event_OnLoad does in the DLL
+void Load()
+{
+	jobPool.Start();
+	Event_OnLoad();
+}
+
+uint64_t RoutesPlanned = 0;
+int64_t MaxRouteMicrosecondsPerTick = 0;
+uint64_t PurgeHoles = 0;	// Platform cells a finished purge left as something other than a cloud
+
+void SoakOperationFinished(const Coroutines::OperationStats& Stats)
+{
+	if (Stats.Group == LongOperation::RoutePlanning && !Stats.Cancelled) {
+		RoutesPlanned++;
+		MaxRouteMicrosecondsPerTick = std::max(MaxRouteMicrosecondsPerTick, Stats.MaxMicroseconds);
+	}
+	if (Stats.Group == LongOperation::Purge && !Stats.Cancelled) {
+		for (const Cloud& Tracked : platformCoords) {
+			if (!World::IsCloud(World::Get(Tracked.location))) PurgeHoles++;
+		}
+	}
+	LogOperationFinished(Stats);
+}
+
+void Crash()
+{
+	jobPool.Join();
+	saveInFlight = false;
+	flightRecorder.Reset();
+	platformCoords.clear();
+	platformBoundsDirty = true;
+	knownCells.clear();
+	savedClouds.clear();
+	savedCloudsReconciled = 0;
+	cloudWalkingEnabled = false;
+	operations = Coroutines::Runner();
+	operations.OnFinished = SoakOperationFinished;
+	gestureEngine.Reset();
+	platformMotion.Reset();
+	autopilot = Pathfinding::RouteFollower();
+	occupancy.Clear();
+	externalFloors.clear();
+	commandRingPublished = false;
+}
+
+// Client mods
+//********************************
+// Two other mods asking for floors through the command ring. The ring outlives crashes in the simulation, so commands
+// queued before one are carried out by the reloaded mod.
+namespace Clients {
+
+	const int Floor_Height = 6;			// blocks above the player's feet, over their head
+	const int Scaffolder_Tags = 4;
+	const int Builder_Tags = 64;
+	const int Builder_Burst = 16;
+
+	CommandRing::Ring* Ring = nullptr;
+	int Scaffolder = -1;
+	int Builder = -1;
+
+	// Where the builder puts its floors, written by the tick thread. Floors only go up while the player is on foot on
+	// solid ground, so a crash right after one only leaves clouds the sweep around the player reaches.
+	std::atomic<bool> Open{ false };
+	std::atomic<int64_t> AtX{ 0 }, AtY{ 0 };
+	std::atomic<int32_t> AtZ{ 0 };
+	std::atomic<bool> Stop{ false };
+
+	// What a client mod does once the world is loaded, false if there is no ring to talk to
+	bool Connect()
+	{
+		ScopedSharedMemoryHandle Handle = GetSharedMemoryPointer(CommandRing::Shared_Memory_Key, false, false);
+		if (!Handle.Valid || Handle.Pointer == nullptr) return false;
+		Ring = static_cast<CommandRing::Ring*>(Handle.Pointer);
+		if (!Ring->IsCompatible()) return false;
+		Scaffolder = Ring->Register(L"Scaffolder");
+		Builder = Ring->Register(L"Builder");
+		return Scaffolder >= 0 && Builder >= 0;
+	}
+
+	void Follow(bool OnFoot)
+	{
+		const CoordinateInBlocks Feet = World::Player;
+		AtX.store(Feet.X);
+		AtY.store(Feet.Y);
+		AtZ.store(Feet.Z);
+		Open.store(OnFoot);
+	}
+
+	// Now and then a floor over the player's head for a few seconds, and releases for tags that may or may not be up
+	void TickScaffolder(RandomStream& Random)
+	{
+		const int Roll = World::RandomInt(Random, 0, 999);
+		const uint32_t Tag = uint32_t(World::RandomInt(Random, 0, Scaffolder_Tags - 1));
+		if (Roll < 5 && Open.load()) {
+			Ring->TryPush(Scaffolder, CommandRing::PlaceFootprint(AtX.load() + World::RandomInt(Random, -2, 2), AtY.load() + World::RandomInt(Random, -2, 2),
+				AtZ.load() + Floor_Height, uint16_t(World::RandomInt(Random, 0, 2)), Tag, uint32_t(World::RandomInt(Random, 20, 400))));
+		}
+		else if (Roll < 8) {
+			Ring->TryPush(Scaffolder, CommandRing::Release(Tag));
+		}
+	}
+
+	// Bursts of small floors from a thread of its own, far more than the mod takes in a tick
+	void RunBuilder(uint32_t Seed)
+	{
+		RandomStream Random = MakeRandomStream(Seed);
+		uint32_t Tag = 0;
+		while (!Stop.load()) {
+			for (int i = 0; i < Builder_Burst && Open.load(); i++) {
+				Ring->TryPush(Builder, CommandRing::PlaceFootprint(AtX.load() + World::RandomInt(Random, -2, 2), AtY.load() + World::RandomInt(Random, -2, 2),
+					AtZ.load() + Floor_Height + 1, uint16_t(World::RandomInt(Random, 0, 1)), Tag++ % Builder_Tags, uint32_t(World::RandomInt(Random, 10, 200))));
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+		}
+	}
+}
+
+// The game would have spent a whole tick between two of ours, the simulation doesn't, so let a save finish
+// before carrying on. Otherwise saves get skipped and a crash loses far more than it could in the game.
+void WaitForSave()
+{
+	while (saveInFlight) {
+		jobPool.CollectCompletedJobs();
+		std::this_thread::yield();
+	}
+}
+
+struct ClimbResult {
+	double WritesPerBlock = 0;
+	int LongestStep = 0;
+	int Highest = 0;	// Blocks above the start the platform got to
+};
+
+// Holds the hand at full rate until the platform is Blocks higher, then brings it back down, and counts the host
+// writes per block travelled. Without Fast the gesture never switches to Fast_Climb_Rate, as before fast climbs.
+// Where DumpFlightRecorder writes the dumps for each kind of anomaly
+std::filesystem::path FlightDumpPath(size_t Kind)
+{
+	const std::filesystem::path SavePath(GetFilePath());
+	return SavePath.parent_path() / (SavePath.stem().wstring() + L"." + FlightRecorder::Anomaly_Names[Kind] + L".flight");
+}
+
+ClimbResult MeasureClimb(bool Fast, int Blocks)
+{
+	ClimbResult Result;
+	ConfigureGestures();
+	gestureEngine.Settings.FastAfter = Fast ? Fast_Climb_Hold_Samples : 0;
+
+	// Hands apart until the fall guard has found the platform under the player
+	auto Settle = []() {
+		World::GestureActive = false;
+		for (int Tick = 0; Tick < 8; Tick++) {
+			Event_Tick();
+			World::SettlePlayer();
+		}
+	};
+	Settle();
+	const uint64_t WritesBefore = World::Writes;
+	const int16_t Start = platformHeight;
+
+	for (int Direction : { 1, -1 }) {
+		World::GestureActive = true;
+		World::GestureOffset = 60 * Direction;
+		for (int Tick = 0; Tick < 100 * Blocks && (Direction > 0 ? platformHeight < Start + Blocks : platformHeight > Start); Tick++) {
+			const int16_t Before = platformHeight;
+			WaitForSave();
+			Event_Tick();
+			World::SettlePlayer();
+			Result.LongestStep = std::max(Result.LongestStep, std::abs(platformHeight - Before));
+			Result.Highest = std::max(Result.Highest, platformHeight - Start);
+		}
+		Settle();
+	}
+
+	ConfigureGestures();
+	Result.WritesPerBlock = double(World::Writes - WritesBefore) / (2 * Blocks);
+	return Result;
+}
+
+size_t ResidentBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS Counters = {};
+	GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters));
+	return Counters.WorkingSetSize;
+#else
+	size_t Pages = 0, Resident = 0;
+	if (FILE* Statm = std::fopen("/proc/self/statm", "r")) {
+		if (std::fscanf(Statm, "%zu %zu", &Pages, &Resident) != 2) Resident = 0;
+		std::fclose(Statm);
+	}
+	return Resident * size_t(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+// What the mod and the simulated world legitimately hold more of the longer the run goes: bridge cells, floor clouds
+// and changed cells in the world. Everything else is bounded, so resident memory may only grow by what these need.
+struct StoredEntries {
+	size_t BridgeCells = 0;
+	size_t BridgeChunks = 0;
+	size_t FloorClouds = 0;
+	size_t ChangedCells = 0;
+
+	// High-water marks, the allocator rarely gives memory back once it has it
+	void Update()
+	{
+		size_t Clouds = 0;
+		for (const ExternalFloor& Floor : externalFloors) Clouds += Floor.clouds.size();
+		BridgeCells = std::max(BridgeCells, bridges.Size());
+		BridgeChunks = std::max(BridgeChunks, bridges.ChunkCount());
+		FloorClouds = std::max(FloorClouds, Clouds);
+		ChangedCells = std::max(ChangedCells, World::Changed.size());
+	}
+
+	// Vectors can hold up to twice what they need, every unordered_map node has a next pointer, a bucket and malloc's
+	// header. A bridge cell is an Entry in its chunk plus at worst a Run of its own in the cached runs, a chunk is its
+	// bitset, two vectors and a shared_ptr.
+	size_t Bytes() const
+	{
+		const size_t Node_Overhead = 4 * sizeof(void*);
+		const size_t Bridge_Cell_Bytes = 2 * (sizeof(uint16_t) + sizeof(BlockInfo)) + sizeof(Bridges::Run);
+		const size_t Bridge_Chunk_Bytes = sizeof(uint64_t) + sizeof(std::bitset<Bridges::Chunk_Volume>) + 2 * sizeof(std::vector<int>)
+			+ sizeof(std::shared_ptr<int>) + Node_Overhead;
+		const size_t Floor_Cloud_Bytes = 2 * sizeof(Cloud);
+		const size_t Changed_Cell_Bytes = sizeof(std::pair<const uint64_t, World::Cell>) + Node_Overhead;
+		return BridgeCells * Bridge_Cell_Bytes + BridgeChunks * Bridge_Chunk_Bytes + FloorClouds * Floor_Cloud_Bytes + ChangedCells * Changed_Cell_Bytes;
+	}
+};
+
+// Maps the slice file and puts it under the player, false if it can't be read or isn't a slice
+bool LoadSlice(const char* Path)
+{
+	const auto Start = std::chrono::steady_clock::now();
+	const uint8_t* Data = nullptr;
+	size_t Size = 0;
+
+#if defined(_WIN32)
+	HANDLE File = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (File == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER FileSize = {};
+	HANDLE Mapping = GetFileSizeEx(File, &FileSize) ? CreateFileMappingA(File, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	if (Mapping != NULL) {
+		Data = static_cast<const uint8_t*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+		Size = size_t(FileSize.QuadPart);
+		CloseHandle(Mapping);
+	}
+	CloseHandle(File);
+#else
+	const int File = open(Path, O_RDONLY);
+	if (File < 0) return false;
+	struct stat Status = {};
+	if (fstat(File, &Status) == 0 && Status.st_size > 0) {
+		void* Mapped = mmap(nullptr, size_t(Status.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+		if (Mapped != MAP_FAILED) {
+			Data = static_cast<const uint8_t*>(Mapped);
+			Size = size_t(Status.st_size);
+		}
+	}
+	close(File);
+#endif
+
+	// Stays mapped until the process ends
+	if (!World::Slice.Open(Data, Size)) return false;
+	const double Milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+
+	World::SliceShift = World::Slice.GetCenter() - CoordinateInBlocks(World::Player);
+	const CoordinateInBlocks SliceSize = World::Slice.GetSize();
+	World::TerrainTop = std::max(World::TerrainTop, World::Slice.GetOrigin().Z - World::SliceShift.Z + SliceSize.Z);
+	std::printf("slice %s: %lld x %lld x %d blocks, %zu kinds, %zu KB, mapped and checked in %.2f ms\n", Path, (long long) SliceSize.X,
+		(long long) SliceSize.Y, int(SliceSize.Z), World::Slice.GetPaletteSize(), Size / 1024, Milliseconds);
+	return true;
+}
+
+struct CheckResult {
+	uint64_t Clouds = 0;
+	uint64_t Orphans = 0;
+	uint64_t Stale = 0;			// Tracked but no longer a cloud, harmless
+};
+
+CheckResult CheckClouds(uint64_t Tick)
+{
+	std::unordered_set<uint64_t> Known;
+	for (const Cloud& Tracked : platformCoords) Known.insert(World::Key(Tracked.location));
+	for (size_t i = savedCloudsReconciled; i < savedClouds.size(); i++) Known.insert(World::Key(savedClouds[i].location));
+	for (const ExternalFloor& Floor : externalFloors) {
+		for (const Cloud& Tracked : Floor.clouds) Known.insert(World::Key(Tracked.location));
+	}
+
+	CheckResult Result;
+	for (const auto& [Key, Changed] : World::Changed) {
+		if (!World::IsCloud(Changed.Block)) continue;
+		Result.Clouds++;
+		if (Known.count(Key) || bridges.Contains(Changed.At)) continue;
+
+		if (Result.Orphans++ < 5) {
+			std::printf("  tick %llu: orphaned cloud at %lld %lld %d\n", (unsigned long long) Tick,
+				(long long) Changed.At.X, (long long) Changed.At.Y, int(Changed.At.Z));
+		}
+	}
+	for (const Cloud& Tracked : platformCoords) {
+		if (!World::IsCloud(World::Get(Tracked.location))) Result.Stale++;
+	}
+	return Result;
+}
+
+void HitWithTool(const UniqueID& Block, const wchar_t* Tool)
+{
+	const CoordinateInBlocks At = World::Player;
+	Event_BlockHitByTool(At, Block, Tool, World::Player, false);
+}
+
+// The top block of the column, what the player would mark to land on
+CoordinateInBlocks GroundAt(int64_t X, int64_t Y)
+{
+	for (int Z = World::TerrainTop + 8; Z > World_Min_Height; Z--) {
+		// Clouds are skipped, hitting one of our own blocks with the sledgehammer doesn't mark a target
+		const BlockInfo Block = World::Get(CoordinateInBlocks(X, Y, int16_t(Z)));
+		if (World::IsSupportive(Block) && Block.Type != EBlockType::ModBlock) return CoordinateInBlocks(X, Y, int16_t(Z));
+	}
+	return CoordinateInBlocks(X, Y, int16_t(World_Min_Height));
+}
+
+// The cells the player's body is in may hold our own clouds but nothing else the player would collide with
+bool PlayerCollides()
+{
+	const CoordinateInBlocks Feet = World::Player;
+	for (int Z = 0; Z < (playerHeight + 49) / 50; Z++) {
+		const BlockInfo Block = World::Get(Feet + CoordinateInBlocks(0, 0, int16_t(Z)));
+		if (World::IsSupportive(Block) && !World::IsCloud(Block)) return true;
+	}
+	return false;
+}
+
+struct FlightResult {
+	uint64_t Writes = 0;
+	uint64_t Rescues = 0;
+	uint64_t Catches = 0;
+};
+
+// The same flight with one platform plane and with two: from the ground up above the spires, a walk, a descent while
+// walking, three cells broken under the player's feet one after the other, and the way back down standing still.
+// Counts the host writes from turning cloud walking on to the platform being gone again.
+FlightResult MeasureFlight(bool SinglePlane)
+{
+	FlightResult Result;
+	RandomStream Script = MakeRandomStream(49);
+	double Heading = 0.3;
+
+	if (cloudWalkingEnabled) ToggleCloudWalking(World::Player);
+	while (operations.IsRunning(LongOperation::PlatformRemoval)) {
+		WaitForSave();
+		Event_Tick();
+	}
+	ConfigureGestures();
+	const bool SinglePlaneBefore = singlePlanePlatform;
+	singlePlanePlatform = SinglePlane;
+	World::Player = CoordinateInCentimeters(Flight_Start_X * 50, Flight_Start_Y * 50, uint16_t(GroundAt(Flight_Start_X, Flight_Start_Y).Z * 50 + 25));
+
+	const uint64_t WritesBefore = World::Writes, RescuesBefore = fallRescues, CatchesBefore = sinkCatches;
+	ToggleCloudWalking(World::Player);
+
+	auto Fly = [&](int Ticks, int GestureOffset, bool Walk, auto Until) {
+		World::GestureActive = GestureOffset != 0;
+		World::GestureOffset = GestureOffset;
+		for (int Tick = 0; Tick < Ticks && !Until(); Tick++) {
+			if (Walk) World::MovePlayer(Script, Heading);
+			else World::SettlePlayer();
+			WaitForSave();
+			Event_Tick();
+		}
+		World::GestureActive = false;
+	};
+	auto Never = []() { return false; };
+
+	Fly(8, 0, false, Never);
+	const int16_t Ground = platformHeight;
+	Fly(4000, 60, false, [&]() { return platformHeight >= Ground + Spire_Height + 10; });
+	Fly(800, 0, true, Never);
+	Fly(4000, -30, true, [&]() { return platformHeight <= Ground + Spire_Height; });
+	Fly(40, 0, true, Never);
+	for (int Break = 0; Break < 3; Break++) {
+		const CoordinateInBlocks UnderFoot = World::Player - CoordinateInCentimeters(0, 0, 25);
+		BlockInfo Replaced;
+		SimulatedHost::SetBlock(UnderFoot, BlockInfo(EBlockType::Air), Replaced);
+		Fly(120, 0, true, Never);
+	}
+	Fly(400, 0, true, Never);
+	Fly(4000, -60, false, [&]() { return platformHeight <= Ground + 2; });
+	Fly(40, 0, false, Never);
+
+	ToggleCloudWalking(World::Player);
+	while (operations.IsRunning(LongOperation::PlatformRemoval)) {
+		WaitForSave();
+		Event_Tick();
+	}
+
+	Result.Writes = World::Writes - WritesBefore;
+	Result.Rescues = fallRescues - RescuesBefore;
+	Result.Catches = sinkCatches - CatchesBefore;
+	singlePlanePlatform = SinglePlaneBefore;
+	return Result;
+}
+
+struct LoadResult {
+	int64_t LoadMicroseconds = 0;
+	int ReconcileTicks = 0;
+	int64_t ReconcileMicrosecondsTotal = 0;
+	int64_t ReconcileMicrosecondsMax = 0;
+	size_t CloudsLeft = 0;	// Saved clouds still in the world after the recovery finished
+};
+
+// Leaves the world with Clouds clouds in a square above the terrain, out of the platform's reach, and a save that
+// lists them all, as a long bridge or a crash would leave it. Times the load, then ticks until the recovery has put
+// the air back everywhere.
+LoadResult MeasureLargeLoad(size_t Clouds)
+{
+	LoadResult Result;
+	Event_OnExit();
+
+	const CoordinateInBlocks Player = World::Player;
+	const int Side = int(std::ceil(std::sqrt(double(Clouds))));
+	std::vector<Cloud> Saved;
+	for (size_t i = 0; i < Clouds; i++) {
+		const CoordinateInBlocks At(Player.X + 4 * Maximum_Platform_Radius + int64_t(i) % Side, Player.Y + int64_t(i) / Side, int16_t(World::TerrainTop + 20));
+		BlockInfo Replaced;
+		SimulatedHost::SetBlock(At, BlockInfo(Cloud_Block), Replaced);
+		Saved.push_back(Cloud(At, Replaced));
+	}
+	WriteSaveFile(GetFilePath(), playerHeight, false, platformRadius, platformShape, singlePlanePlatform, Saved, false, {}, false, CoordinateInBlocks(), {});
+
+	const auto LoadStart = std::chrono::steady_clock::now();
+	Load();
+	Result.LoadMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - LoadStart).count();
+	for (int Tick = 0; Tick < 100000 && operations.IsRunning(LongOperation::Reconcile); Tick++) {
+		WaitForSave();
+		Event_Tick();
+	}
+
+	Result.ReconcileTicks = reconcileTicks;
+	Result.ReconcileMicrosecondsTotal = reconcileMicrosecondsTotal;
+	Result.ReconcileMicrosecondsMax = reconcileMicrosecondsMax;
+	for (const Cloud& Left : Saved) {
+		if (World::IsCloud(World::Get(Left.location))) Result.CloudsLeft++;
+	}
+	return Result;
+}
+
+// A purge of a cloud-filled ball that takes one batch a tick, with the platform task rebuilding the platform in
+// between, as it does in the game when the purge runs out of budget. Counts into PurgeHoles when it finishes.
+void PurgeOneBatchATick()
+{
+	while (!cloudWalkingEnabled || operations.IsRunning(LongOperation::PlatformRemoval)) {
+		if (!cloudWalkingEnabled) HitWithTool(Cloud_Walker_Block, L"T_Stick");
+		WaitForSave();
+		Event_Tick();
+	}
+	for (int Tick = 0; Tick < 8; Tick++) Event_Tick();
+
+	const CoordinateInBlocks Feet = World::Player;
+	for (const CoordinateInBlocks& Cell : GetAllCoordinatesInRadius(Feet + CoordinateInBlocks(0, 0, 4), 3)) {
+		BlockInfo Replaced;
+		SimulatedHost::SetBlock(Cell, BlockInfo(Cloud_Block), Replaced);
+	}
+
+	// The purge takes the platform down a cell at a checkpoint first, with a budget left that's all in one tick
+	HitWithTool(Cloud_Walker_Block, L"T_Axe_Stone");
+	while (operations.IsRunning(LongOperation::Purge) && !platformCoords.empty()) operations.Resume(0);
+	while (operations.IsRunning(LongOperation::Purge)) {
+		operations.Resume(0);
+		RunPlatformMaintenance();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint64_t Ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : Default_Ticks;
+	const uint32_t Seed = argc > 2 ? uint32_t(std::strtoul(argv[2], nullptr, 10)) : 1;
+	if (argc > 3 && !LoadSlice(argv[3])) {
+		std::printf("can't load the world slice %s\n", argv[3]);
+		return 1;
+	}
+
+	std::error_code Ignored;
+	std::filesystem::remove(std::filesystem::path(GetFilePath()), Ignored);
+	for (size_t Kind = 0; Kind < size_t(FlightRecorder::Anomaly::Count); Kind++) std::filesystem::remove(FlightDumpPath(Kind), Ignored);
+
+	RandomStream Random = MakeRandomStream(Seed);
+	double Heading = 0;
+	uint64_t Toggles = 0, RadiusChanges = 0, Purges = 0, Teleports = 0, Reloads = 0, Crashes = 0, Gestures = 0;
+	uint64_t Checks = 0, ChecksSkipped = 0, Orphans = 0, MaxStale = 0, MaxClouds = 0;
+	uint64_t TicksCloudWalking = 0, BridgeToggles = 0, SegmentRemovals = 0;
+	uint64_t Flights = 0, TicksFlying = 0, Collisions = 0, Arrivals = 0, MissedTargets = 0, StrayMarks = 0;
+	uint64_t Drops = 0;
+	CoordinateInBlocks FlightTarget;
+	size_t MaxPlatformCoords = 0, MaxSavedClouds = 0, MaxBridgeCells = 0;
+	size_t MidRunResident = 0;
+	StoredEntries MidRunStored, Stored;
+	const size_t StartResident = ResidentBytes();
+	int GestureTicksLeft = 0;
+
+	Load();
+	operations.OnFinished = SoakOperationFinished;
+	const LoadResult LargeLoad = MeasureLargeLoad(Large_Save_Clouds);
+	HitWithTool(Cloud_Walker_Block, L"T_Stick");
+	Toggles++;
+
+	const ClimbResult NormalClimb = MeasureClimb(false, Climb_Test_Blocks);
+	const ClimbResult FastClimb = MeasureClimb(true, Climb_Test_Blocks);
+	const FlightResult TwoPlaneFlight = MeasureFlight(false);
+	const FlightResult OnePlaneFlight = MeasureFlight(true);
+	PurgeOneBatchATick();
+
+	const bool ClientsConnected = Clients::Connect();
+	RandomStream ClientRandom = MakeRandomStream(Seed + 1);
+	std::thread BuilderThread;
+	if (ClientsConnected) BuilderThread = std::thread(Clients::RunBuilder, Seed + 2);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint64_t Tick = 1; Tick <= Ticks; Tick++) {
+		const uint32_t Roll = uint32_t(World::RandomInt(Random, 0, 999999));
+
+		if (Roll < 60) {
+			HitWithTool(Cloud_Walker_Block, L"T_Stick");
+			Toggles++;
+		}
+		else if (Roll < 300) {
+			HitWithTool(Cloud_Block, L"T_Arrow");
+			RadiusChanges++;
+		}
+		else if (Roll < 325) {
+			HitWithTool(Cloud_Walker_Block, L"T_Axe_Stone");
+			Purges++;
+		}
+		else if (Roll < 350) {
+			HitWithTool(Cloud_Block, L"T_Pickaxe_Stone");
+			Teleports++;
+		}
+		else if (Roll < 357) {
+			Event_OnExit();
+			Load();
+			Reloads++;
+		}
+		else if (Roll < 367) {
+			Crash();
+			Load();
+			Crashes++;
+		}
+		else if (Roll < 377) {
+			HitWithTool(Cloud_Walker_Block, L"T_Pickaxe_Stone");
+			BridgeToggles++;
+		}
+		else if (Roll < 397) {
+			// Take down whichever bridge is nearest, if there is one close enough to hit
+			CoordinateInBlocks Target;
+			bool Found = false;
+			bridges.ForEachNear(World::Player, 16, [&](const CoordinateInBlocks& Location, const BlockInfo&) {
+				if (!Found) Target = Location;
+				Found = true;
+			});
+			if (Found) {
+				Event_BlockHitByTool(Target, Cloud_Block, L"T_Shovel_Stone", World::Player, false);
+				SegmentRemovals++;
+			}
+		}
+		else if (Roll < 417 && cloudWalkingEnabled && !autopilot.IsActive() && !operations.IsRunning(LongOperation::RoutePlanning)) {
+			// Arm the autopilot, mark a block up to 150 blocks away, then hit the platform to fly there
+			const double Direction = double(World::RandomInt(Random, 0, 6283)) / 1000.0;
+			const int Distance = World::RandomInt(Random, 20, 150);
+			const CoordinateInBlocks Player = World::Player;
+			FlightTarget = GroundAt(Player.X + int64_t(std::cos(Direction) * Distance), Player.Y + int64_t(std::sin(Direction) * Distance));
+			// Mining with a sledgehammer before the autopilot is armed must not mark anything
+			Event_AnyBlockHitByTool(FlightTarget, World::Get(FlightTarget), L"T_Sledgehammer_Iron", World::Player, false);
+			if (autopilotTargetSet) StrayMarks++;
+			HitWithTool(Cloud_Block, L"T_Sledgehammer_Copper");
+			Event_AnyBlockHitByTool(FlightTarget, World::Get(FlightTarget), L"T_Sledgehammer_Iron", World::Player, false);
+			HitWithTool(Cloud_Block, L"T_Sledgehammer_Copper");
+			Flights++;
+		}
+		else if (Roll < 437 && cloudWalkingEnabled && !autopilot.IsActive()) {
+			// The game drops the player through the platform into the air under it, the flight recorder has to write a dump
+			const CoordinateInCentimeters Dropped(World::Player.X, World::Player.Y, uint16_t(World::Player.Z - 150));
+			if (!World::IsSupportive(World::Get(Dropped - CoordinateInCentimeters(0, 0, 25)))) {
+				World::Player = Dropped;
+				Drops++;
+			}
+		}
+		else if (Roll < 2897 && GestureTicksLeft == 0) {
+			// Half up, half down, from barely outside the dead zone to well past full rate
+			GestureTicksLeft = World::RandomInt(Random, 10, 80);
+			World::GestureOffset = World::RandomInt(Random, 10, 60) * (World::RandomInt(Random, 0, 1) ? 1 : -1);
+			Gestures++;
+		}
+
+		World::GestureActive = GestureTicksLeft > 0;
+		if (GestureTicksLeft > 0) GestureTicksLeft--;
+
+		// The player stands still while the autopilot is working
+		const uint64_t ArrivalsBefore = autopilotArrivals;
+		if (!autopilot.IsActive() && !operations.IsRunning(LongOperation::RoutePlanning)) World::MovePlayer(Random, Heading);
+		if (ClientsConnected) {
+			const CoordinateInBlocks UnderFoot = World::Player - CoordinateInCentimeters(0, 0, 25);
+			Clients::Follow(!autopilot.IsActive() && !operations.IsRunning(LongOperation::RoutePlanning) && World::IsSupportive(World::Get(UnderFoot))
+				&& !World::IsCloud(World::Get(UnderFoot)));
+			Clients::TickScaffolder(ClientRandom);
+		}
+		WaitForSave();
+		Event_Tick();
+
+		if (autopilot.IsActive()) {
+			TicksFlying++;
+			if (PlayerCollides() && Collisions++ < 5) {
+				std::printf("  tick %llu: the autopilot flew the player into a block at %lld %lld %d\n", (unsigned long long) Tick,
+					(long long) World::Player.X, (long long) World::Player.Y, int(World::Player.Z));
+			}
+		}
+		if (autopilotArrivals != ArrivalsBefore) {
+			Arrivals++;
+			const CoordinateInBlocks UnderFoot = World::Player - CoordinateInCentimeters(0, 0, 25);
+			if (!(UnderFoot == FlightTarget) && MissedTargets++ < 5) {
+				std::printf("  tick %llu: the autopilot landed at %lld %lld %d instead of %lld %lld %d\n", (unsigned long long) Tick,
+					(long long) UnderFoot.X, (long long) UnderFoot.Y, int(UnderFoot.Z), (long long) FlightTarget.X, (long long) FlightTarget.Y, int(FlightTarget.Z));
+			}
+		}
+
+		if (cloudWalkingEnabled) TicksCloudWalking++;
+		MaxPlatformCoords = std::max(MaxPlatformCoords, platformCoords.size());
+		MaxSavedClouds = std::max(MaxSavedClouds, savedClouds.size());
+		MaxBridgeCells = std::max(MaxBridgeCells, bridges.Size());
+		Stored.Update();
+
+		if (Tick % Check_Interval != 0) continue;
+
+		// Clouds from the save aren't all accounted for until the sweep after reconciliation is done, and a bridge
+		// segment being taken down has left the index before it has left the world
+		if (operations.IsRunning(LongOperation::Reconcile) || operations.IsRunning(LongOperation::BridgeRemoval)) {
+			ChecksSkipped++;
+			continue;
+		}
+
+		CheckResult Result = CheckClouds(Tick);
+		Checks++;
+		Orphans += Result.Orphans;
+		MaxStale = std::max(MaxStale, Result.Stale);
+		MaxClouds = std::max(MaxClouds, Result.Clouds);
+		if (Tick <= Ticks / 2) {
+			MidRunResident = std::max(MidRunResident, ResidentBytes());
+			MidRunStored = Stored;
+		}
+	}
+
+	// Every floor has to come down once the clients stop asking
+	Clients::Stop.store(true);
+	Clients::Open.store(false);
+	if (BuilderThread.joinable()) BuilderThread.join();
+	World::GestureActive = false;
+	for (int Tick = 0; Tick < Floor_Max_Ticks && (!externalFloors.empty() || commandRing.Size() > 0); Tick++) {
+		WaitForSave();
+		Event_Tick();
+	}
+	const size_t FloorsLeft = externalFloors.size();
+	if (!operations.IsRunning(LongOperation::Reconcile) && !operations.IsRunning(LongOperation::BridgeRemoval)) Orphans += CheckClouds(Ticks).Orphans;
+
+	// Everything the bridge index holds has to come back from the save
+	SaveData();
+	WaitForSave();
+	const size_t BridgeCells = bridges.Size();
+	Event_OnExit();
+	Load();
+	const size_t BridgeCellsLoaded = bridges.Size();
+	Event_OnExit();
+	const bool RingLeftPublished = World::SharedMemory[CommandRing::Shared_Memory_Key] != nullptr;
+
+	std::error_code SizeError;
+	const uintmax_t SaveBytes = std::filesystem::file_size(std::filesystem::path(GetFilePath()), SizeError);
+	const size_t EndResident = ResidentBytes();
+	double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("\n%llu ticks in %.1f s (seed %u)\n", (unsigned long long) Ticks, Seconds, Seed);
+	std::printf("toggles %llu, radius changes %llu, purges %llu, teleports %llu, reloads %llu, crashes %llu, gestures %llu\n",
+		(unsigned long long) Toggles, (unsigned long long) RadiusChanges, (unsigned long long) Purges, (unsigned long long) Teleports,
+		(unsigned long long) Reloads, (unsigned long long) Crashes, (unsigned long long) Gestures);
+	std::printf("cloud walking for %llu ticks, fall rescues %llu, orphans swept after crashes %llu, log lines %llu, warnings %llu\n",
+		(unsigned long long) TicksCloudWalking, (unsigned long long) fallRescues, (unsigned long long) orphanedCloudsSwept, (unsigned long long) World::LogLines, (unsigned long long) World::Warnings);
+	std::printf("checks %llu (%llu skipped during recovery), orphaned clouds %llu, most clouds in the world %llu, most stale entries %llu, holes after purges %llu\n",
+		(unsigned long long) Checks, (unsigned long long) ChecksSkipped, (unsigned long long) Orphans, (unsigned long long) MaxClouds, (unsigned long long) MaxStale,
+		(unsigned long long) PurgeHoles);
+	std::printf("platformCoords high-water %zu (bound %zu), savedClouds high-water %zu, changed cells %zu\n",
+		MaxPlatformCoords, Platform_Coords_Bound, MaxSavedClouds, World::Changed.size());
+	std::printf("bridge mode toggles %llu, segment removals %llu, bridge cells high-water %zu, at the end %zu (%zu after reload), save file %llu bytes\n",
+		(unsigned long long) BridgeToggles, (unsigned long long) SegmentRemovals, MaxBridgeCells, BridgeCells, BridgeCellsLoaded,
+		(unsigned long long) (SizeError ? 0 : SaveBytes));
+	std::printf("autopilot flights %llu, routes planned %llu (max %lld us in a tick), arrivals %llu, %llu ticks flying, collisions %llu, missed targets %llu, targets marked while not armed %llu\n",
+		(unsigned long long) Flights, (unsigned long long) RoutesPlanned, (long long) MaxRouteMicrosecondsPerTick, (unsigned long long) Arrivals,
+		(unsigned long long) TicksFlying, (unsigned long long) Collisions, (unsigned long long) MissedTargets, (unsigned long long) StrayMarks);
+	const PlaceIfReplaceableStats& PlaceStats = GetPlaceIfReplaceableStats();
+	std::printf("PlaceIfReplaceable: %llu of %llu cells placed, %llu declined without writing, %llu reverted\n", (unsigned long long) PlaceStats.Placed,
+		(unsigned long long) PlaceStats.Attempts, (unsigned long long) PlaceStats.Declined, (unsigned long long) PlaceStats.Reverted);
+	std::printf("climbing %d blocks and back: %.1f host writes per block at normal speed, %.1f with fast climbs (%d blocks a step)\n",
+		Climb_Test_Blocks, NormalClimb.WritesPerBlock, FastClimb.WritesPerBlock, FastClimb.LongestStep);
+	std::printf("loading %zu saved clouds: %lld us, reconciled over %d ticks (%lld us total, %lld us max per tick), %zu left in the world\n",
+		Large_Save_Clouds, (long long) LargeLoad.LoadMicroseconds, LargeLoad.ReconcileTicks, (long long) LargeLoad.ReconcileMicrosecondsTotal,
+		(long long) LargeLoad.ReconcileMicrosecondsMax, LargeLoad.CloudsLeft);
+	std::printf("scripted flight: %llu host writes and %llu fall rescues with two platform planes, %llu writes and %llu rescues with one (%llu sinking players caught)\n",
+		(unsigned long long) TwoPlaneFlight.Writes, (unsigned long long) TwoPlaneFlight.Rescues, (unsigned long long) OnePlaneFlight.Writes,
+		(unsigned long long) OnePlaneFlight.Rescues, (unsigned long long) OnePlaneFlight.Catches);
+	if (ClientsConnected) {
+		for (int Client : { Clients::Scaffolder, Clients::Builder }) {
+			const CommandRing::ClientStats& Stats = commandRing.Clients[Client];
+			std::printf("%ls: %llu commands queued, %llu ring full, %llu throttled, %llu refused, %llu floors placed with %llu clouds, %llu released, %llu expired\n",
+				Stats.Name, (unsigned long long) Stats.Queued.load(), (unsigned long long) Stats.Full.load(), (unsigned long long) Stats.Throttled.load(),
+				(unsigned long long) Stats.Refused.load(), (unsigned long long) Stats.Placed.load(), (unsigned long long) Stats.Cells.load(),
+				(unsigned long long) Stats.Released.load(), (unsigned long long) Stats.Expired.load());
+		}
+	}
+	const size_t Memory_Growth_Limit = Stored.Bytes() - MidRunStored.Bytes() + Memory_Growth_Slack;
+	std::printf("resident memory start %zu KB, first half %zu KB, end %zu KB, allowed to grow %zu KB in the second half (%zu more bridge cells, %zu more changed cells)\n",
+		StartResident / 1024, MidRunResident / 1024, EndResident / 1024, Memory_Growth_Limit / 1024,
+		Stored.BridgeCells - MidRunStored.BridgeCells, Stored.ChangedCells - MidRunStored.ChangedCells);
+
+	// The last dump of each kind is still on disk, every one has to read back
+	size_t DumpsUnreadable = 0;
+	std::printf("flight recorder: %llu drops through the platform, %llu dumps,", (unsigned long long) Drops, (unsigned long long) flightDumps);
+	for (size_t Kind = 0; Kind < size_t(FlightRecorder::Anomaly::Count); Kind++) {
+		std::ifstream DumpFile(FlightDumpPath(Kind), std::ios::binary);
+		if (!DumpFile.is_open()) continue;
+		const std::vector<uint8_t> Bytes((std::istreambuf_iterator<char>(DumpFile)), std::istreambuf_iterator<char>());
+		FlightRecorder::Dump Read;
+		if (!FlightRecorder::Decode(Bytes.data(), Bytes.size(), Read) || Read.Header.Reason != Kind || Read.Ticks.empty()) {
+			DumpsUnreadable++;
+			continue;
+		}
+		std::printf(" last %ls at tick %llu with %zu ticks, %zu writes, %zu KB,", FlightRecorder::Anomaly_Names[Kind],
+			(unsigned long long) Read.Header.ReasonTick, Read.Ticks.size(), Read.Edits.size(), Bytes.size() / 1024);
+	}
+	std::printf(" %zu unreadable\n", DumpsUnreadable);
+
+	bool Failed = false;
+	if (Orphans > 0) {
+		std::printf("FAIL: orphaned clouds\n");
+		Failed = true;
+	}
+	if (LargeLoad.CloudsLeft > 0) {
+		std::printf("FAIL: saved clouds left in the world after loading a large save\n");
+		Failed = true;
+	}
+	if (PurgeHoles > 0) {
+		std::printf("FAIL: purges left holes in the platform\n");
+		Failed = true;
+	}
+	if (!ClientsConnected || FloorsLeft > 0) {
+		std::printf(ClientsConnected ? "FAIL: %zu floors still up after the clients stopped\n" : "FAIL: no command ring to connect to\n", FloorsLeft);
+		Failed = true;
+	}
+	if (RingLeftPublished) {
+		std::printf("FAIL: the command ring is still published after Event_OnExit\n");
+		Failed = true;
+	}
+	if (Collisions > 0 || MissedTargets > 0 || StrayMarks > 0) {
+		std::printf("FAIL: the autopilot hit something, landed in the wrong place or took a target it wasn't armed for\n");
+		Failed = true;
+	}
+	if (NormalClimb.Highest < Climb_Test_Blocks || FastClimb.Highest < Climb_Test_Blocks) {
+		std::printf("FAIL: climbing from the ground didn't get %d blocks up\n", Climb_Test_Blocks);
+		Failed = true;
+	}
+	if (FastClimb.LongestStep < 2 || FastClimb.WritesPerBlock >= NormalClimb.WritesPerBlock) {
+		std::printf("FAIL: fast climbs didn't take bigger steps for fewer writes\n");
+		Failed = true;
+	}
+	if (OnePlaneFlight.Writes >= TwoPlaneFlight.Writes || OnePlaneFlight.Rescues > TwoPlaneFlight.Rescues) {
+		std::printf("FAIL: one platform plane didn't save writes without more fall rescues\n");
+		Failed = true;
+	}
+	if (BridgeCellsLoaded != BridgeCells) {
+		std::printf("FAIL: the save lost bridge cells\n");
+		Failed = true;
+	}
+	if (MaxPlatformCoords > Platform_Coords_Bound) {
+		std::printf("FAIL: platformCoords grew past %zu\n", Platform_Coords_Bound);
+		Failed = true;
+	}
+	if (MidRunResident > 0 && EndResident > MidRunResident + Memory_Growth_Limit) {
+		std::printf("FAIL: memory kept growing in the second half of the run\n");
+		Failed = true;
+	}
+	if (DumpsUnreadable > 0 || (Drops > 0 && flightDumps == 0)) {
+		std::printf("FAIL: the flight recorder didn't dump, or wrote dumps that don't read back\n");
+		Failed = true;
+	}
+	std::printf(Failed ? "FAILED\n" : "PASSED\n");
+	return Failed ? 1 : 0;
+}
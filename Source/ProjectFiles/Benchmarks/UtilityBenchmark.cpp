@@ -0,0 +1,343 @@
+/*******************************************************
+	Standalone microbenchmarks for the helpers in GameUtilities.cpp, GameFunctions.h and ToolNames.h.
+	Doesn't need the game or Windows, and is not part of Code.vcxproj.
+
+	Linux:		g++ -std=c++20 -O2 -I../Source UtilityBenchmark.cpp -o UtilityBenchmark -pthread && ./UtilityBenchmark
+	Windows:	cl /std:c++20 /O2 /EHsc /I..\Source UtilityBenchmark.cpp
+
+	Every benchmark prints ns per call and heap bytes/allocations per call.
+	Before timing anything, the integer coordinate conversions are checked exhaustively against the old double based
+	rounding, and the random functions are checked for values spread over their whole range on two threads without
+	SetRandomSeed. The program returns 1 if any value differs or a range comes out lopsided.
+*******************************************************/
+
+#include "GameUtilities.cpp"
+#include "ToolNames.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+static std::atomic<uint64_t> AllocatedBytes = 0;
+static std::atomic<uint64_t> AllocationCount = 0;
+
+// Counts, then hands the block to the library's aligned operator new, which this file doesn't replace, so every
+// allocation and release still goes through a matching pair of the usual allocation functions
+static constexpr std::align_val_t Default_Alignment = std::align_val_t(__STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+void* operator new(size_t Size)
+{
+	AllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+	AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	return ::operator new(Size, Default_Alignment);
+}
+
+void operator delete(void* Memory) noexcept { ::operator delete(Memory, Default_Alignment); }
+void operator delete(void* Memory, size_t) noexcept { ::operator delete(Memory, Default_Alignment); }
+
+#if defined(_MSC_VER)
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+static volatile uint64_t Sink = 0;
+
+// Keeps the compiler from throwing away a result we never read
+template<typename T>
+inline void DoNotOptimize(const T& Value)
+{
+#if defined(_MSC_VER)
+	Sink = Sink + *reinterpret_cast<const volatile char*>(&Value);
+#else
+	asm volatile("" : : "r,m"(Value) : "memory");
+#endif
+}
+
+// Not inlined into main: GCC optimizes main for size as it only runs once, which turns divisions by a constant in
+// the timed loop back into idiv and makes the integer conversions look slower than they are in the mod
+template<typename Function>
+BENCHMARK_NOINLINE void Benchmark(const char* Name, uint64_t Iterations, Function&& Body)
+{
+	for (uint64_t i = 0; i < Iterations / 10 + 1; i++) Body(i);
+
+	uint64_t bytesBefore = AllocatedBytes.load();
+	uint64_t countBefore = AllocationCount.load();
+	auto start = std::chrono::steady_clock::now();
+
+	for (uint64_t i = 0; i < Iterations; i++) Body(i);
+
+	auto end = std::chrono::steady_clock::now();
+	double nanoseconds = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+	std::printf("%-44s %12.2f ns/call %12.1f bytes/call %8.2f allocs/call\n", Name,
+		nanoseconds / double(Iterations),
+		double(AllocatedBytes.load() - bytesBefore) / double(Iterations),
+		double(AllocationCount.load() - countBefore) / double(Iterations));
+}
+
+// The conversions as they were before DivideRoundNearest/RoundToInt64
+constexpr CoordinateInBlocks LegacyToBlocks(const CoordinateInCentimeters CIM)
+{
+	return CoordinateInBlocks(round_custom(double(CIM.X) / 50), round_custom(double(CIM.Y) / 50), int16_t(round_custom(double(CIM.Z) / 50)));
+}
+
+// How Event_BlockHitByTool told tools apart before ToolNames.h, for a hit on Cloud_Walker_Block
+static int LegacyToolAction(std::wstring ToolName)
+{
+	if (ToolName == L"T_Stick") return 1;
+	if (ToolName == L"T_Axe_Stone" || ToolName == L"T_Axe_Copper" || ToolName == L"T_Axe_Iron") return 2;
+	if (ToolName == L"T_Pickaxe_Stone" || ToolName == L"T_Pickaxe_Copper" || ToolName == L"T_Pickaxe_Iron") return 3;
+	if (ToolName == L"T_Shovel_Stone" || ToolName == L"T_Shovel_Copper" || ToolName == L"T_Shovel_Iron") return 4;
+	if (ToolName == L"T_Arrow") return 5;
+	return 0;
+}
+
+static const wchar_t* const Hit_Tool_Names[] = { L"T_Stick", L"T_Arrow", L"T_Shovel_Iron", L"T_Pickaxe_Copper", L"T_Sledgehammer_Iron",
+	L"T_Axe_Stone", L"T_Torch_Placeholder", L"T_Pickaxe_Stone" };
+
+static bool VerifyToolNames()
+{
+	bool Passed = true;
+	for (const Tools::Name& Entry : Tools::Names) {
+		const std::wstring Text(Entry.Text);
+		if (Tools::Classify(Text.c_str()) != Entry.Kind) {
+			std::printf("Tool name %ls doesn't classify as itself\n", Text.c_str());
+			Passed = false;
+		}
+		// Every proper prefix and a longer name must not match anything
+		for (size_t Length = 0; Length < Text.size(); Length++) {
+			if (Tools::Classify(Text.substr(0, Length).c_str()) != Tools::Tool::Unknown) {
+				std::printf("Prefix of %ls classifies as a tool\n", Text.c_str());
+				Passed = false;
+			}
+		}
+		if (Tools::Classify((Text + L"x").c_str()) != Tools::Tool::Unknown) {
+			std::printf("%ls with a suffix classifies as a tool\n", Text.c_str());
+			Passed = false;
+		}
+	}
+	std::printf("Tool name check: %s (hash seed %u)\n\n", Passed ? "passed" : "FAILED", Tools::Hashes.Seed);
+	return Passed;
+}
+
+static bool VerifyConversions()
+{
+	auto start = std::chrono::steady_clock::now();
+	uint64_t Mismatches = 0;
+
+	// Every centimeter X/Y a 32 bit world can hold, plus every Z
+	for (int64_t i = INT32_MIN; i <= INT32_MAX; i++) {
+		if (DivideRoundNearest<50>(i) != round_custom(double(i) / 50)) {
+			if (Mismatches++ < 10) std::printf("DivideRoundNearest mismatch at %lld\n", (long long) i);
+		}
+	}
+	for (uint32_t z = 0; z <= UINT16_MAX; z++) {
+		CoordinateInCentimeters Centimeters = CoordinateInCentimeters(0, 0, uint16_t(z));
+		if (!(CoordinateInBlocks(Centimeters) == LegacyToBlocks(Centimeters))) {
+			if (Mismatches++ < 10) std::printf("Z conversion mismatch at %u\n", z);
+		}
+	}
+
+	// Every float whose rounded value fits the 32 bit long lround returns on Windows
+	for (uint64_t Bits = 0; Bits <= UINT32_MAX; Bits++) {
+		uint32_t Bits32 = uint32_t(Bits);
+		float Value;
+		std::memcpy(&Value, &Bits32, sizeof(Value));
+		if (!std::isfinite(Value) || std::fabs(Value) >= 2147483520.0f) continue;
+
+		if (RoundToInt64(Value) != int64_t(std::lround(Value))) {
+			if (Mismatches++ < 10) std::printf("RoundToInt64 mismatch at %a\n", double(Value));
+		}
+	}
+
+	double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("Conversion check: %llu mismatches (%.1f s)\n\n", (unsigned long long) Mismatches, Seconds);
+	return Mismatches == 0;
+}
+
+// Every bucket must get within Random_Spread_Tolerance of Expected hits out of Random_Spread_Samples draws
+static constexpr int Random_Spread_Samples = 60000;
+static constexpr double Random_Spread_Tolerance = 0.1;
+
+static bool IsSpread(const char* Name, const std::vector<int>& Buckets, double Expected)
+{
+	bool Passed = true;
+	for (int Count : Buckets) {
+		if (std::fabs(double(Count) - Expected) > Expected * Random_Spread_Tolerance) Passed = false;
+	}
+	if (!Passed) {
+		std::printf("%s isn't spread out:", Name);
+		for (int Count : Buckets) std::printf(" %d", Count);
+		std::printf("\n");
+	}
+	return Passed;
+}
+
+static bool VerifyRandomSpread(uint64_t& FirstRaw)
+{
+	bool Passed = true;
+	std::vector<int> Buckets(6);
+	for (int i = 0; i < Random_Spread_Samples; i++) Buckets[GetRandomInt<0, 5>()]++;
+	Passed &= IsSpread("GetRandomInt<0, 5>", Buckets, double(Random_Spread_Samples) / double(Buckets.size()));
+
+	Buckets.assign(2, 0);
+	for (int i = 0; i < Random_Spread_Samples; i++) Buckets[GetRandomBool<2>() ? 1 : 0]++;
+	Passed &= IsSpread("GetRandomBool<2>", Buckets, double(Random_Spread_Samples) / double(Buckets.size()));
+
+	Buckets.assign(5, 0);
+	for (int i = 0; i < Random_Spread_Samples; i++) Buckets[GetRandomInt(-2, 2) + 2]++;
+	Passed &= IsSpread("GetRandomInt(-2, 2)", Buckets, double(Random_Spread_Samples) / double(Buckets.size()));
+
+	std::vector<int32_t> Filled(Random_Spread_Samples);
+	FillRandomInts(Filled.data(), Filled.size(), -2, 2);
+	Buckets.assign(5, 0);
+	for (int32_t Value : Filled) Buckets[Value + 2]++;
+	Passed &= IsSpread("FillRandomInts(-2, 2)", Buckets, double(Random_Spread_Samples) / double(Buckets.size()));
+
+	// Each of the 64 bits of the raw output set about half the time
+	Buckets.assign(64, 0);
+	FirstRaw = xoroshiro128p();
+	for (int i = 0; i < Random_Spread_Samples; i++) {
+		const uint64_t Raw = xoroshiro128p();
+		for (int Bit = 0; Bit < 64; Bit++) Buckets[Bit] += int(Raw >> Bit & 1);
+	}
+	Passed &= IsSpread("xoroshiro128p bits", Buckets, Random_Spread_Samples / 2.0);
+	return Passed;
+}
+
+static bool VerifyRandom()
+{
+	uint64_t MainFirst = 0, OtherFirst = 0;
+	bool Passed = VerifyRandomSpread(MainFirst);
+	bool OtherPassed = false;
+	std::thread Other([&]() { OtherPassed = VerifyRandomSpread(OtherFirst); });
+	Other.join();
+
+	Passed &= OtherPassed;
+	if (MainFirst == OtherFirst) {
+		std::printf("Two threads drew the same random stream\n");
+		Passed = false;
+	}
+	std::printf("Random spread check: %s\n\n", Passed ? "passed" : "FAILED");
+	return Passed;
+}
+
+int main()
+{
+	if (!VerifyToolNames()) return 1;
+	if (!VerifyRandom()) return 1;
+	if (!VerifyConversions()) return 1;
+
+	const CoordinateInBlocks At = CoordinateInBlocks(1234, -5678, 200);
+
+	Benchmark("GetAllCoordinatesInBox(3,3,3)", 20000, [&](uint64_t) {
+		auto Coordinates = GetAllCoordinatesInBox(At, CoordinateInBlocks(3, 3, 3));
+		DoNotOptimize(Coordinates.size());
+	});
+
+	Benchmark("GetAllCoordinatesInRadius(4)", 20000, [&](uint64_t) {
+		auto Coordinates = GetAllCoordinatesInRadius(At, 4);
+		DoNotOptimize(Coordinates.size());
+	});
+
+	Benchmark("GetAllCoordinatesInRadius(10)", 2000, [&](uint64_t) {
+		auto Coordinates = GetAllCoordinatesInRadius(At, 10);
+		DoNotOptimize(Coordinates.size());
+	});
+
+	Benchmark("CoordinateInBlocks(CoordinateInCentimeters)", 50000000, [&](uint64_t i) {
+		CoordinateInBlocks Blocks = CoordinateInCentimeters(int64_t(i) - 25000000, 7 - int64_t(i), uint16_t(i & 0x7FFF));
+		DoNotOptimize(Blocks);
+	});
+
+	Benchmark("  legacy double conversion", 50000000, [&](uint64_t i) {
+		CoordinateInBlocks Blocks = LegacyToBlocks(CoordinateInCentimeters(int64_t(i) - 25000000, 7 - int64_t(i), uint16_t(i & 0x7FFF)));
+		DoNotOptimize(Blocks);
+	});
+
+	std::vector<CoordinateInCentimeters> CentimeterBatch(4096);
+	std::vector<CoordinateInBlocks> BlockBatch(CentimeterBatch.size());
+	for (size_t i = 0; i < CentimeterBatch.size(); i++) {
+		CentimeterBatch[i] = CoordinateInCentimeters(int64_t(i * 977) - 2000000, 1000000 - int64_t(i * 131), uint16_t(i * 7));
+	}
+
+	Benchmark("CoordinateInBlocks, 4096 in a loop", 20000, [&](uint64_t) {
+		for (size_t i = 0; i < CentimeterBatch.size(); i++) BlockBatch[i] = CentimeterBatch[i];
+		DoNotOptimize(BlockBatch[0]);
+	});
+
+	Benchmark("  legacy double conversion, 4096 in a loop", 20000, [&](uint64_t) {
+		for (size_t i = 0; i < CentimeterBatch.size(); i++) BlockBatch[i] = LegacyToBlocks(CentimeterBatch[i]);
+		DoNotOptimize(BlockBatch[0]);
+	});
+
+	Benchmark("CoordinateInCentimeters(CoordinateInBlocks)", 50000000, [&](uint64_t i) {
+		CoordinateInCentimeters Centimeters = CoordinateInBlocks(int64_t(i), -int64_t(i), int16_t(i & 0x3FF));
+		DoNotOptimize(Centimeters);
+	});
+
+	Benchmark("round_custom", 50000000, [&](uint64_t i) {
+		int64_t Rounded = round_custom(double(int64_t(i) - 25000000) / 50);
+		DoNotOptimize(Rounded);
+	});
+
+	Benchmark("DivideRoundNearest", 50000000, [&](uint64_t i) {
+		int64_t Rounded = DivideRoundNearest<50>(int64_t(i) - 25000000);
+		DoNotOptimize(Rounded);
+	});
+
+	Benchmark("CoordinateInBlocks::GetLength", 50000000, [&](uint64_t i) {
+		double Length = CoordinateInBlocks(int64_t(i & 0xFF), int64_t(i >> 8 & 0xFF), int16_t(i >> 16 & 0xFF)).GetLength();
+		DoNotOptimize(Length);
+	});
+
+	Benchmark("CoordinateInBlocks::GetLengthSquared", 50000000, [&](uint64_t i) {
+		int64_t LengthSquared = CoordinateInBlocks(int64_t(i & 0xFF), int64_t(i >> 8 & 0xFF), int16_t(i >> 16 & 0xFF)).GetLengthSquared();
+		DoNotOptimize(LengthSquared);
+	});
+
+	Benchmark("GetRandomBool<10>", 100000000, [&](uint64_t) {
+		bool Value = GetRandomBool<10>();
+		DoNotOptimize(Value);
+	});
+
+	Benchmark("GetRandomInt<0, 5>", 100000000, [&](uint64_t) {
+		int32_t Value = GetRandomInt<0, 5>();
+		DoNotOptimize(Value);
+	});
+
+	Benchmark("GetRandomInt<-1000000, 1000000>", 100000000, [&](uint64_t) {
+		int32_t Value = GetRandomInt<-1000000, 1000000>();
+		DoNotOptimize(Value);
+	});
+
+	Benchmark("GetRandomInt(-2, 2) (runtime range)", 100000000, [&](uint64_t) {
+		int32_t Value = GetRandomInt(-2, 2);
+		DoNotOptimize(Value);
+	});
+
+	std::vector<int32_t> Values(4096);
+	Benchmark("FillRandomInts(4096 values, -2, 2)", 50000, [&](uint64_t) {
+		FillRandomInts(Values.data(), Values.size(), -2, 2);
+		DoNotOptimize(Values[0]);
+	});
+	std::printf("  (divide by %zu for ns per value)\n", Values.size());
+
+	Benchmark("Tools::Classify", 50000000, [&](uint64_t i) {
+		Tools::Tool Kind = Tools::Classify(Hit_Tool_Names[i & 7]);
+		DoNotOptimize(Kind);
+	});
+
+	Benchmark("  legacy std::wstring compare chain", 50000000, [&](uint64_t i) {
+		int Action = LegacyToolAction(Hit_Tool_Names[i & 7]);
+		DoNotOptimize(Action);
+	});
+
+	return 0;
+}
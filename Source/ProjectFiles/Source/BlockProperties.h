@@ -0,0 +1,135 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*******************************************************
+	Constexpr block classification.
+
+	Every native EBlockType has one byte of BlockProperty flags in a 256 entry table, so classifying a block is a
+	single indexed load. Mod blocks (EBlockType::ModBlock) are looked up by CustomBlockID in a small override list,
+	anything not in that list gets CustomDefault.
+
+	Example: constexpr auto Table = MakeBlockPropertyTable<1>({ { { 50000, BlockProperty::Solid } } });
+	         Table.Is(GetBlock(At), BlockProperty::Replaceable);
+	         FindNearest(At, 8, Table.Matching(BlockProperty::Solid), Found);
+*******************************************************/
+
+namespace BlockProperty {
+
+	enum Flags : uint8_t {
+		None			= 0,
+		Replaceable		= 1 << 0,	// A cloud may be placed here and the block restored afterwards
+		Solid			= 1 << 1,	// The player can stand on it
+		Foliage			= 1 << 2,	// Grass, flowers and other plants
+		Transparent		= 1 << 3,
+		Empty			= 1 << 4,	// Air
+		Cloud			= 1 << 5,	// Placed by this mod
+	};
+
+	struct CustomBlockOverride {
+		ModAPI::UniqueID CustomBlockID;
+		uint8_t Flags;
+	};
+
+	constexpr std::array<uint8_t, 256> MakeNativeTable()
+	{
+		using ModAPI::EBlockType;
+
+		std::array<uint8_t, 256> table = {};
+
+		for (size_t i = 0; i < size_t(EBlockType::MAX_BLOCKTYPE); i++) {
+			table[i] = Solid;
+		}
+
+		auto set = [&table](EBlockType Type, uint8_t Flags) { table[uint8_t(Type)] = Flags; };
+
+		set(EBlockType::Invalid, None);		// Not loaded, never stand on or replace it
+		set(EBlockType::Air, Empty | Replaceable | Transparent);
+
+		set(EBlockType::GrassFoliage, Foliage | Replaceable | Transparent);
+		set(EBlockType::Flower1, Foliage | Replaceable | Transparent);
+		set(EBlockType::Flower2, Foliage | Replaceable | Transparent);
+		set(EBlockType::Flower3, Foliage | Replaceable | Transparent);
+		set(EBlockType::Flower4, Foliage | Replaceable | Transparent);
+		set(EBlockType::FlowerRainbow, Foliage | Replaceable | Transparent);
+
+		set(EBlockType::Torch, Transparent);
+		set(EBlockType::TorchBlue, Transparent);
+		set(EBlockType::TorchGreen, Transparent);
+		set(EBlockType::TorchRed, Transparent);
+		set(EBlockType::TorchRainbow, Transparent);
+		set(EBlockType::RespawnTorch, Transparent);
+
+		set(EBlockType::GlassBlock, Solid | Transparent);
+		set(EBlockType::ModBlockTransparent, Solid | Transparent);
+
+		return table;
+	}
+
+	inline constexpr std::array<uint8_t, 256> NativeTable = MakeNativeTable();
+
+	template<size_t OverrideCount>
+	struct Table {
+		std::array<uint8_t, 256> Native;
+		std::array<CustomBlockOverride, OverrideCount> Custom;
+		uint8_t CustomDefault;
+
+		constexpr uint8_t Get(const ModAPI::BlockInfo& Block) const
+		{
+			if (Block.Type != ModAPI::EBlockType::ModBlock) return Native[uint8_t(Block.Type)];
+
+			for (const CustomBlockOverride& entry : Custom) {
+				if (entry.CustomBlockID == Block.CustomBlockID) return entry.Flags;
+			}
+			return CustomDefault;
+		}
+
+		// True if the block has any of the given flags
+		constexpr bool Is(const ModAPI::BlockInfo& Block, uint8_t AnyOf) const
+		{
+			return (Get(Block) & AnyOf) != 0;
+		}
+
+		// A predicate for FindNearest and FindAllWithin, true for blocks with any of AnyOf
+		struct Matcher {
+			const Table* Properties;
+			uint8_t AnyOf;
+
+			constexpr bool operator()(const ModAPI::BlockInfo& Block) const { return Properties->Is(Block, AnyOf); }
+		};
+
+		constexpr Matcher Matching(uint8_t AnyOf) const
+		{
+			return Matcher{ this, AnyOf };
+		}
+
+		// Classifies a whole batch of GetBlock results at once, FlagsOut needs room for Count entries
+		constexpr void Classify(const ModAPI::BlockInfo* Blocks, size_t Count, uint8_t* FlagsOut) const
+		{
+			for (size_t i = 0; i < Count; i++) {
+				FlagsOut[i] = Get(Blocks[i]);
+			}
+		}
+
+		std::vector<uint8_t> Classify(const std::vector<ModAPI::BlockInfo>& Blocks) const
+		{
+			std::vector<uint8_t> flags(Blocks.size());
+			Classify(Blocks.data(), Blocks.size(), flags.data());
+			return flags;
+		}
+	};
+
+	template<size_t OverrideCount>
+	constexpr Table<OverrideCount> MakeBlockPropertyTable(const std::array<CustomBlockOverride, OverrideCount>& Overrides, uint8_t CustomDefault = Solid)
+	{
+		return Table<OverrideCount>{ NativeTable, Overrides, CustomDefault };
+	}
+
+	static_assert(NativeTable[uint8_t(ModAPI::EBlockType::Air)] & Replaceable);
+	static_assert(NativeTable[uint8_t(ModAPI::EBlockType::Stone)] == Solid);
+	static_assert(NativeTable[uint8_t(ModAPI::EBlockType::MAX_BLOCKTYPE)] == None);
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/*******************************************************
+	Spatial index for persistent cloud bridges.
+
+	Every bridge cell is a cloud the mod placed and keeps, along with the block it replaced. Cells are grouped in
+	16x16x16 chunks in a hash map keyed by chunk coordinate. Each chunk has an occupancy bitset, which answers
+	Contains with one hash lookup and one bit test, and its cells sorted by position in the chunk. Queries only
+	visit the chunks they overlap, so their cost depends on the size of the answer, not on how much bridge exists:
+
+		Contains(At)						is At a bridge cell
+		ForEachNear(Center, Radius, F)		every cell within Radius, F(Location, Original)
+		SegmentRemoval::Step				removes the connected segment around a cell, a batch at a time
+
+	For the save, each chunk keeps its cells as runs along X (same Y, Z and original block), built again only
+	after the chunk changed. SnapshotRuns hands out shared pointers to them, so taking a snapshot for a
+	background save costs one pointer per chunk.
+
+	Doesn't call into the game.
+*******************************************************/
+
+namespace Bridges {
+
+	using ModAPI::BlockInfo;
+	using ModAPI::CoordinateInBlocks;
+
+	inline constexpr int Chunk_Bits = 4;
+	inline constexpr int Chunk_Size = 1 << Chunk_Bits;
+	inline constexpr int Chunk_Volume = Chunk_Size * Chunk_Size * Chunk_Size;
+
+	// Cells Start, Start + (1, 0, 0), ... Start + (Length - 1, 0, 0), all with the same original block
+	struct Run {
+		CoordinateInBlocks Start;
+		uint16_t Length = 0;
+		BlockInfo Original;
+	};
+
+	using RunList = std::vector<Run>;
+
+	constexpr bool IsSameBlock(const BlockInfo& A, const BlockInfo& B)
+	{
+		return A.Type == B.Type && A.Rotation == B.Rotation && A.CustomBlockID == B.CustomBlockID;
+	}
+
+	class Index
+	{
+	public:
+		bool Add(const CoordinateInBlocks& At, const BlockInfo& Original)
+		{
+			Chunk& Target = Chunks[KeyOf(At)];
+			const uint16_t Local = LocalOf(At);
+			if (Target.Occupied.test(Local)) return false;
+
+			Target.Occupied.set(Local);
+			Target.Cells.insert(Target.Find(Local), Entry{ Local, Original });
+			Target.Runs.reset();
+			Count++;
+			return true;
+		}
+
+		bool Contains(const CoordinateInBlocks& At) const
+		{
+			if (Count == 0) return false;
+			auto Found = Chunks.find(KeyOf(At));
+			return Found != Chunks.end() && Found->second.Occupied.test(LocalOf(At));
+		}
+
+		bool Remove(const CoordinateInBlocks& At, BlockInfo* OriginalOut = nullptr)
+		{
+			if (Count == 0) return false;
+			auto Found = Chunks.find(KeyOf(At));
+			if (Found == Chunks.end()) return false;
+
+			Chunk& Target = Found->second;
+			const uint16_t Local = LocalOf(At);
+			if (!Target.Occupied.test(Local)) return false;
+
+			auto Cell = Target.Find(Local);
+			if (OriginalOut) *OriginalOut = Cell->Original;
+			Target.Cells.erase(Cell);
+			Target.Occupied.reset(Local);
+			Target.Runs.reset();
+			Count--;
+
+			if (Target.Cells.empty()) Chunks.erase(Found);
+			return true;
+		}
+
+		// F(const CoordinateInBlocks& Location, const BlockInfo& Original) for every cell within Radius of Center
+		template<typename Function>
+		void ForEachNear(const CoordinateInBlocks& Center, int Radius, Function&& F) const
+		{
+			if (Count == 0) return;
+			const int64_t RadiusSquared = int64_t(Radius) * Radius;
+			const ChunkCoordinate Low = ChunkOf(Center - CoordinateInBlocks(Radius, Radius, int16_t(Radius)));
+			const ChunkCoordinate High = ChunkOf(Center + CoordinateInBlocks(Radius, Radius, int16_t(Radius)));
+
+			for (int64_t Z = Low.Z; Z <= High.Z; Z++) {
+				for (int64_t Y = Low.Y; Y <= High.Y; Y++) {
+					for (int64_t X = Low.X; X <= High.X; X++) {
+						auto Found = Chunks.find(PackKey(X, Y, Z));
+						if (Found == Chunks.end()) continue;
+
+						for (const Entry& Cell : Found->second.Cells) {
+							const CoordinateInBlocks Location = LocationOf(X, Y, Z, Cell.Local);
+							if ((Location - Center).GetLengthSquared() <= RadiusSquared) F(Location, Cell.Original);
+						}
+					}
+				}
+			}
+		}
+
+		// Runs for every chunk, chunks that haven't changed since the last call reuse their runs
+		std::vector<std::shared_ptr<const RunList>> SnapshotRuns()
+		{
+			std::vector<std::shared_ptr<const RunList>> Snapshot;
+			Snapshot.reserve(Chunks.size());
+			for (auto& [Key, Target] : Chunks) {
+				if (!Target.Runs) Target.Runs = std::make_shared<const RunList>(EncodeRuns(Key, Target));
+				Snapshot.push_back(Target.Runs);
+			}
+			return Snapshot;
+		}
+
+		void Clear()
+		{
+			Chunks.clear();
+			Count = 0;
+		}
+
+		size_t Size() const { return Count; }
+		size_t ChunkCount() const { return Chunks.size(); }
+
+	private:
+		struct Entry {
+			uint16_t Local;			// (z << 8) | (y << 4) | x inside the chunk
+			BlockInfo Original;
+		};
+
+		struct Chunk {
+			std::bitset<Chunk_Volume> Occupied;
+			std::vector<Entry> Cells;				// Sorted by Local
+			std::shared_ptr<const RunList> Runs;	// Empty after a change
+
+			std::vector<Entry>::iterator Find(uint16_t Local)
+			{
+				return std::lower_bound(Cells.begin(), Cells.end(), Local, [](const Entry& Cell, uint16_t Value) { return Cell.Local < Value; });
+			}
+		};
+
+		struct ChunkCoordinate {
+			int64_t X, Y, Z;
+		};
+
+		std::unordered_map<uint64_t, Chunk> Chunks;
+		size_t Count = 0;
+
+		// 26 bits per horizontal chunk coordinate is +-2^29 blocks, 12 bits covers every Z
+		static uint64_t PackKey(int64_t X, int64_t Y, int64_t Z)
+		{
+			return (uint64_t(X) & 0x3FFFFFF) | ((uint64_t(Y) & 0x3FFFFFF) << 26) | ((uint64_t(Z) & 0xFFF) << 52);
+		}
+
+		static ChunkCoordinate UnpackKey(uint64_t Key)
+		{
+			auto SignExtend = [](uint64_t Value, int Bits) { return int64_t(Value << (64 - Bits)) >> (64 - Bits); };
+			return ChunkCoordinate{ SignExtend(Key & 0x3FFFFFF, 26), SignExtend(Key >> 26 & 0x3FFFFFF, 26), SignExtend(Key >> 52, 12) };
+		}
+
+		static ChunkCoordinate ChunkOf(const CoordinateInBlocks& At)
+		{
+			return ChunkCoordinate{ At.X >> Chunk_Bits, At.Y >> Chunk_Bits, int64_t(At.Z) >> Chunk_Bits };
+		}
+
+		static uint64_t KeyOf(const CoordinateInBlocks& At)
+		{
+			const ChunkCoordinate Coordinate = ChunkOf(At);
+			return PackKey(Coordinate.X, Coordinate.Y, Coordinate.Z);
+		}
+
+		static uint16_t LocalOf(const CoordinateInBlocks& At)
+		{
+			const int Mask = Chunk_Size - 1;
+			return uint16_t((int(At.Z) & Mask) << (2 * Chunk_Bits) | (int(At.Y & Mask) << Chunk_Bits) | int(At.X & Mask));
+		}
+
+		static CoordinateInBlocks LocationOf(int64_t X, int64_t Y, int64_t Z, uint16_t Local)
+		{
+			const int Mask = Chunk_Size - 1;
+			return CoordinateInBlocks((X << Chunk_Bits) + (Local & Mask), (Y << Chunk_Bits) + (Local >> Chunk_Bits & Mask),
+				int16_t((Z << Chunk_Bits) + (Local >> (2 * Chunk_Bits))));
+		}
+
+		static RunList EncodeRuns(uint64_t Key, const Chunk& Source)
+		{
+			const ChunkCoordinate Coordinate = UnpackKey(Key);
+			RunList Runs;
+			for (const Entry& Cell : Source.Cells) {
+				if (!Runs.empty()) {
+					Run& Last = Runs.back();
+					const uint16_t LastLocal = LocalOf(Last.Start) + Last.Length - 1;
+					// Cells are sorted, so the next cell in X on the same row is LastLocal + 1
+					if (Cell.Local == LastLocal + 1 && (Cell.Local & (Chunk_Size - 1)) != 0 && IsSameBlock(Cell.Original, Last.Original)) {
+						Last.Length++;
+						continue;
+					}
+				}
+				Runs.push_back(Run{ LocationOf(Coordinate.X, Coordinate.Y, Coordinate.Z, Cell.Local), 1, Cell.Original });
+			}
+			return Runs;
+		}
+	};
+
+	// Removes the bridge segment connected (26 neighbours) to a starting cell, a batch of cells per Step so a long
+	// bridge can be taken down over several ticks. Cells added to the index meanwhile join the segment if they touch it.
+	class SegmentRemoval
+	{
+	public:
+		// Nothing happens if Start isn't a bridge cell
+		SegmentRemoval(Index& Bridges, const CoordinateInBlocks& Start)
+		{
+			BlockInfo Original;
+			if (Bridges.Remove(Start, &Original)) Removed(Start, Original);
+		}
+
+		// F(const CoordinateInBlocks& Location, const BlockInfo& Original) for every cell taken out of the index.
+		// Returns true once the whole segment is gone.
+		template<typename Function>
+		bool Step(Index& Bridges, size_t MaxCells, Function&& F)
+		{
+			for (size_t Done = 0; Done < MaxCells && !Pending.empty(); Done++) {
+				const auto [Location, Original] = Pending.front();
+				Pending.pop_front();
+				F(Location, Original);
+
+				for (int Z = -1; Z <= 1; Z++) {
+					for (int Y = -1; Y <= 1; Y++) {
+						for (int X = -1; X <= 1; X++) {
+							const CoordinateInBlocks Neighbour = Location + CoordinateInBlocks(X, Y, int16_t(Z));
+							BlockInfo NeighbourOriginal;
+							if (Bridges.Remove(Neighbour, &NeighbourOriginal)) Removed(Neighbour, NeighbourOriginal);
+						}
+					}
+				}
+			}
+			return Pending.empty();
+		}
+
+		size_t GetRemovedCount() const { return RemovedCount; }
+
+	private:
+		std::deque<std::pair<CoordinateInBlocks, BlockInfo>> Pending;
+		size_t RemovedCount = 0;
+
+		void Removed(const CoordinateInBlocks& Location, const BlockInfo& Original)
+		{
+			Pending.emplace_back(Location, Original);
+			RemovedCount++;
+		}
+	};
+}
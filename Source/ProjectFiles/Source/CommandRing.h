@@ -0,0 +1,219 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cwchar>
+#include <thread>
+
+/*******************************************************
+	Command ring other mods use to ask Cloud Walker for temporary cloud floors.
+
+	Cloud Walker owns one Ring and publishes its address under Shared_Memory_Key with GetSharedMemoryPointer. A
+	client mod takes the shared memory handle once, copies the pointer, checks IsCompatible and claims a client
+	slot with Register. From then on it never needs the handle or a lock again:
+
+		Ring* Commands = (Ring*) Handle.Pointer;
+		int Client = Commands->Register(L"Scaffolder");
+		Commands->TryPush(Client, CommandRing::PlaceFootprint(X, Y, Z, 3, Tag, 200));
+		Commands->TryPush(Client, CommandRing::Release(Tag));
+
+	The ring is a bounded multi-producer, single-consumer queue (Vyukov's, one sequence number per slot): producers
+	claim a slot with one compare-and-swap on Head, Cloud Walker drains from Tail on the tick thread, as many
+	commands a tick as fit in its edit budget. Nothing ever blocks. When the ring is full, or a client already has
+	Max_Pending_Per_Client commands waiting, TryPush returns Full or Throttled and the command is not queued; the
+	client retries on a later tick. The per-client cap keeps one busy client from filling the ring for everyone.
+
+	Every client slot counts what happened to its commands, Cloud Walker logs them on exit.
+
+	Only plain integers and lock-free atomics, so the layout is the same for every mod built with the same compiler.
+	Header only, doesn't call into the game.
+*******************************************************/
+
+namespace CommandRing {
+
+	inline constexpr uint32_t Magic = 0x52435743;	// "CWCR"
+	inline constexpr uint32_t Version = 1;
+	inline constexpr uint32_t Capacity = 256;		// a power of two
+	inline constexpr uint32_t Max_Clients = 16;
+	inline constexpr uint32_t Max_Pending_Per_Client = Capacity / 4;
+	inline constexpr size_t Client_Name_Length = 32;
+	inline constexpr const wchar_t* Shared_Memory_Key = L"CloudWalker.CommandRing";
+
+	static_assert((Capacity & (Capacity - 1)) == 0);
+	static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free);
+
+	enum class Kind : uint32_t {
+		None = 0,
+		PlaceFootprint = 1,		// A disc of clouds, Radius around X, Y at height Z, for Ticks ticks
+		Release = 2				// Takes the floor placed with the same Tag down before it expires
+	};
+
+	// Tag is the client's own name for a floor. Placing again with a Tag that is still up moves that floor.
+	struct Command {
+		Kind Type = Kind::None;
+		uint16_t Client = 0;		// Set by TryPush
+		uint16_t Radius = 0;
+		uint32_t Tag = 0;
+		uint32_t Ticks = 0;
+		int64_t X = 0;
+		int64_t Y = 0;
+		int32_t Z = 0;
+	};
+
+	inline Command PlaceFootprint(int64_t X, int64_t Y, int32_t Z, uint16_t Radius, uint32_t Tag, uint32_t Ticks)
+	{
+		Command Place;
+		Place.Type = Kind::PlaceFootprint;
+		Place.Radius = Radius;
+		Place.Tag = Tag;
+		Place.Ticks = Ticks;
+		Place.X = X;
+		Place.Y = Y;
+		Place.Z = Z;
+		return Place;
+	}
+
+	inline Command Release(uint32_t Tag)
+	{
+		Command Drop;
+		Drop.Type = Kind::Release;
+		Drop.Tag = Tag;
+		return Drop;
+	}
+
+	enum class PushResult {
+		Queued,
+		Full,			// No free slot in the ring
+		Throttled,		// This client already has Max_Pending_Per_Client commands waiting
+		BadClient
+	};
+
+	// What a client slot's InUse holds. Slots are never given back, a client that comes back registers under its old name.
+	enum ClientState : uint32_t {
+		Client_Free = 0,
+		Client_Claiming = 1,		// Won by a Register that is still writing the name
+		Client_Registered = 2
+	};
+
+	struct ClientStats {
+		std::atomic<uint32_t> InUse{ Client_Free };
+		std::atomic<uint32_t> Pending{ 0 };		// Queued and not drained yet
+		std::atomic<uint64_t> Queued{ 0 };
+		std::atomic<uint64_t> Full{ 0 };
+		std::atomic<uint64_t> Throttled{ 0 };
+		std::atomic<uint64_t> Placed{ 0 };		// Floors put up
+		std::atomic<uint64_t> Released{ 0 };
+		std::atomic<uint64_t> Expired{ 0 };
+		std::atomic<uint64_t> Refused{ 0 };		// Commands Cloud Walker couldn't carry out, out of range or unknown Tag
+		std::atomic<uint64_t> Cells{ 0 };		// Clouds placed for this client's floors
+		wchar_t Name[Client_Name_Length] = {};
+	};
+
+	struct Ring {
+		const uint32_t RingMagic = Magic;
+		const uint32_t RingVersion = Version;
+		const uint32_t RingCapacity = Capacity;
+
+		alignas(64) std::atomic<uint32_t> Head{ 0 };	// Next slot a producer claims
+		alignas(64) std::atomic<uint32_t> Tail{ 0 };	// Next slot the consumer reads, only Cloud Walker writes it
+
+		ClientStats Clients[Max_Clients];
+
+		struct Slot {
+			std::atomic<uint32_t> Sequence{ 0 };
+			Command Payload;
+		};
+		alignas(64) Slot Slots[Capacity];
+
+		Ring()
+		{
+			for (uint32_t i = 0; i < Capacity; i++) Slots[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+
+		Ring(const Ring&) = delete;
+		Ring& operator=(const Ring&) = delete;
+
+		bool IsCompatible() const { return RingMagic == Magic && RingVersion == Version && RingCapacity == Capacity; }
+
+		// Claims a client slot, -1 if all Max_Clients are taken. A client that registers again under the same name gets its old slot back.
+		// Slots fill in order and are never freed, so two Registers under one name meet at the same free slot: the one whose
+		// compare-and-swap on the slot state loses waits for the winner's name and takes the slot only if it is its own.
+		int Register(const wchar_t* Name)
+		{
+			for (uint32_t i = 0; i < Max_Clients; i++) {
+				uint32_t State = Clients[i].InUse.load(std::memory_order_acquire);
+				if (State == Client_Free) {
+					if (Clients[i].InUse.compare_exchange_strong(State, Client_Claiming, std::memory_order_acq_rel)) {
+						std::wcsncpy(Clients[i].Name, Name, Client_Name_Length - 1);
+						Clients[i].InUse.store(Client_Registered, std::memory_order_release);
+						return int(i);
+					}
+				}
+				while (State == Client_Claiming) {
+					std::this_thread::yield();
+					State = Clients[i].InUse.load(std::memory_order_acquire);
+				}
+				if (std::wcsncmp(Clients[i].Name, Name, Client_Name_Length - 1) == 0) return int(i);
+			}
+			return -1;
+		}
+
+		// Any thread of any mod
+		PushResult TryPush(int Client, Command Request)
+		{
+			if (Client < 0 || uint32_t(Client) >= Max_Clients || Clients[Client].InUse.load(std::memory_order_acquire) != Client_Registered) return PushResult::BadClient;
+			ClientStats& Stats = Clients[Client];
+
+			if (Stats.Pending.fetch_add(1, std::memory_order_acq_rel) >= Max_Pending_Per_Client) {
+				Stats.Pending.fetch_sub(1, std::memory_order_acq_rel);
+				Stats.Throttled.fetch_add(1, std::memory_order_relaxed);
+				return PushResult::Throttled;
+			}
+
+			uint32_t Position = Head.load(std::memory_order_relaxed);
+			Slot* Target;
+			for (;;) {
+				Target = &Slots[Position & (Capacity - 1)];
+				const int32_t Lag = int32_t(Target->Sequence.load(std::memory_order_acquire) - Position);
+				if (Lag == 0) {
+					if (Head.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) break;
+				}
+				else if (Lag < 0) {
+					Stats.Pending.fetch_sub(1, std::memory_order_acq_rel);
+					Stats.Full.fetch_add(1, std::memory_order_relaxed);
+					return PushResult::Full;
+				}
+				else {
+					Position = Head.load(std::memory_order_relaxed);
+				}
+			}
+
+			Request.Client = uint16_t(Client);
+			Target->Payload = Request;
+			Target->Sequence.store(Position + 1, std::memory_order_release);
+			Stats.Queued.fetch_add(1, std::memory_order_relaxed);
+			return PushResult::Queued;
+		}
+
+		// Cloud Walker's tick thread only. The next command without taking it, nullptr if the ring is empty.
+		const Command* Peek() const
+		{
+			const uint32_t Position = Tail.load(std::memory_order_relaxed);
+			const Slot& Next = Slots[Position & (Capacity - 1)];
+			return Next.Sequence.load(std::memory_order_acquire) == Position + 1 ? &Next.Payload : nullptr;
+		}
+
+		// Cloud Walker's tick thread only, after Peek returned a command
+		void Pop()
+		{
+			const uint32_t Position = Tail.load(std::memory_order_relaxed);
+			Slot& Next = Slots[Position & (Capacity - 1)];
+			const uint16_t Client = Next.Payload.Client;
+			Next.Sequence.store(Position + Capacity, std::memory_order_release);
+			Tail.store(Position + 1, std::memory_order_relaxed);
+			if (Client < Max_Clients) Clients[Client].Pending.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		uint32_t Size() const { return Head.load(std::memory_order_relaxed) - Tail.load(std::memory_order_relaxed); }
+	};
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*******************************************************
+	Long operations as C++20 coroutines.
+
+	An Operation is a coroutine that does a big job (removing a platform, purging clouds, scanning for ground)
+	a little at a time. Runner::Start queues it, and Runner::Resume, called from Event_Tick, resumes the running
+	operations until the tick's microsecond budget is used up. Inside an operation:
+
+		co_await Owner.Checkpoint();	carries on straight away while the tick has budget left, otherwise continues next tick
+		co_await Owner.NextTick();		always continues next tick
+		co_await OtherOperation();		runs another Operation to completion first
+
+	Checkpoint and NextTick are the only places an operation may suspend. Cancel(Group) destroys every operation
+	in that group at its current checkpoint, so locals are cleaned up normally. For the same reason an operation
+	must not hold a scope that has to end within the tick (OwnWriteScope, PROFILE_SUBSYSTEM) across a co_await.
+
+	Tick thread only.
+*******************************************************/
+
+namespace Coroutines {
+
+	using Clock = std::chrono::steady_clock;
+
+	class Runner;
+
+	class Operation
+	{
+	public:
+		struct promise_type {
+			std::coroutine_handle<> Continuation;
+			std::exception_ptr Exception;
+
+			Operation get_return_object() { return Operation(std::coroutine_handle<promise_type>::from_promise(*this)); }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+
+			auto final_suspend() noexcept
+			{
+				struct FinalAwaiter {
+					bool await_ready() noexcept { return false; }
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> Finished) noexcept
+					{
+						std::coroutine_handle<> Continuation = Finished.promise().Continuation;
+						return Continuation ? Continuation : std::noop_coroutine();
+					}
+					void await_resume() noexcept {}
+				};
+				return FinalAwaiter{};
+			}
+
+			void return_void() {}
+			void unhandled_exception() { Exception = std::current_exception(); }
+		};
+
+		Operation(Operation&& Other) noexcept : Handle(std::exchange(Other.Handle, {})) {}
+
+		Operation& operator=(Operation&& Other) noexcept
+		{
+			if (this != &Other) {
+				if (Handle) Handle.destroy();
+				Handle = std::exchange(Other.Handle, {});
+			}
+			return *this;
+		}
+
+		Operation(const Operation&) = delete;
+		Operation& operator=(const Operation&) = delete;
+
+		~Operation()
+		{
+			if (Handle) Handle.destroy();
+		}
+
+		// Awaiting an Operation from another one runs it right away, inside the awaiting operation
+		bool await_ready() const noexcept { return false; }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> Awaiting) noexcept
+		{
+			Handle.promise().Continuation = Awaiting;
+			return Handle;
+		}
+
+		void await_resume()
+		{
+			if (Handle.promise().Exception) std::rethrow_exception(Handle.promise().Exception);
+		}
+
+	private:
+		friend class Runner;
+
+		explicit Operation(std::coroutine_handle<promise_type> Handle_) : Handle(Handle_) {}
+
+		std::coroutine_handle<promise_type> Handle;
+	};
+
+	struct OperationStats {
+		const wchar_t* Name = L"";
+		uint32_t Group = 0;
+		uint64_t Ticks = 0;					// Ticks it was resumed on
+		int64_t TotalMicroseconds = 0;
+		int64_t MaxMicroseconds = 0;		// In a single tick
+		bool Cancelled = false;
+		bool Failed = false;				// Threw, or suspended somewhere other than Checkpoint/NextTick
+	};
+
+	class Runner
+	{
+	public:
+		// Called on the tick thread for every operation that finished, failed or was cancelled
+		std::function<void(const OperationStats&)> OnFinished;
+
+		void Start(const wchar_t* Name, uint32_t Group, Operation&& NewOperation)
+		{
+			Slot NewSlot(std::move(NewOperation));
+			NewSlot.ResumePoint = NewSlot.Root.Handle;
+			NewSlot.Stats.Name = Name;
+			NewSlot.Stats.Group = Group;
+			Slots.push_back(std::move(NewSlot));
+		}
+
+		// Returns how many operations were cancelled
+		size_t Cancel(uint32_t Group)
+		{
+			size_t Cancelled = 0;
+			for (Slot& Current : Slots) {
+				if (Current.Stats.Group != Group || Current.Done) continue;
+				Current.Done = true;
+				Current.Stats.Cancelled = true;
+				Cancelled++;
+			}
+			if (CurrentIndex == No_Slot) Sweep();
+			return Cancelled;
+		}
+
+		bool IsRunning(uint32_t Group) const
+		{
+			for (const Slot& Current : Slots) {
+				if (Current.Stats.Group == Group && !Current.Done) return true;
+			}
+			return false;
+		}
+
+		bool IsEmpty() const { return Slots.empty(); }
+
+		// Resumes operations, round robin, until BudgetMicroseconds are used up. At least one gets to run every tick.
+		void Resume(int64_t BudgetMicroseconds)
+		{
+			const Clock::time_point Start = Clock::now();
+			Deadline = Start + std::chrono::microseconds(BudgetMicroseconds);
+
+			// Operations started from inside an operation wait for the next tick
+			const size_t Count = Slots.size();
+			for (size_t n = 0; n < Count; n++) {
+				if (n > 0 && Clock::now() >= Deadline) break;
+
+				const size_t Index = (FirstIndex + n) % Count;
+				if (Slots[Index].Done) continue;
+
+				CurrentIndex = Index;
+				const Clock::time_point ResumeStart = Clock::now();
+
+				std::coroutine_handle<> ResumePoint = std::exchange(Slots[Index].ResumePoint, {});
+				ResumePoint.resume();
+
+				Slot& Resumed = Slots[Index];
+				const int64_t Took = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - ResumeStart).count();
+				Resumed.Stats.Ticks++;
+				Resumed.Stats.TotalMicroseconds += Took;
+				if (Took > Resumed.Stats.MaxMicroseconds) Resumed.Stats.MaxMicroseconds = Took;
+
+				if (Resumed.Root.Handle.done()) {
+					Resumed.Done = true;
+					Resumed.Stats.Failed = Resumed.Root.Handle.promise().Exception != nullptr;
+				}
+				else if (!Resumed.ResumePoint && !Resumed.Done) {
+					Resumed.Done = true;
+					Resumed.Stats.Failed = true;
+				}
+			}
+			CurrentIndex = No_Slot;
+			FirstIndex = Count > 0 ? FirstIndex + 1 : 0;
+
+			Sweep();
+		}
+
+		struct CheckpointAwaiter {
+			Runner& Owner;
+			bool AlwaysSuspend;
+
+			bool await_ready() const { return !AlwaysSuspend && Clock::now() < Owner.Deadline; }
+			void await_suspend(std::coroutine_handle<> Suspended) { Owner.Slots[Owner.CurrentIndex].ResumePoint = Suspended; }
+			void await_resume() const {}
+		};
+
+		CheckpointAwaiter Checkpoint() { return CheckpointAwaiter{ *this, false }; }
+		CheckpointAwaiter NextTick() { return CheckpointAwaiter{ *this, true }; }
+
+	private:
+		static constexpr size_t No_Slot = SIZE_MAX;
+
+		struct Slot {
+			Operation Root;
+			std::coroutine_handle<> ResumePoint;
+			OperationStats Stats;
+			bool Done = false;
+
+			explicit Slot(Operation&& Root_) : Root(std::move(Root_)) {}
+		};
+
+		std::vector<Slot> Slots;
+		Clock::time_point Deadline;
+		size_t CurrentIndex = No_Slot;
+		size_t FirstIndex = 0;
+
+		void Sweep()
+		{
+			for (size_t i = 0; i < Slots.size();) {
+				if (!Slots[i].Done) {
+					i++;
+					continue;
+				}
+
+				OperationStats Stats = Slots[i].Stats;
+				Slots.erase(Slots.begin() + i);
+				if (OnFinished) OnFinished(Stats);
+			}
+		}
+	};
+}
@@ -0,0 +1,350 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*******************************************************
+	Flight recorder: the last Tick_Capacity ticks of what the mod saw and did, kept all the time and written out
+	when something goes wrong.
+
+	Every tick gets a TickRecord: the player's feet and the block under them as the fall guard read them, the hands
+	and head as the gestures task sampled them (from the feet), the platform settings at the end of the tick, how
+	long the tick and any save took, and how many cells were placed and restored. Every platform write gets an
+	EditRecord. Both are rings of plain structs overwritten in place, so recording is a few stores per tick without
+	allocating, and nothing is read from the game that the tasks didn't read anyway.
+
+	Flag marks an anomaly on the current tick and asks for a dump, at most one per kind of anomaly every
+	DumpCooldownTicks. After EndTick, TakeDump copies the rings into a Dump, oldest first, and Encode makes the
+	file bytes. Neither calls into the game, so the encoding and the write can go to a job worker:
+
+		flightRecorder.BeginTick(Tick);
+		flightRecorder.RecordPlayer(Feet, UnderFoot);				as the tasks read things
+		flightRecorder.RecordEdit(FlightRecorder::EditKind::Placed, At, Replaced);
+		flightRecorder.Flag(FlightRecorder::Anomaly::SinkRescue);
+		flightRecorder.EndTick(Microseconds, HostCalls);
+		if (flightRecorder.TakeDump(Output)) Bytes = FlightRecorder::Encode(Output);
+
+	Benchmarks/FlightReplay.cpp reads a dump back with Decode and replays it through the mod on a headless host.
+	Little endian only, like everything the game runs on.
+*******************************************************/
+
+namespace FlightRecorder {
+
+	using ModAPI::BlockInfo;
+	using ModAPI::CoordinateInBlocks;
+	using ModAPI::CoordinateInCentimeters;
+
+	inline constexpr uint32_t File_Magic = 0x52465743;		// "CWFR"
+	inline constexpr uint32_t File_Version = 1;
+	inline constexpr uint64_t Tick_Capacity = 512;			// 12.8 seconds at 40 ticks a second
+	inline constexpr uint64_t Edit_Capacity = 8192;
+
+	enum class Anomaly : uint8_t {
+		SinkRescue,			// The fall guard had to put the player back on the platform
+		TickOverBudget,		// Event_Tick took longer than the tick budget
+		SetBlockFailed,		// The game refused a platform write
+		Count
+	};
+
+	inline constexpr const wchar_t* Anomaly_Names[size_t(Anomaly::Count)] = { L"SinkRescue", L"TickOverBudget", L"SetBlockFailed" };
+
+	enum class EditKind : uint8_t {
+		Placed,			// A cloud went in, Block is what it replaced
+		Restored,		// Block was put back
+		Failed			// The game refused to write Block
+	};
+
+	enum Flag : uint16_t {
+		CloudWalking = 1 << 0,
+		SinglePlane = 1 << 1,
+		PlayerRead = 1 << 2,		// The fall guard ran, Player and UnderFoot are set
+		HandsRead = 1 << 3,			// The gestures task sampled the hands, Head and the hands are set
+		GestureEngaged = 1 << 4,
+		Descending = 1 << 5,
+		Autopilot = 1 << 6,
+		Rescued = 1 << 7,			// The fall guard moved the player, with or without an anomaly
+		Caught = 1 << 8,			// CatchSinkingPlayer put cells in under the player
+		Bridging = 1 << 9			// Cells the platform leaves go to the bridge index instead of being restored
+	};
+
+	struct TickRecord {
+		uint64_t Tick = 0;
+		uint64_t FirstEdit = 0;					// Edits made from here on belong to this tick
+		int64_t PlayerX = 0;					// Feet, in cm
+		int64_t PlayerY = 0;
+		int32_t PlayerZ = 0;
+		int32_t TickMicroseconds = 0;
+		int32_t Head[3] = {};					// cm from the feet
+		int32_t LeftHand[3] = {};
+		int32_t RightHand[3] = {};
+		int32_t SaveSnapshotMicroseconds = 0;	// SaveData on the tick thread
+		int32_t SaveWriteMicroseconds = 0;		// A save job that finished on this tick
+		uint32_t HostCalls = 0;					// 0 unless built with CLOUDWALKER_COUNT_HOST_CALLS
+		uint32_t UnderFootCustomBlockID = 0;
+		int16_t PlatformHeight = 0;
+		uint16_t Placed = 0;
+		uint16_t Restored = 0;
+		uint16_t FailedWrites = 0;
+		uint16_t Flags = 0;
+		uint8_t UnderFootType = 0;
+		uint8_t PlatformRadius = 0;
+		uint8_t PlatformShape = 0;
+		int8_t ClimbBlocks = 0;
+		uint8_t Anomalies = 0;					// Bit per Anomaly
+		uint8_t Padding = 0;
+
+		bool Has(Flag Which) const { return (Flags & Which) != 0; }
+		CoordinateInCentimeters Player() const { return CoordinateInCentimeters(PlayerX, PlayerY, uint16_t(PlayerZ)); }
+		BlockInfo UnderFoot() const { return BlockInfo(ModAPI::EBlockType(UnderFootType), ModAPI::ERotation::None, UnderFootCustomBlockID); }
+	};
+
+	struct EditRecord {
+		uint64_t Tick = 0;
+		int64_t X = 0;
+		int64_t Y = 0;
+		int16_t Z = 0;
+		uint8_t Kind = 0;
+		uint8_t BlockType = 0;
+		uint32_t CustomBlockID = 0;
+
+		CoordinateInBlocks At() const { return CoordinateInBlocks(X, Y, Z); }
+		BlockInfo Block() const { return BlockInfo(ModAPI::EBlockType(BlockType), ModAPI::ERotation::None, CustomBlockID); }
+	};
+
+	// A platform cloud when the dump was taken, Block is what it replaced
+	struct CellRecord {
+		int64_t X = 0;
+		int64_t Y = 0;
+		int16_t Z = 0;
+		uint8_t BlockType = 0;
+		uint8_t Padding = 0;
+		uint32_t CustomBlockID = 0;
+
+		CoordinateInBlocks At() const { return CoordinateInBlocks(X, Y, Z); }
+		BlockInfo Block() const { return BlockInfo(ModAPI::EBlockType(BlockType), ModAPI::ERotation::None, CustomBlockID); }
+	};
+
+	static_assert(sizeof(TickRecord) % 8 == 0 && sizeof(EditRecord) % 8 == 0 && sizeof(CellRecord) % 8 == 0);
+
+	inline CellRecord MakeCell(const CoordinateInBlocks& At, const BlockInfo& Block)
+	{
+		CellRecord Cell;
+		Cell.X = At.X;
+		Cell.Y = At.Y;
+		Cell.Z = At.Z;
+		Cell.BlockType = uint8_t(Block.Type);
+		Cell.CustomBlockID = Block.CustomBlockID;
+		return Cell;
+	}
+
+	struct FileHeader {
+		uint32_t Magic = File_Magic;
+		uint32_t Version = File_Version;
+		uint32_t TickRecordSize = sizeof(TickRecord);
+		uint32_t EditRecordSize = sizeof(EditRecord);
+		uint32_t CellRecordSize = sizeof(CellRecord);
+		uint32_t Reason = 0;					// The Anomaly that asked for the dump
+		uint64_t ReasonTick = 0;
+		uint32_t TickCount = 0;
+		uint32_t EditCount = 0;
+		uint32_t CellCount = 0;
+		uint32_t Padding = 0;
+	};
+
+	struct Dump {
+		FileHeader Header;
+		std::vector<TickRecord> Ticks;			// Oldest first
+		std::vector<EditRecord> Edits;
+		std::vector<CellRecord> Platform;		// Filled in by the caller
+	};
+
+	inline std::vector<uint8_t> Encode(const Dump& Input)
+	{
+		FileHeader Header = Input.Header;
+		Header.TickCount = uint32_t(Input.Ticks.size());
+		Header.EditCount = uint32_t(Input.Edits.size());
+		Header.CellCount = uint32_t(Input.Platform.size());
+
+		const size_t TickBytes = Input.Ticks.size() * sizeof(TickRecord);
+		const size_t EditBytes = Input.Edits.size() * sizeof(EditRecord);
+		const size_t CellBytes = Input.Platform.size() * sizeof(CellRecord);
+		std::vector<uint8_t> Bytes(sizeof(FileHeader) + TickBytes + EditBytes + CellBytes);
+
+		uint8_t* Out = Bytes.data();
+		std::memcpy(Out, &Header, sizeof(FileHeader));
+		Out += sizeof(FileHeader);
+		if (TickBytes > 0) std::memcpy(Out, Input.Ticks.data(), TickBytes);
+		Out += TickBytes;
+		if (EditBytes > 0) std::memcpy(Out, Input.Edits.data(), EditBytes);
+		Out += EditBytes;
+		if (CellBytes > 0) std::memcpy(Out, Input.Platform.data(), CellBytes);
+		return Bytes;
+	}
+
+	// False if Data isn't a whole dump of this version
+	inline bool Decode(const uint8_t* Data, size_t Size, Dump& Output)
+	{
+		if (Size < sizeof(FileHeader)) return false;
+		std::memcpy(&Output.Header, Data, sizeof(FileHeader));
+		const FileHeader& Header = Output.Header;
+		if (Header.Magic != File_Magic || Header.Version != File_Version || Header.TickRecordSize != sizeof(TickRecord)
+			|| Header.EditRecordSize != sizeof(EditRecord) || Header.CellRecordSize != sizeof(CellRecord)) return false;
+
+		const size_t TickBytes = size_t(Header.TickCount) * sizeof(TickRecord);
+		const size_t EditBytes = size_t(Header.EditCount) * sizeof(EditRecord);
+		const size_t CellBytes = size_t(Header.CellCount) * sizeof(CellRecord);
+		if (Size != sizeof(FileHeader) + TickBytes + EditBytes + CellBytes) return false;
+
+		const uint8_t* In = Data + sizeof(FileHeader);
+		Output.Ticks.resize(Header.TickCount);
+		if (TickBytes > 0) std::memcpy(Output.Ticks.data(), In, TickBytes);
+		In += TickBytes;
+		Output.Edits.resize(Header.EditCount);
+		if (EditBytes > 0) std::memcpy(Output.Edits.data(), In, EditBytes);
+		In += EditBytes;
+		Output.Platform.resize(Header.CellCount);
+		if (CellBytes > 0) std::memcpy(Output.Platform.data(), In, CellBytes);
+		return true;
+	}
+
+	// Tick thread only
+	class Recorder
+	{
+	public:
+		explicit Recorder(uint64_t DumpCooldownTicks_) : DumpCooldownTicks(DumpCooldownTicks_) {}
+
+		Recorder(const Recorder&) = delete;
+		Recorder& operator=(const Recorder&) = delete;
+
+		void BeginTick(uint64_t Tick)
+		{
+			TickRecord& Record = Now();
+			Record = TickRecord();
+			Record.Tick = Tick;
+			Record.FirstEdit = EditCount;
+		}
+
+		// The tick being recorded
+		TickRecord& Now() { return Ticks[TickCount % Tick_Capacity]; }
+
+		void RecordPlayer(const CoordinateInCentimeters& Feet, const BlockInfo& UnderFoot)
+		{
+			TickRecord& Record = Now();
+			Record.PlayerX = Feet.X;
+			Record.PlayerY = Feet.Y;
+			Record.PlayerZ = Feet.Z;
+			Record.UnderFootType = uint8_t(UnderFoot.Type);
+			Record.UnderFootCustomBlockID = UnderFoot.CustomBlockID;
+			Record.Flags |= PlayerRead;
+		}
+
+		// From the feet RecordPlayer got this tick
+		void RecordHands(const CoordinateInCentimeters& Left, const CoordinateInCentimeters& Right, const CoordinateInCentimeters& Head)
+		{
+			TickRecord& Record = Now();
+			auto Offset = [&Record](const CoordinateInCentimeters& From, int32_t (&To)[3]) {
+				To[0] = int32_t(From.X - Record.PlayerX);
+				To[1] = int32_t(From.Y - Record.PlayerY);
+				To[2] = int32_t(From.Z) - Record.PlayerZ;
+			};
+			Offset(Left, Record.LeftHand);
+			Offset(Right, Record.RightHand);
+			Offset(Head, Record.Head);
+			Record.Flags |= HandsRead;
+		}
+
+		void RecordEdit(EditKind Kind, const CoordinateInBlocks& At, const BlockInfo& Block)
+		{
+			TickRecord& Record = Now();
+			EditRecord& Edit = Edits[EditCount++ % Edit_Capacity];
+			Edit.Tick = Record.Tick;
+			Edit.X = At.X;
+			Edit.Y = At.Y;
+			Edit.Z = At.Z;
+			Edit.Kind = uint8_t(Kind);
+			Edit.BlockType = uint8_t(Block.Type);
+			Edit.CustomBlockID = Block.CustomBlockID;
+
+			uint16_t& Count = Kind == EditKind::Placed ? Record.Placed : (Kind == EditKind::Restored ? Record.Restored : Record.FailedWrites);
+			if (Count < UINT16_MAX) Count++;
+		}
+
+		void Flag(Anomaly Kind)
+		{
+			TickRecord& Record = Now();
+			Record.Anomalies |= uint8_t(1 << uint8_t(Kind));
+
+			const size_t Index = size_t(Kind);
+			if (Dumped[Index] && TickCount - LastDumpTick[Index] < DumpCooldownTicks) return;
+			if (PendingDump == Anomaly::Count) {
+				PendingDump = Kind;
+				PendingTick = Record.Tick;
+			}
+			Dumped[Index] = true;
+			LastDumpTick[Index] = TickCount;
+		}
+
+		void EndTick(int64_t Microseconds, uint64_t HostCalls)
+		{
+			TickRecord& Record = Now();
+			Record.TickMicroseconds = int32_t(std::min<int64_t>(Microseconds, INT32_MAX));
+			Record.HostCalls = uint32_t(std::min<uint64_t>(HostCalls, UINT32_MAX));
+			TickCount++;
+		}
+
+		bool IsDumpPending() const { return PendingDump != Anomaly::Count; }
+
+		// The dump Flag asked for, if there is one. Platform is left empty.
+		bool TakeDump(Dump& Output)
+		{
+			if (PendingDump == Anomaly::Count) return false;
+
+			Output.Header = FileHeader();
+			Output.Header.Reason = uint32_t(PendingDump);
+			Output.Header.ReasonTick = PendingTick;
+			PendingDump = Anomaly::Count;
+
+			const uint64_t FirstTick = TickCount > Tick_Capacity ? TickCount - Tick_Capacity : 0;
+			Output.Ticks.clear();
+			for (uint64_t i = FirstTick; i < TickCount; i++) Output.Ticks.push_back(Ticks[i % Tick_Capacity]);
+
+			// Edits older than the oldest tick left or already overwritten can't be told apart from the ones after, so they go
+			uint64_t FirstEdit = EditCount > Edit_Capacity ? EditCount - Edit_Capacity : 0;
+			if (!Output.Ticks.empty()) FirstEdit = std::max(FirstEdit, Output.Ticks.front().FirstEdit);
+			Output.Edits.clear();
+			for (uint64_t i = FirstEdit; i < EditCount; i++) Output.Edits.push_back(Edits[i % Edit_Capacity]);
+
+			Output.Platform.clear();
+			return true;
+		}
+
+		// Last tick EndTick finished
+		const TickRecord& Last() const { return Ticks[(TickCount + Tick_Capacity - 1) % Tick_Capacity]; }
+		uint64_t GetTickCount() const { return TickCount; }
+
+		// Forgets everything recorded, cooldowns included
+		void Reset()
+		{
+			TickCount = 0;
+			EditCount = 0;
+			PendingDump = Anomaly::Count;
+			for (size_t i = 0; i < size_t(Anomaly::Count); i++) Dumped[i] = false;
+		}
+
+	private:
+		TickRecord Ticks[Tick_Capacity];
+		EditRecord Edits[Edit_Capacity];
+		uint64_t TickCount = 0;
+		uint64_t EditCount = 0;
+
+		uint64_t DumpCooldownTicks;
+		Anomaly PendingDump = Anomaly::Count;
+		uint64_t PendingTick = 0;
+		bool Dumped[size_t(Anomaly::Count)] = {};
+		uint64_t LastDumpTick[size_t(Anomaly::Count)] = {};
+	};
+}
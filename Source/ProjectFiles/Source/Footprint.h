@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*******************************************************
+	Platform footprints stretched along the direction the player is moving.
+
+	A disc of the platform radius puts as many cells beside and behind the player as in front of them, and while
+	walking only the front ones are ever stepped on. A moving footprint reaches LeadPerBand blocks further ahead for
+	every speed band, and is SideTrim blocks narrower beside and behind the player (never under MinimumSide). Standing
+	still, or in band 0, every shape is the old disc.
+
+		Disc		The old platform at every speed
+		Ellipse		One ellipse from the back edge to the front edge, widest ahead of the player
+		Capsule		A disc of the narrowed radius swept forward along the heading, full width all the way
+
+	Every footprint for every radius, Heading_Count headings and Speed_Band_Count bands is generated once, when Tables
+	is built, as a list of offsets from the player's block plus a bitmap for Contains. MotionTracker turns player
+	positions into the quantized heading and band, with hysteresis on the heading so walking along the line
+	between two headings doesn't switch footprints (and rewrite cells) every update.
+
+	Doesn't call into the game, so it also runs in Benchmarks/FootprintReplay.cpp.
+*******************************************************/
+
+namespace Footprints {
+
+	enum class Shape : uint8_t {
+		Disc,
+		Ellipse,
+		Capsule,
+		Count
+	};
+
+	inline constexpr const wchar_t* Shape_Names[size_t(Shape::Count)] = { L"Disc", L"Ellipse", L"Capsule" };
+
+	inline constexpr int Heading_Count = 16;
+	inline constexpr int Speed_Band_Count = 4;
+	inline constexpr int Max_Reach = 8;		// Blocks from the player's block any footprint can reach
+	inline constexpr int Span = 2 * Max_Reach + 1;
+
+	struct Config {
+		int32_t MotionSpanTicks = 4;		// Ticks a movement is measured over, the platform update interval
+		int32_t BandCentimeters = 12;		// cm moved per MotionSpanTicks for each speed band
+		int32_t TeleportCentimeters = 200;	// Further than this in one span is a teleport, not movement
+		int32_t LeadPerBand = 1;			// Blocks added ahead per speed band
+		int32_t SideTrim = 1;				// Blocks taken off beside and behind the player while moving
+		int32_t MinimumSide = 2;			// Blocks beside and behind the player that always stay
+		double BandHysteresis = 0.5;		// Of a band, how much slower than a band the player must go to drop out of it
+		double HeadingHysteresis = 1.0;		// Of a heading sector, how far the direction may be off before switching
+	};
+
+	struct Offset {
+		int8_t X = 0;
+		int8_t Y = 0;
+	};
+
+	struct Motion {
+		uint8_t Heading = 0;	// Heading_Count steps counter-clockwise from +X
+		uint8_t Band = 0;		// 0 is standing still
+
+		bool operator==(const Motion& Other) const { return Heading == Other.Heading && Band == Other.Band; }
+	};
+
+	class Footprint
+	{
+	public:
+		std::vector<Offset> Cells;	// Row by row, like GetAllPointsInCircle
+
+		bool Contains(int64_t X, int64_t Y) const
+		{
+			if (X < -Max_Reach || X > Max_Reach || Y < -Max_Reach || Y > Max_Reach) return false;
+			return Inside[size_t((Y + Max_Reach) * Span + X + Max_Reach)];
+		}
+
+		void Add(int X, int Y)
+		{
+			Cells.push_back(Offset{ int8_t(X), int8_t(Y) });
+			Inside[size_t((Y + Max_Reach) * Span + X + Max_Reach)] = true;
+		}
+
+	private:
+		std::bitset<Span * Span> Inside;
+	};
+
+	inline double HeadingAngle(int Heading)
+	{
+		return double(Heading) * 6.283185307179586 / Heading_Count;
+	}
+
+	// The cell centre X, Y (in blocks from the player's block) against one shape. Band 0 is the disc of Radius for every shape.
+	inline bool IsInside(Shape Kind, int Radius, const Motion& Moving, const Config& Settings, int X, int Y)
+	{
+		const double Epsilon = 1e-9;
+		if (Kind == Shape::Disc || Moving.Band == 0) return X * X + Y * Y <= Radius * Radius;
+
+		const double Side = std::max(std::min(Settings.MinimumSide, Radius), Radius - Settings.SideTrim);
+		const double Lead = std::min((Moving.Band - 1) * Settings.LeadPerBand, Max_Reach - Radius);
+		const double Angle = HeadingAngle(Moving.Heading);
+		const double Along = X * std::cos(Angle) + Y * std::sin(Angle);
+		const double Across = -X * std::sin(Angle) + Y * std::cos(Angle);
+
+		if (Kind == Shape::Capsule) {
+			const double Spine = std::clamp(Along, 0.0, double(Radius - Side) + Lead);
+			return (Along - Spine) * (Along - Spine) + Across * Across <= Side * Side + Epsilon;
+		}
+
+		// From Side behind the player to Radius + Lead ahead of them, Side wide at the middle
+		const double Front = Radius + Lead;
+		const double HalfLength = (Front + Side) / 2;
+		const double Middle = (Front - Side) / 2;
+		return (Along - Middle) * (Along - Middle) / (HalfLength * HalfLength) + Across * Across / (Side * Side) <= 1 + Epsilon;
+	}
+
+	inline Footprint Build(Shape Kind, int Radius, const Motion& Moving, const Config& Settings)
+	{
+		Footprint Built;
+		for (int Y = -Max_Reach; Y <= Max_Reach; Y++) {
+			for (int X = -Max_Reach; X <= Max_Reach; X++) {
+				if (IsInside(Kind, Radius, Moving, Settings, X, Y)) Built.Add(X, Y);
+			}
+		}
+		return Built;
+	}
+
+	// Every footprint for radii MinimumRadius to MaximumRadius
+	class Tables
+	{
+	public:
+		Tables(int MinimumRadius_, int MaximumRadius_, const Config& Settings_ = Config())
+			: MinimumRadius(MinimumRadius_), MaximumRadius(std::max(MinimumRadius_, MaximumRadius_)), Settings(Settings_)
+		{
+			for (size_t Kind = 0; Kind < size_t(Shape::Count); Kind++) {
+				for (int Radius = MinimumRadius; Radius <= MaximumRadius; Radius++) {
+					for (int Band = 0; Band < Speed_Band_Count; Band++) {
+						for (int Heading = 0; Heading < Heading_Count; Heading++) {
+							Footprints.push_back(Build(Shape(Kind), Radius, Motion{ uint8_t(Heading), uint8_t(Band) }, Settings));
+						}
+					}
+				}
+			}
+		}
+
+		const Footprint& Get(Shape Kind, int Radius, const Motion& Moving) const
+		{
+			const size_t Radii = size_t(MaximumRadius - MinimumRadius + 1);
+			const size_t RadiusIndex = size_t(std::clamp(Radius, MinimumRadius, MaximumRadius) - MinimumRadius);
+			const size_t Index = ((size_t(Kind) * Radii + RadiusIndex) * Speed_Band_Count + Moving.Band) * Heading_Count + Moving.Heading;
+			return Footprints[Index];
+		}
+
+		const Config& GetConfig() const { return Settings; }
+
+	private:
+		int MinimumRadius;
+		int MaximumRadius;
+		Config Settings;
+		std::vector<Footprint> Footprints;
+	};
+
+	// Heading and speed band from the player's position in cm, sampled at least every MotionSpanTicks
+	class MotionTracker
+	{
+	public:
+		explicit MotionTracker(const Config& Settings_ = Config()) : Settings(Settings_) {}
+
+		// Keeps the last motion until MotionSpanTicks have passed since the last measurement
+		Motion Update(int64_t Tick, int64_t X, int64_t Y)
+		{
+			if (!HasSample || Tick < SampleTick) {
+				Start(Tick, X, Y);
+				return Current;
+			}
+
+			const int64_t Ticks = Tick - SampleTick;
+			if (Ticks < Settings.MotionSpanTicks) return Current;
+
+			const double DeltaX = double(X - SampleX);
+			const double DeltaY = double(Y - SampleY);
+			const double PerSpan = std::sqrt(DeltaX * DeltaX + DeltaY * DeltaY) * Settings.MotionSpanTicks / double(Ticks);
+			Start(Tick, X, Y);
+
+			// A pause between samples or a jump says nothing about where the player is heading
+			if (Ticks > 4 * Settings.MotionSpanTicks || PerSpan > Settings.TeleportCentimeters) {
+				Current = Motion();
+				return Current;
+			}
+
+			// Dropping a band takes BandHysteresis of a band more slowing down, so a speed right on the boundary doesn't
+			// switch footprints every update
+			const double Bands = PerSpan / std::max(Settings.BandCentimeters, 1);
+			int Band = std::min(Speed_Band_Count - 1, int(Bands));
+			if (Band < Current.Band && Bands > Current.Band - Settings.BandHysteresis) Band = Current.Band;
+			if (Band == 0) {
+				Current = Motion();
+				return Current;
+			}
+
+			const double Sector = 6.283185307179586 / Heading_Count;
+			const double Angle = std::atan2(DeltaY, DeltaX);
+			if (Current.Band == 0 || std::abs(std::remainder(Angle - HeadingAngle(Current.Heading), 6.283185307179586)) > Sector * Settings.HeadingHysteresis) {
+				const int Nearest = int(std::lround(Angle / Sector));
+				Current.Heading = uint8_t(((Nearest % Heading_Count) + Heading_Count) % Heading_Count);
+			}
+			Current.Band = uint8_t(Band);
+			return Current;
+		}
+
+		void Reset()
+		{
+			HasSample = false;
+			Current = Motion();
+		}
+
+		const Motion& GetMotion() const { return Current; }
+
+	private:
+		Config Settings;
+		bool HasSample = false;
+		int64_t SampleTick = 0;
+		int64_t SampleX = 0;
+		int64_t SampleY = 0;
+		Motion Current;
+
+		void Start(int64_t Tick, int64_t X, int64_t Y)
+		{
+			HasSample = true;
+			SampleTick = Tick;
+			SampleX = X;
+			SampleY = Y;
+		}
+	};
+}
@@ -1,35 +1,95 @@
 #include "GameAPI.h"
+#include "HostBackend.h"
+#include "HostCallProfiler.h"
 
 #include <cstdint>
+#include <cstring>
 #include <random>
 #include <limits>
 
 void Log(const wString& String)
 {
-	InternalFunctions::I_Log(String.c_str());
+	PROFILE_HOST_CALL(Log);
+	Host::Log(String.c_str());
+}
+
+void Log(const wchar_t* String)
+{
+	PROFILE_HOST_CALL(Log);
+	Host::Log(String);
 }
 
 BlockInfo GetBlock(CoordinateInBlocks At)
 {
-	return InternalFunctions::I_GetBlock(At);
+	PROFILE_HOST_CALL(GetBlock);
+	return Host::GetBlock(At);
 }
 
 bool SetBlock(CoordinateInBlocks At, BlockInfo BlockType)
 {
 	BlockInfo BlockTypeOut;
-	return InternalFunctions::I_SetBlock(At, BlockType, BlockTypeOut);
+	PROFILE_HOST_CALL(SetBlock);
+	return Host::SetBlock(At, BlockType, BlockTypeOut);
 }
 
 BlockInfo GetAndSetBlock(CoordinateInBlocks At, BlockInfo BlockType)
 {
 	BlockInfo BlockTypeOut;
-	InternalFunctions::I_SetBlock(At, BlockType, BlockTypeOut);
+	PROFILE_HOST_CALL(SetBlock);
+	Host::SetBlock(At, BlockType, BlockTypeOut);
 	return BlockTypeOut;
 }
 
+static PlaceIfReplaceableStats PlaceStats;
+
+template<typename Predicate>
+bool PlaceIfReplaceable(CoordinateInBlocks At, BlockInfo NewBlock, Predicate CanReplace, BlockInfo& ReplacedOut, bool ExpectReplaceable)
+{
+	PlaceStats.Attempts++;
+
+	// A block that can't be replaced is never written, so it keeps its state and other mods don't see it change
+	if (!ExpectReplaceable) {
+		{
+			PROFILE_HOST_CALL(GetBlock);
+			ReplacedOut = Host::GetBlock(At);
+		}
+		if (!CanReplace(ReplacedOut)) {
+			PlaceStats.Declined++;
+			return false;
+		}
+	}
+
+	bool Written;
+	{
+		PROFILE_HOST_CALL(SetBlock);
+		Written = Host::SetBlock(At, NewBlock, ReplacedOut);
+	}
+	if (!Written) {
+		PlaceStats.Failed++;
+		return false;
+	}
+
+	if (CanReplace(ReplacedOut)) {
+		PlaceStats.Placed++;
+		return true;
+	}
+
+	BlockInfo Ignored;
+	PROFILE_HOST_CALL(SetBlock);
+	Host::SetBlock(At, ReplacedOut, Ignored);
+	PlaceStats.Reverted++;
+	return false;
+}
+
+const PlaceIfReplaceableStats& GetPlaceIfReplaceableStats()
+{
+	return PlaceStats;
+}
+
 void SpawnHintText(CoordinateInCentimeters At, const wString& Text, float DurationInSeconds, float SizeMultiplier, float SizeMultiplierVertical)
 {
-	return InternalFunctions::I_SpawnHintText(At, Text.c_str(), DurationInSeconds, SizeMultiplier, SizeMultiplierVertical);
+	PROFILE_HOST_CALL(SpawnHintText);
+	return Host::SpawnHintText(At, Text.c_str(), DurationInSeconds, SizeMultiplier, SizeMultiplierVertical);
 }
 
 bool SetBlock(CoordinateInBlocks At, EBlockType NativeType)
@@ -50,62 +110,74 @@ bool SetBlock(CoordinateInBlocks At, UniqueID CustomBlockID)
 
 CoordinateInCentimeters GetPlayerLocation()
 {
-	return InternalFunctions::I_GetPlayerLocation();
+	PROFILE_HOST_CALL(GetPlayerLocation);
+	return Host::GetPlayerLocation();
 }
 
 bool SetPlayerLocation(CoordinateInCentimeters To)
 {
-	return InternalFunctions::I_SetPlayerLocation(To);
+	PROFILE_HOST_CALL(SetPlayerLocation);
+	return Host::SetPlayerLocation(To);
 }
 
 CoordinateInCentimeters GetPlayerLocationHead()
 {
-	return InternalFunctions::I_GetPlayerLocationHead();
+	PROFILE_HOST_CALL(GetPlayerLocationHead);
+	return Host::GetPlayerLocationHead();
 }
 
 DirectionVectorInCentimeters GetPlayerViewDirection()
 {
-	return InternalFunctions::I_GetPlayerViewDirection();
+	PROFILE_HOST_CALL(GetPlayerViewDirection);
+	return Host::GetPlayerViewDirection();
 }
 
 CoordinateInCentimeters GetHandLocation(bool LeftHand)
 {
-	return InternalFunctions::I_GetHandLocation(LeftHand);
+	PROFILE_HOST_CALL(GetHandLocation);
+	return Host::GetHandLocation(LeftHand);
 }
 
 CoordinateInCentimeters GetIndexFingerTipLocation(bool LeftHand)
 {
-	return InternalFunctions::I_GetIndexFingerTipLocation(LeftHand);
+	PROFILE_HOST_CALL(GetIndexFingerTipLocation);
+	return Host::GetIndexFingerTipLocation(LeftHand);
 }
 
 void SpawnBlockItem(CoordinateInCentimeters At, BlockInfo Type)
 {
-	return InternalFunctions::I_SpawnBlockItem(At, Type);
+	PROFILE_HOST_CALL(SpawnBlockItem);
+	return Host::SpawnBlockItem(At, Type);
 }
 
 void AddToInventory(BlockInfo Type, int Amount)
 {
-	return InternalFunctions::I_AddToInventory(Type, Amount);
+	PROFILE_HOST_CALL(AddToInventory);
+	return Host::AddToInventory(Type, Amount);
 }
 
 void RemoveFromInventory(BlockInfo Type, int Amount)
 {
-	return InternalFunctions::I_RemoveFromInventory(Type, Amount);
+	PROFILE_HOST_CALL(RemoveFromInventory);
+	return Host::RemoveFromInventory(Type, Amount);
 }
 
 wString GetWorldName()
 {
-	return wString(InternalFunctions::I_GetWorldName());
+	PROFILE_HOST_CALL(GetWorldName);
+	return wString(Host::GetWorldName());
 }
 
 float GetTimeOfDay()
 {
-	return InternalFunctions::I_GetTimeOfDay();
+	PROFILE_HOST_CALL(GetTimeOfDay);
+	return Host::GetTimeOfDay();
 }
 
 void SetTimeOfDay(float NewTime)
 {
-	return InternalFunctions::I_SetTimeOfDay(NewTime);
+	PROFILE_HOST_CALL(SetTimeOfDay);
+	return Host::SetTimeOfDay(NewTime);
 }
 
 bool IsCurrentlyNight()
@@ -116,138 +188,179 @@ bool IsCurrentlyNight()
 
 void PlayHapticFeedbackOnHand(bool LeftHand, float DurationSeconds, float Frequency, float Amplitude)
 {
-	return InternalFunctions::I_PlayHapticFeedbackOnHand(LeftHand, DurationSeconds, Frequency, Amplitude);
+	PROFILE_HOST_CALL(PlayHapticFeedbackOnHand);
+	return Host::PlayHapticFeedbackOnHand(LeftHand, DurationSeconds, Frequency, Amplitude);
 }
 
 float GetPlayerHealth()
 {
-	return InternalFunctions::I_GetPlayerHealth();
+	PROFILE_HOST_CALL(GetPlayerHealth);
+	return Host::GetPlayerHealth();
 }
 
 float SetPlayerHealth(float NewHealth, bool Offset)
 {
-	return InternalFunctions::I_SetPlayerHealth(NewHealth, Offset);
+	PROFILE_HOST_CALL(SetPlayerHealth);
+	return Host::SetPlayerHealth(NewHealth, Offset);
 }
 
 void SpawnBPModActor(CoordinateInCentimeters At, const wString& ModName, const wString& ActorName)
 {
-	return InternalFunctions::I_SpawnBPModActor(At, ModName.c_str(), ActorName.c_str());
+	PROFILE_HOST_CALL(SpawnBPModActor);
+	return Host::SpawnBPModActor(At, ModName.c_str(), ActorName.c_str());
 }
 
 void SaveModDataString(wString ModName, wString StringIn)
 {
-	return InternalFunctions::I_SaveModDataString(ModName.c_str(), StringIn.c_str());
+	PROFILE_HOST_CALL(SaveModDataString);
+	return Host::SaveModDataString(ModName.c_str(), StringIn.c_str());
 }
 
 bool LoadModDataString(wString ModName, wString& StringOut)
 {
 	wchar_t* StringOutT;
 
-	bool success = InternalFunctions::I_LoadModDataString(ModName.c_str(), StringOutT);
+	bool success;
+	{
+		PROFILE_HOST_CALL(LoadModDataString);
+		success = Host::LoadModDataString(ModName.c_str(), StringOutT);
+	}
 
 	if (!success) return false;
 
 	StringOut = std::wstring(StringOutT);
 
-	HeapFree(GetProcessHeap(), 0, StringOutT);
+	Host::FreeHostMemory(StringOutT);
 
 	return true;
 }
 
 void SaveModData(wString ModName, const std::vector<uint8_t>& Data)
 {
-	return InternalFunctions::I_SaveModData(ModName.c_str(), (uint8_t*) Data.data(), Data.size());
+	PROFILE_HOST_CALL(SaveModData);
+	return Host::SaveModData(ModName.c_str(), (uint8_t*) Data.data(), Data.size());
 }
 
 std::vector<uint8_t> LoadModData(wString ModName)
 {
 	uint64_t ArraySize;
-	uint8_t* Data = InternalFunctions::I_LoadModData(ModName.c_str(), &ArraySize);
+	uint8_t* Data;
+	{
+		PROFILE_HOST_CALL(LoadModData);
+		Data = Host::LoadModData(ModName.c_str(), &ArraySize);
+	}
 
 	std::vector<uint8_t> DataOut(ArraySize);
 	
-	memcpy(&DataOut[0], Data, ArraySize);
+	if (ArraySize > 0) memcpy(&DataOut[0], Data, ArraySize);
 
-	HeapFree(GetProcessHeap(), 0, Data);
+	Host::FreeHostMemory(Data);
 
 	return DataOut;
 }
 
 
-/*******************************************************
-	Useful functions
-*******************************************************/
+#include "GameUtilities.cpp"
 
+static BlockSearchStats SearchStats;
 
-std::vector<CoordinateInBlocks> GetAllCoordinatesInBox(CoordinateInBlocks At, CoordinateInBlocks BoxExtent)
+// Reads the cells of the search in order until OnBlock returns true for one, the cells run out or MaxReads blocks were read.
+// Search.NextCell is left on the cell after the last one read.
+template<typename Visitor>
+static void VisitSearchCells(CoordinateInBlocks At, int32_t Radius, SearchShape Shape, BlockSearch& Search, size_t MaxReads, Visitor OnBlock)
 {
-	std::vector<CoordinateInBlocks> ReturnCoordinates;
-	
-	for (int64_t x = -BoxExtent.X; x < BoxExtent.X; x++) {
-		for (int64_t y = -BoxExtent.Y; y < BoxExtent.Y; y++) {
-			for (int16_t z = -BoxExtent.Z; z < BoxExtent.Z; z++) {
+	if (Search.NextCell == 0) SearchStats.Queries++;
+
+	const SearchShellTable& Shells = GetSearchShells();
+	const size_t CellCount = Shape == SearchShape::Ball ? Shells.CellsWithin(Radius) : size_t(std::max(Radius, 0)) + 1;
 
-				CoordinateInBlocks Offset = CoordinateInBlocks(x, y, z);
+	size_t Reads = 0;
+	auto Read = [&](const CoordinateInBlocks& Cell) {
+		Reads++;
+		PROFILE_HOST_CALL(GetBlock);
+		return OnBlock(Cell, Host::GetBlock(Cell));
+	};
 
-				if ( ((int32_t(At.Z) + int32_t(Offset.Z)) >= 0) && ((int32_t(At.Z) + int32_t(Offset.Z)) <= 800)) {
-					ReturnCoordinates.push_back(At + Offset);				
-				}
+	if (Shape == SearchShape::Ball) {
+		for (; Search.NextCell < CellCount && Reads < MaxReads; Search.NextCell++) {
+			const SearchShellTable::Offset& Offset = Shells.Cells[Search.NextCell];
+			const int32_t Z = int32_t(At.Z) + Offset.Z;
+			if (Z < World_Min_Height || Z > World_Max_Height) continue;
+			if (Read(CoordinateInBlocks(At.X + Offset.X, At.Y + Offset.Y, int16_t(Z)))) {
+				Search.NextCell++;
+				break;
+			}
+		}
+	}
+	else {
+		for (; Search.NextCell < CellCount && Reads < MaxReads; Search.NextCell++) {
+			const int32_t Z = int32_t(At.Z) - int32_t(Search.NextCell);
+			if (Z < World_Min_Height || Z > World_Max_Height) continue;
+			if (Read(CoordinateInBlocks(At.X, At.Y, int16_t(Z)))) {
+				Search.NextCell++;
+				break;
 			}
 		}
 	}
 
-	return ReturnCoordinates;
+	SearchStats.Reads += Reads;
+	Search.Finished = Search.NextCell >= CellCount;
 }
 
-std::vector<CoordinateInBlocks> GetAllCoordinatesInRadius(CoordinateInBlocks At, int32_t Radius)
+template<typename Predicate>
+size_t FindAllWithin(CoordinateInBlocks At, int32_t Radius, Predicate Matches, std::vector<CoordinateInBlocks>& Out, size_t MaxMatches, SearchShape Shape, BlockSearch& Search, size_t MaxReads)
 {
-	std::vector<CoordinateInBlocks> ReturnCoordinates;
+	size_t Found = 0;
+	if (MaxMatches == 0) return 0;
 
-	for (int64_t x = -Radius; x < Radius; x++) {
-		for (int64_t y = -Radius; y < Radius; y++) {
-			for (int16_t z = -Radius; z < Radius; z++) {
+	VisitSearchCells(At, Radius, Shape, Search, MaxReads, [&](const CoordinateInBlocks& Cell, const BlockInfo& Block) {
+		if (!Matches(Block)) return false;
+		Out.push_back(Cell);
+		return ++Found >= MaxMatches;
+	});
+	SearchStats.Matches += Found;
 
-				CoordinateInBlocks Offset = CoordinateInBlocks(x, y, z);
+	if (Found >= MaxMatches) Search.Finished = true;
+	return Found;
+}
 
-				if (((int32_t(At.Z) + int32_t(Offset.Z)) >= 0) && ((int32_t(At.Z) + int32_t(Offset.Z)) <= 800)) {
-					if (Offset.GetLength() <= Radius) {
-						ReturnCoordinates.push_back(At + Offset);
-					}
-				}
-			}
-		}
-	}
+template<typename Predicate>
+size_t FindAllWithin(CoordinateInBlocks At, int32_t Radius, Predicate Matches, std::vector<CoordinateInBlocks>& Out, size_t MaxMatches, SearchShape Shape)
+{
+	BlockSearch Search;
+	return FindAllWithin(At, Radius, Matches, Out, MaxMatches, Shape, Search, SIZE_MAX);
+}
 
-	return ReturnCoordinates;
+template<typename Predicate>
+bool FindNearest(CoordinateInBlocks At, int32_t Radius, Predicate Matches, CoordinateInBlocks& Out, SearchShape Shape)
+{
+	BlockSearch Search;
+	bool Found = false;
+	VisitSearchCells(At, Radius, Shape, Search, SIZE_MAX, [&](const CoordinateInBlocks& Cell, const BlockInfo& Block) {
+		if (!Matches(Block)) return false;
+		Out = Cell;
+		return Found = true;
+	});
+	SearchStats.Matches += Found;
+	return Found;
 }
 
+const BlockSearchStats& GetBlockSearchStats()
+{
+	return SearchStats;
+}
 
 
-#pragma warning(disable:6386)
 wString GetThisModInstallFolderPathInternal()
 {
-	wchar_t path[MAX_PATH];
-	HMODULE hm = NULL;
-
-	if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
-		GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-		(LPCWSTR)&GetAllCoordinatesInRadius, &hm) == 0)
+	std::wstring StringToReturn;
+	if (!Host::ModuleDirectory(StringToReturn))
 	{
 		return std::wstring(L"Error");
 	}
-	if (GetModuleFileNameW(hm, path, sizeof(path)) == 0)
-	{
-		return std::wstring(L"Error");
-	}
-
-	std::wstring StringToReturn = std::wstring(path);
-	StringToReturn = StringToReturn.substr(0, StringToReturn.find_last_of(L"\\/"));
-
-	StringToReturn += L"\\";
 
 	return StringToReturn;
 }
-#pragma warning(default:6386)
 
 const wString& GetThisModInstallFolderPath()
 {
@@ -259,20 +372,22 @@ const wString& GetThisModInstallFolderPath()
 wString GetThisModSaveFolderPath(wString ModName)
 {
 	wchar_t StringOut[1000];
-	InternalFunctions::I_GetThisModSaveFolderPath(ModName.c_str(), StringOut);
+	PROFILE_HOST_CALL(GetThisModSaveFolderPath);
+	Host::GetThisModSaveFolderPath(ModName.c_str(), StringOut);
 
 	return wString(StringOut);
 }
 
 GameVersion GetGameVersionNumber()
 {
-	static GameVersion VersionNumber = InternalFunctions::I_GetGameVersionNumber();
+	static GameVersion VersionNumber = Host::GetGameVersionNumber();
 	return VersionNumber;
 }
 
 ScopedSharedMemoryHandle GetSharedMemoryPointer(wString Key, bool CreateIfNotExist, bool WaitUntilExist)
 {
-	return ScopedSharedMemoryHandle(InternalFunctions::I_GetSharedMemoryPointer(Key.c_str(), CreateIfNotExist, WaitUntilExist));
+	PROFILE_HOST_CALL(GetSharedMemoryPointer);
+	return ScopedSharedMemoryHandle(Host::GetSharedMemoryPointer(Key.c_str(), CreateIfNotExist, WaitUntilExist));
 }
 
 ScopedSharedMemoryHandle::~ScopedSharedMemoryHandle() 
@@ -283,62 +398,14 @@ ScopedSharedMemoryHandle::~ScopedSharedMemoryHandle()
 		HandleC.Key = Key;
 		HandleC.Valid = Valid;
 
-		InternalFunctions::I_ReleaseSharedMemoryPointer(HandleC);
+		PROFILE_HOST_CALL(ReleaseSharedMemoryPointer);
+		Host::ReleaseSharedMemoryPointer(HandleC);
 	}
 }
 
 
 
-template<class T>
-constexpr auto absolute(T const& x) {
-	return x < 0 ? -x : x;
-}
-
-constexpr static __forceinline uint64_t rotl(const uint64_t x, int k) {
-	return (x << k) | (x >> (64 - k));
-}
-
-static std::random_device rd;
-static std::mt19937 rng(rd());
-static uint64_t xors_s[2] = { std::uniform_int_distribution<uint64_t>(0, UINT64_MAX)(rng), std::uniform_int_distribution<uint64_t>(0, UINT64_MAX)(rng) };
-
-__forceinline uint64_t xoroshiro128p(void) {
-	const uint64_t s0 = xors_s[0];
-	uint64_t s1 = xors_s[1];
-	const uint64_t result = s0 + s1;
-
-	s1 ^= s0;
-	xors_s[0] = rotl(s0, 24) ^ s1 ^ (s1 << 16); // a, b
-	xors_s[1] = rotl(s1, 37); // c
-
-	return result;
-}
-
-template<uint64_t TrueOneInN>
-bool GetRandomBool()
-{
-	static constexpr uint64_t AboveThisTrue = UINT64_MAX - (UINT64_MAX / TrueOneInN);
-
-	return xoroshiro128p() > AboveThisTrue;
-}
-
-template<int32_t Min, int32_t Max>
-int32_t GetRandomInt()
-{
-	static_assert(Max > Min, "Called GetRandomInt with Min larger than Max");
-	static_assert(Max != INT32_MAX, "GetRandomInt Max can't be INT32_MAX. Please reduce Max by at least one");
-
-	static constexpr uint32_t TotalSpan = int64_t(Max) - int64_t(Min);
-	static constexpr uint32_t DivideBy = (UINT32_MAX / (TotalSpan + 1)) + 1;
-
-	if constexpr (TotalSpan == UINT32_MAX) return int32_t(xoroshiro128p());
-	if constexpr (Min == Max) return Min;
-
-	return int32_t(uint32_t(xoroshiro128p()) / DivideBy) + Min;
-}
-
-
 int main() 
 {
-
+	return 0;
 }
\ No newline at end of file
@@ -23,6 +23,7 @@ using namespace ModAPI;
 *	Example how you can call Log:																Log(L"Hi! This is text that will be logged");		
 */
 	void Log(const wString& String);
+	void Log(const wchar_t* String);
 
 /*
 *	Returns the block at the coordinate your specify. You can call this with either a CoordinateInBlocks or a CoordinateInCentimeters.
@@ -54,6 +55,29 @@ using namespace ModAPI;
 */
 	BlockInfo GetAndSetBlock(CoordinateInBlocks At, BlockInfo BlockType);
 
+/*
+*	Place a block only if the block currently at that coordinate passes CanReplace. Returns true if NewBlock was placed, ReplacedOut is the block that was there before.
+*	The block is read first and left alone if it can't be replaced. Pass ExpectReplaceable when it almost certainly can, e.g. open air ahead of something moving,
+*	to skip the read and use a single GetAndSetBlock call instead: if the replaced block turns out not to be replaceable it is put back immediately, which costs
+*	a second write, fires the AnyBlock events twice and loses whatever state the block had.
+*
+*	Example placing stone only into air:														PlaceIfReplaceable(At, EBlockType::Stone, [](const BlockInfo& B) { return B.Type == EBlockType::Air; }, Replaced);
+*/
+	template<typename Predicate> bool PlaceIfReplaceable(CoordinateInBlocks At, BlockInfo NewBlock, Predicate CanReplace, BlockInfo& ReplacedOut, bool ExpectReplaceable = false);
+
+/*
+*	Counters for PlaceIfReplaceable. Placed counts calls where NewBlock was kept, Declined the ones that read a block that can't be replaced and wrote nothing,
+*	Reverted the ones with ExpectReplaceable that had to put the old block back.
+*/
+	struct PlaceIfReplaceableStats {
+		uint64_t Attempts = 0;
+		uint64_t Placed = 0;
+		uint64_t Declined = 0;
+		uint64_t Reverted = 0;
+		uint64_t Failed = 0;		// The game refused the write, nothing to put back
+	};
+	const PlaceIfReplaceableStats& GetPlaceIfReplaceableStats();
+
 /*
 *	Spawn a hint text popup with the specified text at the specified coordinate. Examples how you can call SpawnHintText:		
 * 
@@ -189,12 +213,76 @@ using namespace ModAPI;
 */
 	template<int32_t Min, int32_t Max> int32_t GetRandomInt();
 
+/*
+*	Runtime versions of GetRandomBool and GetRandomInt, for when the chance or the range is only known at runtime. Still only a handful of CPU cycles.
+*
+*	Example for returning a random int between 0 and platformRadius:							GetRandomInt(0, platformRadius);
+*/
+	bool GetRandomBool(uint64_t TrueOneInN);
+	int32_t GetRandomInt(int32_t Min, int32_t Max);
+
+/*
+*	Fill a whole array with random values in one call. Much faster per value than calling GetRandomInt in a loop once you need more than a few dozen values.
+*
+*	Example filling 4096 ints between -2 and 2:													FillRandomInts(Values.data(), Values.size(), -2, 2);
+*/
+	void FillRandom(uint64_t* Out, size_t Count);
+	void FillRandomInts(int32_t* Out, size_t Count, int32_t Min, int32_t Max);
+
+/*
+*	All random functions above are thread-safe, every thread gets its own random stream. They are seeded randomly unless you call SetRandomSeed.
+*	Calling SetRandomSeed with the same seed makes the sequence on a single thread reproducible, e.g. for headless or replay runs.
+*/
+	void SetRandomSeed(uint64_t Seed);
+
+/*
+*	The lowest and highest Z a block can be at. Coordinates outside are left out of the arrays below, and the searches after them skip them.
+*/
+	constexpr int World_Min_Height = 0;
+	constexpr int World_Max_Height = 720;
+
 /*
 *	Returns an array of all coordinates in a certain box extent or radius around a specific coordinate
 */
 	std::vector<CoordinateInBlocks> GetAllCoordinatesInBox(CoordinateInBlocks At, CoordinateInBlocks BoxExtent);
 	std::vector<CoordinateInBlocks> GetAllCoordinatesInRadius(CoordinateInBlocks At, int32_t Radius);	
 
+/*
+*	Search for blocks near a coordinate, nearest first, without building the list of coordinates first. The cells within Radius of At are read with GetBlock
+*	one shell of equal distance after the other, and the search stops as soon as MaxMatches blocks passed Matches (FindNearest stops at the first one).
+*	SearchShape::Ball looks in every direction up to Search_Max_Radius, SearchShape::ColumnDown only straight down from At, as far as Radius.
+*	Matches gets the BlockInfo, the block property tables have constexpr ones, see BlockProperty::Table::Matching.
+*
+*	Example finding the nearest solid block within 8 blocks:									FindNearest(At, 8, Properties.Matching(BlockProperty::Solid), Found);
+*
+*	To spread a long search over several ticks, pass the same BlockSearch to FindAllWithin until Finished, it reads at most MaxReads blocks per call.
+*/
+	constexpr int32_t Search_Max_Radius = 16;
+
+	enum class SearchShape : uint8_t {
+		Ball,
+		ColumnDown
+	};
+
+	struct BlockSearch {
+		size_t NextCell = 0;
+		bool Finished = false;
+	};
+
+	template<typename Predicate> bool FindNearest(CoordinateInBlocks At, int32_t Radius, Predicate Matches, CoordinateInBlocks& Out, SearchShape Shape = SearchShape::Ball);
+	template<typename Predicate> size_t FindAllWithin(CoordinateInBlocks At, int32_t Radius, Predicate Matches, std::vector<CoordinateInBlocks>& Out, size_t MaxMatches = SIZE_MAX, SearchShape Shape = SearchShape::Ball);
+	template<typename Predicate> size_t FindAllWithin(CoordinateInBlocks At, int32_t Radius, Predicate Matches, std::vector<CoordinateInBlocks>& Out, size_t MaxMatches, SearchShape Shape, BlockSearch& Search, size_t MaxReads);
+
+/*
+*	Counters for FindNearest and FindAllWithin. Reads is the number of GetBlock calls, so Reads / Queries is what a search costs on average.
+*/
+	struct BlockSearchStats {
+		uint64_t Queries = 0;
+		uint64_t Reads = 0;
+		uint64_t Matches = 0;
+	};
+	const BlockSearchStats& GetBlockSearchStats();
+
 /*
 *	Get a handle to memory that you want to share between multiple different mods. If you don't know what this does, you most likely never need to use it. 
 *	The handle automatically aquires a lock on the memory it points to, and releases it when going out of scope.
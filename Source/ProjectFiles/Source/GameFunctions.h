@@ -154,6 +154,35 @@ namespace ModAPI {
 	struct CoordinateInBlocks;
 	struct DirectionVectorInCentimeters;
 
+	// Integer division rounding to the nearest integer, halves away from zero. Denominator must be positive.
+	// Gives the same result as round_custom(double(Numerator) / Denominator) without going through double, and vectorizes.
+	// The Denominator is a template argument so the division is always a multiply, the optimizer doesn't reliably see
+	// a constant passed as an argument once the call is inlined into a larger function. Half gets the sign of the
+	// Numerator without a branch.
+	template<int64_t Denominator>
+	constexpr int64_t DivideRoundNearest(int64_t Numerator)
+	{
+		static_assert(Denominator > 0, "DivideRoundNearest needs a positive Denominator");
+
+		const int64_t Sign = Numerator >> 63;
+		return (Numerator + ((Denominator / 2) ^ Sign) - Sign) / Denominator;
+	}
+
+	// Integer division rounding towards negative infinity (C++ division rounds towards zero). Denominator must be positive.
+	constexpr int64_t DivideFloor(int64_t Numerator, int64_t Denominator)
+	{
+		const int64_t Quotient = Numerator / Denominator;
+		return Quotient - ((Numerator % Denominator) < 0 ? 1 : 0);
+	}
+
+	// Same result as lround for every float in int64 range, but constexpr. x - trunc(x) is exact in float, so there is no double rounding.
+	constexpr int64_t RoundToInt64(float X)
+	{
+		const int64_t Truncated = int64_t(X);
+		const float Fraction = X - float(Truncated);
+		return Truncated + (Fraction >= 0.5f ? 1 : 0) - (Fraction <= -0.5f ? 1 : 0);
+	}
+
 	struct CoordinateInCentimeters {
 
 		int64_t X;
@@ -215,8 +244,12 @@ namespace ModAPI {
 			return L"X=" + std::to_wstring(X) + L" Y=" + std::to_wstring(Y) + L" Z=" + std::to_wstring(Z);
 		}
 
+		constexpr int64_t GetLengthSquared() const {
+			return X * X + Y * Y + int64_t(Z) * Z;
+		}
+
 		double GetLength() const {
-			return sqrt(X * X + Y * Y + Z * Z);
+			return sqrt(double(GetLengthSquared()));
 		}
 
 		constexpr CoordinateInBlocks() = default;
@@ -257,9 +290,9 @@ namespace ModAPI {
 		operator CoordinateInCentimeters()
 		{
 			CoordinateInCentimeters Value;
-			Value.X = lround(X);
-			Value.Y = lround(Y);
-			Value.Z = (uint16_t) lround(Z);
+			Value.X = RoundToInt64(X);
+			Value.Y = RoundToInt64(Y);
+			Value.Z = (uint16_t) RoundToInt64(Z);
 			return Value;
 		}
 
@@ -280,7 +313,18 @@ namespace ModAPI {
 
 	constexpr CoordinateInCentimeters::CoordinateInCentimeters(const CoordinateInBlocks CIB) : X(CIB.X * 50), Y(CIB.Y * 50), Z(CIB.Z * 50) {};
 
-	constexpr CoordinateInBlocks::CoordinateInBlocks(const CoordinateInCentimeters CIM) : X(round_custom(double(CIM.X) / 50)), Y(round_custom(double(CIM.Y) / 50)), Z(int16_t(round_custom(double(CIM.Z) / 50))) {};
+	constexpr CoordinateInBlocks::CoordinateInBlocks(const CoordinateInCentimeters CIM) : X(DivideRoundNearest<50>(CIM.X)), Y(DivideRoundNearest<50>(CIM.Y)), Z(int16_t(DivideRoundNearest<50>(CIM.Z))) {};
+
+	constexpr bool DivideRoundNearestMatchesRoundCustom(int64_t From, int64_t To)
+	{
+		for (int64_t i = From; i <= To; i++) {
+			if (DivideRoundNearest<50>(i) != round_custom(double(i) / 50)) return false;
+		}
+		return true;
+	}
+	static_assert(DivideRoundNearestMatchesRoundCustom(-2000, 2000));
+	static_assert(DivideFloor(-1, 50) == -1 && DivideFloor(-50, 50) == -1 && DivideFloor(-51, 50) == -2 && DivideFloor(49, 50) == 0);
+	static_assert(RoundToInt64(0.49999997f) == 0 && RoundToInt64(0.5f) == 1 && RoundToInt64(-0.5f) == -1 && RoundToInt64(-2.4f) == -2);
 
 
 	typedef uint32_t UniqueID;
@@ -0,0 +1,335 @@
+#include "GameAPI.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <limits>
+
+/*******************************************************
+	Helpers that don't call into the game. Kept apart from GameAPI.cpp so they also build without Windows
+	(see Benchmarks/UtilityBenchmark.cpp).
+*******************************************************/
+
+#if !defined(_MSC_VER) && !defined(__forceinline)
+#define __forceinline inline __attribute__((always_inline))
+#endif
+
+/*******************************************************
+	Useful functions
+*******************************************************/
+
+
+std::vector<CoordinateInBlocks> GetAllCoordinatesInBox(CoordinateInBlocks At, CoordinateInBlocks BoxExtent)
+{
+	std::vector<CoordinateInBlocks> ReturnCoordinates;
+	
+	for (int64_t x = -BoxExtent.X; x < BoxExtent.X; x++) {
+		for (int64_t y = -BoxExtent.Y; y < BoxExtent.Y; y++) {
+			for (int16_t z = -BoxExtent.Z; z < BoxExtent.Z; z++) {
+
+				CoordinateInBlocks Offset = CoordinateInBlocks(x, y, z);
+
+				if ( ((int32_t(At.Z) + int32_t(Offset.Z)) >= World_Min_Height) && ((int32_t(At.Z) + int32_t(Offset.Z)) <= World_Max_Height)) {
+					ReturnCoordinates.push_back(At + Offset);				
+				}
+			}
+		}
+	}
+
+	return ReturnCoordinates;
+}
+
+std::vector<CoordinateInBlocks> GetAllCoordinatesInRadius(CoordinateInBlocks At, int32_t Radius)
+{
+	std::vector<CoordinateInBlocks> ReturnCoordinates;
+
+	for (int64_t x = -Radius; x < Radius; x++) {
+		for (int64_t y = -Radius; y < Radius; y++) {
+			for (int16_t z = -Radius; z < Radius; z++) {
+
+				CoordinateInBlocks Offset = CoordinateInBlocks(x, y, z);
+
+				if (((int32_t(At.Z) + int32_t(Offset.Z)) >= World_Min_Height) && ((int32_t(At.Z) + int32_t(Offset.Z)) <= World_Max_Height)) {
+					if (Offset.GetLengthSquared() <= int64_t(Radius) * Radius) {
+						ReturnCoordinates.push_back(At + Offset);
+					}
+				}
+			}
+		}
+	}
+
+	return ReturnCoordinates;
+}
+
+/*
+*	Every offset within Search_Max_Radius of the origin, sorted by squared distance so that a search visits them nearest first. The cells within
+*	Radius are the first CellsWithin(Radius) of them. Built once on first use, 17 thousand offsets in about 70 KB.
+*/
+struct SearchShellTable {
+	struct Offset {
+		int8_t X, Y, Z;
+	};
+
+	std::vector<Offset> Cells;
+	std::vector<uint32_t> ShellEnd;		// ShellEnd[D] is one past the last offset with a squared distance of D or less
+
+	size_t CellsWithin(int32_t Radius) const
+	{
+		if (Radius < 0) return 0;
+		return ShellEnd[size_t(std::min(Radius, Search_Max_Radius) * std::min(Radius, Search_Max_Radius))];
+	}
+};
+
+static SearchShellTable BuildSearchShells()
+{
+	const int32_t MaxSquared = Search_Max_Radius * Search_Max_Radius;
+
+	SearchShellTable Table;
+	std::vector<uint32_t> CountPerShell(size_t(MaxSquared) + 1, 0);
+	for (int32_t x = -Search_Max_Radius; x <= Search_Max_Radius; x++) {
+		for (int32_t y = -Search_Max_Radius; y <= Search_Max_Radius; y++) {
+			for (int32_t z = -Search_Max_Radius; z <= Search_Max_Radius; z++) {
+				if (x * x + y * y + z * z <= MaxSquared) CountPerShell[size_t(x * x + y * y + z * z)]++;
+			}
+		}
+	}
+
+	// Counting sort by squared distance, within a shell the offsets stay in x, y, z order
+	Table.ShellEnd.resize(CountPerShell.size());
+	uint32_t Total = 0;
+	for (size_t d = 0; d < CountPerShell.size(); d++) {
+		Total += CountPerShell[d];
+		Table.ShellEnd[d] = Total;
+	}
+
+	Table.Cells.resize(Total);
+	std::vector<uint32_t> Next(CountPerShell.size());
+	for (size_t d = 0; d < Next.size(); d++) Next[d] = Table.ShellEnd[d] - CountPerShell[d];
+	for (int32_t x = -Search_Max_Radius; x <= Search_Max_Radius; x++) {
+		for (int32_t y = -Search_Max_Radius; y <= Search_Max_Radius; y++) {
+			for (int32_t z = -Search_Max_Radius; z <= Search_Max_Radius; z++) {
+				if (x * x + y * y + z * z <= MaxSquared) Table.Cells[Next[size_t(x * x + y * y + z * z)]++] = { int8_t(x), int8_t(y), int8_t(z) };
+			}
+		}
+	}
+	return Table;
+}
+
+const SearchShellTable& GetSearchShells()
+{
+	static const SearchShellTable Table = BuildSearchShells();
+	return Table;
+}
+
+
+
+template<class T>
+constexpr auto absolute(T const& x) {
+	return x < 0 ? -x : x;
+}
+
+constexpr static __forceinline uint64_t rotl(const uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+/*
+*	Every thread draws from its own xoroshiro128+ stream. Streams are handed out from a root stream that is jumped
+*	2^64 steps after each hand-out, so they never overlap. SetRandomSeed reseeds the root and makes every thread pick
+*	up a fresh stream on its next call; the first thread to ask afterwards (normally the tick thread) gets stream 0.
+*/
+struct RandomStream {
+	uint64_t State[2];
+
+	__forceinline uint64_t Next() {
+		const uint64_t s0 = State[0];
+		uint64_t s1 = State[1];
+		const uint64_t result = s0 + s1;
+
+		s1 ^= s0;
+		State[0] = rotl(s0, 24) ^ s1 ^ (s1 << 16); // a, b
+		State[1] = rotl(s1, 37); // c
+
+		return result;
+	}
+
+	// Equivalent to 2^64 calls to Next()
+	void Jump() {
+		static constexpr uint64_t JumpPolynomial[] = { 0xdf900294d8f554a5, 0x170865df4b3201fc };
+
+		uint64_t s0 = 0;
+		uint64_t s1 = 0;
+		for (uint64_t Word : JumpPolynomial) {
+			for (int b = 0; b < 64; b++) {
+				if (Word & (uint64_t(1) << b)) {
+					s0 ^= State[0];
+					s1 ^= State[1];
+				}
+				Next();
+			}
+		}
+		State[0] = s0;
+		State[1] = s1;
+	}
+};
+
+constexpr uint64_t SplitMix64(uint64_t& x) {
+	uint64_t z = (x += 0x9e3779b97f4a7c15);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+constexpr RandomStream MakeRandomStream(uint64_t Seed) {
+	RandomStream Stream = {};
+	Stream.State[0] = SplitMix64(Seed);
+	Stream.State[1] = SplitMix64(Seed);
+	if (Stream.State[0] == 0 && Stream.State[1] == 0) Stream.State[1] = 1;
+	return Stream;
+}
+
+static std::mutex RandomRootMutex;
+static RandomStream RandomRoot;
+static std::atomic<uint32_t> RandomSeedGeneration = 0; // 0 until the root has been seeded
+static constexpr uint32_t No_Random_Generation = UINT32_MAX; // Never a seed generation, so a new thread always picks up a stream
+
+struct ThreadRandomStream {
+	RandomStream Stream;
+	uint32_t Generation = No_Random_Generation;
+};
+static thread_local ThreadRandomStream ThreadRandom;
+
+static void SeedRandomRoot(uint64_t Seed) {
+	RandomRoot = MakeRandomStream(Seed);
+	uint32_t Next = RandomSeedGeneration.load(std::memory_order_relaxed) + 1;
+	if (Next == 0 || Next == No_Random_Generation) Next = 1;
+	RandomSeedGeneration.store(Next, std::memory_order_release);
+}
+
+static void AcquireThreadRandomStream() {
+	std::lock_guard<std::mutex> Lock(RandomRootMutex);
+
+	if (RandomSeedGeneration.load(std::memory_order_relaxed) == 0) {
+		std::random_device rd;
+		SeedRandomRoot((uint64_t(rd()) << 32) ^ rd());
+	}
+
+	ThreadRandom.Stream = RandomRoot;
+	ThreadRandom.Generation = RandomSeedGeneration.load(std::memory_order_relaxed);
+	RandomRoot.Jump();
+}
+
+__forceinline RandomStream& GetThreadRandomStream() {
+	if (ThreadRandom.Generation != RandomSeedGeneration.load(std::memory_order_acquire)) [[unlikely]] {
+		AcquireThreadRandomStream();
+	}
+	return ThreadRandom.Stream;
+}
+
+void SetRandomSeed(uint64_t Seed) {
+	std::lock_guard<std::mutex> Lock(RandomRootMutex);
+	SeedRandomRoot(Seed);
+}
+
+__forceinline uint64_t xoroshiro128p(void) {
+	return GetThreadRandomStream().Next();
+}
+
+template<uint64_t TrueOneInN>
+bool GetRandomBool()
+{
+	static constexpr uint64_t AboveThisTrue = UINT64_MAX - (UINT64_MAX / TrueOneInN);
+
+	return xoroshiro128p() > AboveThisTrue;
+}
+
+template<int32_t Min, int32_t Max>
+int32_t GetRandomInt()
+{
+	static_assert(Max > Min, "Called GetRandomInt with Min larger than Max");
+	static_assert(Max != INT32_MAX, "GetRandomInt Max can't be INT32_MAX. Please reduce Max by at least one");
+
+	static constexpr uint32_t TotalSpan = int64_t(Max) - int64_t(Min);
+	static constexpr uint32_t DivideBy = (UINT32_MAX / (TotalSpan + 1)) + 1;
+
+	if constexpr (TotalSpan == UINT32_MAX) return int32_t(xoroshiro128p());
+	if constexpr (Min == Max) return Min;
+
+	return int32_t(uint32_t(xoroshiro128p()) / DivideBy) + Min;
+}
+
+bool GetRandomBool(uint64_t TrueOneInN)
+{
+	if (TrueOneInN <= 1) return true;
+
+	return xoroshiro128p() > UINT64_MAX - (UINT64_MAX / TrueOneInN);
+}
+
+// Maps the upper 32 bits onto [0, Span) with a multiply instead of a division
+static __forceinline int32_t MapRandomToRange(uint64_t Random, int32_t Min, uint64_t Span) {
+	return int32_t(int64_t(Min) + int64_t(((Random >> 32) * Span) >> 32));
+}
+
+int32_t GetRandomInt(int32_t Min, int32_t Max)
+{
+	if (Max <= Min) return Min;
+
+	return MapRandomToRange(xoroshiro128p(), Min, uint64_t(int64_t(Max) - int64_t(Min)) + 1);
+}
+
+/*
+*	The bulk fills run Random_Fill_Lanes independent xoroshiro128+ generators side by side, seeded from the calling
+*	thread's stream. The lanes have no dependency on each other, so the compiler turns the inner loop into SIMD.
+*/
+static constexpr size_t Random_Fill_Lanes = 8;
+
+template<typename T, typename Mapping>
+static void FillRandomLanes(T* Out, size_t Count, Mapping Map)
+{
+	RandomStream& Source = GetThreadRandomStream();
+
+	if (Count < Random_Fill_Lanes * 4) {
+		for (size_t i = 0; i < Count; i++) Out[i] = Map(Source.Next());
+		return;
+	}
+
+	alignas(64) uint64_t s0[Random_Fill_Lanes];
+	alignas(64) uint64_t s1[Random_Fill_Lanes];
+	for (size_t Lane = 0; Lane < Random_Fill_Lanes; Lane++) {
+		RandomStream LaneStream = MakeRandomStream(Source.Next());
+		s0[Lane] = LaneStream.State[0];
+		s1[Lane] = LaneStream.State[1];
+	}
+
+	size_t i = 0;
+	for (; i + Random_Fill_Lanes <= Count; i += Random_Fill_Lanes) {
+		for (size_t Lane = 0; Lane < Random_Fill_Lanes; Lane++) {
+			const uint64_t a = s0[Lane];
+			const uint64_t b = s1[Lane] ^ a;
+
+			Out[i + Lane] = Map(a + s1[Lane]);
+
+			s0[Lane] = rotl(a, 24) ^ b ^ (b << 16);
+			s1[Lane] = rotl(b, 37);
+		}
+	}
+	for (; i < Count; i++) Out[i] = Map(Source.Next());
+}
+
+void FillRandom(uint64_t* Out, size_t Count)
+{
+	FillRandomLanes(Out, Count, [](uint64_t Random) { return Random; });
+}
+
+void FillRandomInts(int32_t* Out, size_t Count, int32_t Min, int32_t Max)
+{
+	if (Max <= Min) {
+		for (size_t i = 0; i < Count; i++) Out[i] = Min;
+		return;
+	}
+
+	const uint64_t Span = uint64_t(int64_t(Max) - int64_t(Min)) + 1;
+	FillRandomLanes(Out, Count, [Min, Span](uint64_t Random) { return MapRandomToRange(Random, Min, Span); });
+}
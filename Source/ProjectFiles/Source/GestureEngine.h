@@ -0,0 +1,232 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+/*******************************************************
+	Altitude gesture engine.
+
+	Every tick the mod pushes one sample of both hands and the head. Hands count as together when the median of the
+	last three squared hand distances is inside TriggerDistance (no sqrt, and a single noisy sample can't trigger or
+	release). A raw sample with the hands further apart than ReleaseDistance stops the movement on that tick, the
+	median only decides whether the gesture is over. Once together, the platform moves one block straight away and then keeps moving at a rate proportional
+	to how far the right hand is above or below the rise line (RiseOffset below the head). Within DeadZone of the
+	line it holds. A hand kept at FullRateOffset or beyond for FastAfter samples switches to FastRate, which can be
+	several blocks per sample, until it comes back inside FullRateOffset.
+
+	The first block therefore lands one tick after the raw samples first show the hands together and away from the
+	rise line (the median needs a second sample), two if a glitch hides the second one. Update measures this per
+	gesture, see GetLatency.
+
+	Doesn't call into the game, so it also runs in Benchmarks/GestureReplay.cpp.
+*******************************************************/
+
+namespace Gestures {
+
+	using ModAPI::CoordinateInCentimeters;
+
+	inline constexpr int32_t Milliblocks_Per_Block = 1000;
+
+	struct HandSample {
+		int64_t Tick = 0;
+		CoordinateInCentimeters LeftHand;
+		CoordinateInCentimeters RightHand;
+		CoordinateInCentimeters Head;
+	};
+
+	struct Config {
+		int64_t TriggerDistance = 15;		// cm between the hands to start
+		int64_t ReleaseDistance = 20;		// cm between the hands to stop, larger than TriggerDistance so it doesn't flicker
+		int64_t RiseOffset = 52;			// cm below the head, right hand above this climbs and below it descends
+		int64_t DeadZone = 5;				// cm around the rise line that holds the current height
+		int64_t FullRateOffset = 40;		// cm from the rise line at which MaximumRate is reached
+		int32_t MinimumRate = 200;			// milliblocks per tick just outside the dead zone
+		int32_t MaximumRate = 1000;			// milliblocks per tick at FullRateOffset and beyond
+		int32_t FastRate = 1000;			// milliblocks per tick once the hand has stayed at FullRateOffset
+		int64_t FastAfter = 0;				// samples at FullRateOffset before FastRate, 0 never switches
+	};
+
+	// Ticks from the first raw sample that asks for movement to the first block of movement
+	struct LatencyStats {
+		uint64_t Gestures = 0;
+		int64_t TotalTicks = 0;
+		int64_t MinTicks = INT64_MAX;
+		int64_t MaxTicks = 0;
+	};
+
+	// Fixed size ring, index 0 is the newest sample
+	template<typename T, size_t Capacity>
+	class SampleRing
+	{
+	public:
+		void Push(const T& Value)
+		{
+			Newest = (Newest + 1) % Capacity;
+			Items[Newest] = Value;
+			if (Count < Capacity) Count++;
+		}
+
+		const T& operator[](size_t Age) const { return Items[(Newest + Capacity - Age) % Capacity]; }
+		size_t Size() const { return Count; }
+		void Clear() { Count = 0; }
+
+	private:
+		std::array<T, Capacity> Items = {};
+		size_t Newest = Capacity - 1;
+		size_t Count = 0;
+	};
+
+	constexpr int64_t DistanceSquared(const CoordinateInCentimeters& A, const CoordinateInCentimeters& B)
+	{
+		const int64_t X = A.X - B.X;
+		const int64_t Y = A.Y - B.Y;
+		const int64_t Z = int64_t(A.Z) - int64_t(B.Z);
+		return X * X + Y * Y + Z * Z;
+	}
+
+	constexpr int64_t Median3(int64_t A, int64_t B, int64_t C)
+	{
+		return std::max(std::min(A, B), std::min(std::max(A, B), C));
+	}
+
+	class Engine
+	{
+	public:
+		Config Settings;
+
+		// Returns the number of blocks to move the platform this tick, positive is up
+		int Update(const HandSample& Sample)
+		{
+			Derived Next;
+			Next.Tick = Sample.Tick;
+			Next.HandDistanceSquared = DistanceSquared(Sample.LeftHand, Sample.RightHand);
+			Next.RiseOffset = int64_t(Sample.RightHand.Z) - (int64_t(Sample.Head.Z) - Settings.RiseOffset);
+			History.Push(Next);
+
+			const int64_t HandDistanceSquared = Filtered(&Derived::HandDistanceSquared);
+			const int64_t RiseOffset = Filtered(&Derived::RiseOffset);
+
+			// The clock starts on the first raw sample asking for movement. One sample without input (a glitch) doesn't
+			// stop it, two do, as they would turn the median. A gesture whose latency is recorded (INT64_MAX) only ends
+			// after a whole median window without input, so two glitches in a row that make the median let go for a
+			// moment don't count as a new gesture.
+			const bool RawInput = Next.HandDistanceSquared <= Settings.TriggerDistance * Settings.TriggerDistance
+				&& (Next.RiseOffset >= Settings.DeadZone || Next.RiseOffset <= -Settings.DeadZone);
+			if (RawInput) {
+				QuietSamples = 0;
+				if (InputSinceTick < 0) InputSinceTick = Sample.Tick;
+			}
+			else if (++QuietSamples >= Median_Window || (QuietSamples >= Median_Window - 1 && InputSinceTick != INT64_MAX)) {
+				InputSinceTick = -1;
+			}
+
+			if (!Engaged) {
+				if (History.Size() < Median_Window || HandDistanceSquared > Settings.TriggerDistance * Settings.TriggerDistance) return 0;
+				Engaged = true;
+				Direction = 0;
+			}
+			else if (HandDistanceSquared > Settings.ReleaseDistance * Settings.ReleaseDistance) {
+				Release();
+				return 0;
+			}
+
+			// Hands parting stop the platform on the first raw sample that shows it. The median would only see it a
+			// tick later and move one block too many, so it only decides whether the gesture is over (above).
+			if (Next.HandDistanceSquared > Settings.ReleaseDistance * Settings.ReleaseDistance) return 0;
+
+			const int64_t Distance = RiseOffset < 0 ? -RiseOffset : RiseOffset;
+			if (Distance < Settings.DeadZone) return 0;
+
+			const int NewDirection = RiseOffset > 0 ? 1 : -1;
+			if (Distance < Settings.FullRateOffset || NewDirection != Direction) FullRateSamples = 0;
+			else FullRateSamples++;
+
+			if (NewDirection != Direction) {
+				// Starting or reversing moves a block right away, that is what makes the latency fixed
+				Direction = NewDirection;
+				Accumulator = Milliblocks_Per_Block;
+			}
+			else {
+				Accumulator += IsFast() ? Settings.FastRate : RateFor(Distance);
+			}
+
+			const int Steps = int(Accumulator / Milliblocks_Per_Block);
+			Accumulator -= Steps * Milliblocks_Per_Block;
+
+			if (Steps > 0 && InputSinceTick >= 0 && InputSinceTick != INT64_MAX) {
+				RecordLatency(Sample.Tick - InputSinceTick);
+				InputSinceTick = INT64_MAX;
+			}
+			return Steps * Direction;
+		}
+
+		// Call when cloud walking is turned off so an old gesture can't carry over
+		void Reset()
+		{
+			History.Clear();
+			Release();
+			InputSinceTick = -1;
+			QuietSamples = 0;
+		}
+
+		bool IsEngaged() const { return Engaged; }
+		int GetDirection() const { return Direction; }
+		bool IsFast() const { return Settings.FastAfter > 0 && FullRateSamples >= Settings.FastAfter; }
+		const LatencyStats& GetLatency() const { return Latency; }
+
+		// Milliblocks per tick for a hand this far (cm) from the rise line, outside the dead zone
+		int32_t RateFor(int64_t Distance) const
+		{
+			const int64_t Span = std::max<int64_t>(Settings.FullRateOffset - Settings.DeadZone, 1);
+			const int64_t Into = std::clamp<int64_t>(Distance - Settings.DeadZone, 0, Span);
+			return int32_t(Settings.MinimumRate + (int64_t(Settings.MaximumRate) - Settings.MinimumRate) * Into / Span);
+		}
+
+	private:
+		struct Derived {
+			int64_t Tick = 0;
+			int64_t HandDistanceSquared = 0;
+			int64_t RiseOffset = 0;
+		};
+
+		static constexpr size_t History_Length = 16;
+		static constexpr size_t Median_Window = 3;
+
+		SampleRing<Derived, History_Length> History;
+		bool Engaged = false;
+		int Direction = 0;
+		int32_t Accumulator = 0;
+		int64_t FullRateSamples = 0;
+		int64_t InputSinceTick = -1;
+		size_t QuietSamples = 0;
+		LatencyStats Latency;
+
+		// Median of the last three samples, Update doesn't engage before there are three
+		int64_t Filtered(int64_t Derived::* Field) const
+		{
+			if (History.Size() < Median_Window) return History[0].*Field;
+			return Median3(History[0].*Field, History[1].*Field, History[2].*Field);
+		}
+
+		void Release()
+		{
+			Engaged = false;
+			Direction = 0;
+			Accumulator = 0;
+			FullRateSamples = 0;
+		}
+
+		void RecordLatency(int64_t Ticks)
+		{
+			Latency.Gestures++;
+			Latency.TotalTicks += Ticks;
+			Latency.MinTicks = std::min(Latency.MinTicks, Ticks);
+			Latency.MaxTicks = std::max(Latency.MaxTicks, Ticks);
+		}
+	};
+
+	static_assert(Median3(1, 9, 5) == 5 && Median3(9, 1, 5) == 5 && Median3(5, 9, 1) == 5 && Median3(2, 2, 7) == 2);
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <string>
+
+/*******************************************************
+	Host backend policy.
+
+	GameAPI.cpp reaches the host only through Host, a class with one static function per host call. Nothing is
+	virtual, so the choice is made at compile time and every call inlines to whatever the backend does.
+
+	The DLL uses HostBackends::Game, which calls the InternalFunctions pointers that Internals::Init fills in, so
+	it compiles to exactly the calls GameAPI.cpp made before. It is also the only place Mod.cpp and GameAPI.cpp
+	touch Windows.
+
+	A simulator or mock derives from HostBackends::Null, which does nothing and returns defaults, hides the calls
+	it cares about with its own static functions, and is named in CLOUDWALKER_HOST_BACKEND before this header is
+	first included. It can be defined after that, as long as it is complete before GameAPI.cpp is included:
+
+		struct SimulatedHost;
+		#define CLOUDWALKER_HOST_BACKEND SimulatedHost
+		#include "HostBackend.h"
+		struct SimulatedHost : HostBackends::Null { static BlockInfo GetBlock(const CoordinateInBlocks& At); };
+		#include "Mod.cpp"
+		#include "GameAPI.cpp"
+
+	See Benchmarks/SoakTest.cpp.
+*******************************************************/
+
+namespace HostBackends {
+
+	using namespace ModAPI;
+
+	struct Null {
+		static void Log(const wchar_t*) {}
+
+		static BlockInfo GetBlock(const CoordinateInBlocks&) { return BlockInfo(EBlockType::Invalid); }
+		static bool SetBlock(const CoordinateInBlocks&, const BlockInfo&, BlockInfo& OutReplacedType) { OutReplacedType = BlockInfo(EBlockType::Invalid); return false; }
+
+		static void SpawnHintText(const CoordinateInCentimeters&, const wchar_t*, float, float, float) {}
+
+		static CoordinateInCentimeters GetPlayerLocation() { return CoordinateInCentimeters(); }
+		static bool SetPlayerLocation(const CoordinateInCentimeters&) { return false; }
+		static CoordinateInCentimeters GetPlayerLocationHead() { return CoordinateInCentimeters(); }
+		static DirectionVectorInCentimeters GetPlayerViewDirection() { return DirectionVectorInCentimeters(); }
+		static CoordinateInCentimeters GetHandLocation(bool) { return CoordinateInCentimeters(); }
+		static CoordinateInCentimeters GetIndexFingerTipLocation(bool) { return CoordinateInCentimeters(); }
+
+		static void SpawnBlockItem(const CoordinateInCentimeters&, const BlockInfo&) {}
+		static void AddToInventory(const BlockInfo&, uint32_t) {}
+		static void RemoveFromInventory(const BlockInfo&, uint32_t) {}
+
+		static const wchar_t* GetWorldName() { return L""; }
+		static float GetTimeOfDay() { return 1200; }
+		static void SetTimeOfDay(float) {}
+		static void PlayHapticFeedbackOnHand(bool, float, float, float) {}
+		static float GetPlayerHealth() { return 1; }
+		static float SetPlayerHealth(float, bool) { return 1; }
+		static void SpawnBPModActor(const CoordinateInCentimeters&, const wchar_t*, const wchar_t*) {}
+
+		static void SaveModDataString(const wchar_t*, const wchar_t*) {}
+		static bool LoadModDataString(const wchar_t*, wchar_t*&) { return false; }
+		static void SaveModData(const wchar_t*, uint8_t*, uint64_t) {}
+		static uint8_t* LoadModData(const wchar_t*, uint64_t* ArraySizeOut) { *ArraySizeOut = 0; return nullptr; }
+		static void FreeHostMemory(void*) {}
+
+		static void GetThisModSaveFolderPath(const wchar_t*, wchar_t* PathOut) { PathOut[0] = L'\0'; }
+		static GameVersion GetGameVersionNumber() { return GameVersion{ 0, 0, false }; }
+		// ScopedSharedMemoryHandle reads *Pointer even from an invalid handle
+		static SharedMemoryHandleC GetSharedMemoryPointer(const wchar_t*, bool, bool)
+		{
+			static void* NoMemory = nullptr;
+			return SharedMemoryHandleC{ &NoMemory, nullptr, false };
+		}
+		static void ReleaseSharedMemoryPointer(SharedMemoryHandleC&) {}
+
+		// Folder the mod is installed in, with a trailing separator. False if it can't be found.
+		static bool ModuleDirectory(std::wstring&) { return false; }
+	};
+}
+
+#ifndef CLOUDWALKER_HOST_BACKEND
+
+#include "windows.h"
+
+namespace HostBackends {
+
+	struct Game {
+		static void Log(const wchar_t* String) { InternalFunctions::I_Log(String); }
+
+		static BlockInfo GetBlock(const CoordinateInBlocks& At) { return InternalFunctions::I_GetBlock(At); }
+		static bool SetBlock(const CoordinateInBlocks& At, const BlockInfo& BlockType, BlockInfo& OutReplacedType) { return InternalFunctions::I_SetBlock(At, BlockType, OutReplacedType); }
+
+		static void SpawnHintText(const CoordinateInCentimeters& At, const wchar_t* Text, float DurationInSeconds, float SizeMultiplier, float SizeMultiplierVertical)
+		{
+			InternalFunctions::I_SpawnHintText(At, Text, DurationInSeconds, SizeMultiplier, SizeMultiplierVertical);
+		}
+
+		static CoordinateInCentimeters GetPlayerLocation() { return InternalFunctions::I_GetPlayerLocation(); }
+		static bool SetPlayerLocation(const CoordinateInCentimeters& To) { return InternalFunctions::I_SetPlayerLocation(To); }
+		static CoordinateInCentimeters GetPlayerLocationHead() { return InternalFunctions::I_GetPlayerLocationHead(); }
+		static DirectionVectorInCentimeters GetPlayerViewDirection() { return InternalFunctions::I_GetPlayerViewDirection(); }
+		static CoordinateInCentimeters GetHandLocation(bool LeftHand) { return InternalFunctions::I_GetHandLocation(LeftHand); }
+		static CoordinateInCentimeters GetIndexFingerTipLocation(bool LeftHand) { return InternalFunctions::I_GetIndexFingerTipLocation(LeftHand); }
+
+		static void SpawnBlockItem(const CoordinateInCentimeters& At, const BlockInfo& Type) { InternalFunctions::I_SpawnBlockItem(At, Type); }
+		static void AddToInventory(const BlockInfo& Type, uint32_t Amount) { InternalFunctions::I_AddToInventory(Type, Amount); }
+		static void RemoveFromInventory(const BlockInfo& Type, uint32_t Amount) { InternalFunctions::I_RemoveFromInventory(Type, Amount); }
+
+		static const wchar_t* GetWorldName() { return InternalFunctions::I_GetWorldName(); }
+		static float GetTimeOfDay() { return InternalFunctions::I_GetTimeOfDay(); }
+		static void SetTimeOfDay(float NewTime) { InternalFunctions::I_SetTimeOfDay(NewTime); }
+		static void PlayHapticFeedbackOnHand(bool LeftHand, float DurationSeconds, float Frequency, float Amplitude)
+		{
+			InternalFunctions::I_PlayHapticFeedbackOnHand(LeftHand, DurationSeconds, Frequency, Amplitude);
+		}
+		static float GetPlayerHealth() { return InternalFunctions::I_GetPlayerHealth(); }
+		static float SetPlayerHealth(float NewHealth, bool Offset) { return InternalFunctions::I_SetPlayerHealth(NewHealth, Offset); }
+		static void SpawnBPModActor(const CoordinateInCentimeters& At, const wchar_t* ModName, const wchar_t* ActorName)
+		{
+			InternalFunctions::I_SpawnBPModActor(At, ModName, ActorName);
+		}
+
+		static void SaveModDataString(const wchar_t* ModName, const wchar_t* StringIn) { InternalFunctions::I_SaveModDataString(ModName, StringIn); }
+		static bool LoadModDataString(const wchar_t* ModName, wchar_t*& StringOut) { return InternalFunctions::I_LoadModDataString(ModName, StringOut); }
+		static void SaveModData(const wchar_t* ModName, uint8_t* Data, uint64_t ArraySize) { InternalFunctions::I_SaveModData(ModName, Data, ArraySize); }
+		static uint8_t* LoadModData(const wchar_t* ModName, uint64_t* ArraySizeOut) { return InternalFunctions::I_LoadModData(ModName, ArraySizeOut); }
+
+		// LoadModData and LoadModDataString hand over memory the game allocated on the process heap
+		static void FreeHostMemory(void* Memory) { HeapFree(GetProcessHeap(), 0, Memory); }
+
+		static void GetThisModSaveFolderPath(const wchar_t* ModName, wchar_t* PathOut) { InternalFunctions::I_GetThisModSaveFolderPath(ModName, PathOut); }
+		static GameVersion GetGameVersionNumber() { return InternalFunctions::I_GetGameVersionNumber(); }
+		static SharedMemoryHandleC GetSharedMemoryPointer(const wchar_t* Key, bool CreateIfNotExist, bool WaitUntilExist)
+		{
+			return InternalFunctions::I_GetSharedMemoryPointer(Key, CreateIfNotExist, WaitUntilExist);
+		}
+		static void ReleaseSharedMemoryPointer(SharedMemoryHandleC& Handle) { InternalFunctions::I_ReleaseSharedMemoryPointer(Handle); }
+
+		// The folder of the DLL this function was compiled into
+		static bool ModuleDirectory(std::wstring& Out)
+		{
+			wchar_t Path[MAX_PATH];
+			HMODULE Module = NULL;
+
+			if (GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+				(LPCWSTR) &ModuleDirectory, &Module) == 0)
+			{
+				return false;
+			}
+			if (GetModuleFileNameW(Module, Path, MAX_PATH) == 0)
+			{
+				return false;
+			}
+
+			Out = Path;
+			Out = Out.substr(0, Out.find_last_of(L"\\/")) + L"\\";
+			return true;
+		}
+	};
+}
+
+#define CLOUDWALKER_HOST_BACKEND HostBackends::Game
+
+#endif
+
+using Host = CLOUDWALKER_HOST_BACKEND;
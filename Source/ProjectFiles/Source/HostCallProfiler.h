@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*******************************************************
+	Host-call profiler.
+
+	Times every host call made from GameAPI.cpp and files it under the subsystem of the mod that
+	made it. Turned on by compiling with CLOUDWALKER_PROFILE_HOST_CALLS=1 (the "Slow (Debugging)" configuration
+	does). When it is off, PROFILE_SUBSYSTEM and PROFILE_HOST_CALL expand to nothing and LogReport/Reset are empty.
+
+	CLOUDWALKER_COUNT_HOST_CALLS=1 on its own only bumps HostCallCount on every host call, which the tick scheduler
+	and the flight recorder use to count host calls per task and per tick. The profiler implies it. Without either,
+	HostCallCount stays 0 and a host call costs nothing extra.
+
+	Usage:		PROFILE_SUBSYSTEM(Platform);		at the top of a function in Mod.cpp
+				PROFILE_HOST_CALL(GetBlock);		in front of the Host call in GameAPI.cpp
+*******************************************************/
+
+#ifndef CLOUDWALKER_PROFILE_HOST_CALLS
+#define CLOUDWALKER_PROFILE_HOST_CALLS 0
+#endif
+
+#ifndef CLOUDWALKER_COUNT_HOST_CALLS
+#define CLOUDWALKER_COUNT_HOST_CALLS CLOUDWALKER_PROFILE_HOST_CALLS
+#endif
+
+#define HOST_CALL_LIST(X)																										\
+	X(Log) X(GetBlock) X(SetBlock) X(SpawnHintText) X(GetPlayerLocation) X(SetPlayerLocation) X(GetPlayerLocationHead)			\
+	X(GetPlayerViewDirection) X(GetHandLocation) X(GetIndexFingerTipLocation) X(SpawnBlockItem) X(AddToInventory)				\
+	X(RemoveFromInventory) X(GetWorldName) X(GetTimeOfDay) X(SetTimeOfDay) X(PlayHapticFeedbackOnHand) X(GetPlayerHealth)		\
+	X(SetPlayerHealth) X(SpawnBPModActor) X(SaveModDataString) X(LoadModDataString) X(SaveModData) X(LoadModData)				\
+	X(GetThisModSaveFolderPath) X(GetGameVersionNumber) X(GetSharedMemoryPointer) X(ReleaseSharedMemoryPointer)
+
+#define SUBSYSTEM_LIST(X)	X(Other) X(Load) X(Tick) X(Gesture) X(Platform) X(Reconcile) X(Save) X(Tools) X(Operations)
+
+namespace HostProfiler {
+
+	#define HOST_PROFILER_WIDEN(String) L##String
+	#define HOST_PROFILER_ENUM_ENTRY(Name) Name,
+	#define HOST_PROFILER_NAME_ENTRY(Name) HOST_PROFILER_WIDEN(#Name),
+
+	enum class EHostCall : uint8_t { HOST_CALL_LIST(HOST_PROFILER_ENUM_ENTRY) Count };
+	enum class ESubsystem : uint8_t { SUBSYSTEM_LIST(HOST_PROFILER_ENUM_ENTRY) Count };
+
+	inline constexpr const wchar_t* HostCallNames[] = { HOST_CALL_LIST(HOST_PROFILER_NAME_ENTRY) };
+	inline constexpr const wchar_t* SubsystemNames[] = { SUBSYSTEM_LIST(HOST_PROFILER_NAME_ENTRY) };
+
+	#undef HOST_PROFILER_WIDEN
+	#undef HOST_PROFILER_ENUM_ENTRY
+	#undef HOST_PROFILER_NAME_ENTRY
+
+	// Every host call while counting is on, see CLOUDWALKER_COUNT_HOST_CALLS. Tick thread only.
+	inline uint64_t HostCallCount = 0;
+	inline constexpr bool Counts_Host_Calls = CLOUDWALKER_COUNT_HOST_CALLS || CLOUDWALKER_PROFILE_HOST_CALLS;
+
+#if CLOUDWALKER_PROFILE_HOST_CALLS
+
+	// Bucket i counts calls that took less than 2^i nanoseconds (and at least 2^(i-1)), the last one is open ended
+	inline constexpr int Histogram_Buckets = 28;
+
+	struct CallStats {
+		uint64_t Count = 0;
+		uint64_t TotalNanoseconds = 0;
+		uint64_t MaxNanoseconds = 0;
+		uint64_t Buckets[Histogram_Buckets] = {};
+	};
+
+	// Host calls only ever happen on the tick thread, so none of this needs to be atomic
+	inline CallStats Stats[size_t(ESubsystem::Count)][size_t(EHostCall::Count)];
+	inline ESubsystem CurrentSubsystem = ESubsystem::Other;
+
+	struct ScopedSubsystem {
+		ESubsystem Previous;
+
+		explicit ScopedSubsystem(ESubsystem Subsystem) : Previous(CurrentSubsystem) { CurrentSubsystem = Subsystem; }
+		~ScopedSubsystem() { CurrentSubsystem = Previous; }
+	};
+
+	struct ScopedHostCall {
+		EHostCall Call;
+		std::chrono::steady_clock::time_point Start;
+
+		explicit ScopedHostCall(EHostCall Call_) : Call(Call_), Start(std::chrono::steady_clock::now()) { HostCallCount++; }
+
+		~ScopedHostCall() {
+			uint64_t Nanoseconds = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start).count());
+
+			CallStats& Entry = Stats[size_t(CurrentSubsystem)][size_t(Call)];
+			Entry.Count++;
+			Entry.TotalNanoseconds += Nanoseconds;
+			if (Nanoseconds > Entry.MaxNanoseconds) Entry.MaxNanoseconds = Nanoseconds;
+
+			int Bucket = int(std::bit_width(Nanoseconds));
+			Entry.Buckets[Bucket < Histogram_Buckets ? Bucket : Histogram_Buckets - 1]++;
+		}
+	};
+
+	// Upper bound in nanoseconds of the bucket that contains the given percentile
+	inline uint64_t Percentile(const CallStats& Entry, double Fraction) {
+		uint64_t Target = uint64_t(double(Entry.Count) * Fraction);
+		uint64_t Seen = 0;
+		for (int i = 0; i < Histogram_Buckets; i++) {
+			Seen += Entry.Buckets[i];
+			if (Seen > Target) return uint64_t(1) << i;
+		}
+		return Entry.MaxNanoseconds;
+	}
+
+	template<typename LogFunction>
+	void LogReport(LogFunction&& LogLine) {
+		CallStats Snapshot[size_t(ESubsystem::Count)][size_t(EHostCall::Count)];
+		std::copy(&Stats[0][0], &Stats[0][0] + size_t(ESubsystem::Count) * size_t(EHostCall::Count), &Snapshot[0][0]);
+
+		LogLine(std::wstring(L"Host call profile (calls, avg/p50/p99/max in ns):"));
+
+		for (size_t Subsystem = 0; Subsystem < size_t(ESubsystem::Count); Subsystem++) {
+			for (size_t Call = 0; Call < size_t(EHostCall::Count); Call++) {
+				const CallStats& Entry = Snapshot[Subsystem][Call];
+				if (Entry.Count == 0) continue;
+
+				LogLine(std::wstring(L"  ") + SubsystemNames[Subsystem] + L" " + HostCallNames[Call] + L": " + std::to_wstring(Entry.Count)
+					+ L" calls, " + std::to_wstring(Entry.TotalNanoseconds / Entry.Count) + L"/" + std::to_wstring(Percentile(Entry, 0.5))
+					+ L"/" + std::to_wstring(Percentile(Entry, 0.99)) + L"/" + std::to_wstring(Entry.MaxNanoseconds));
+			}
+		}
+	}
+
+	inline void Reset() {
+		for (auto& Row : Stats) {
+			for (auto& Entry : Row) Entry = CallStats();
+		}
+	}
+
+	#define PROFILE_HOST_CALL(Name) HostProfiler::ScopedHostCall HostCallTimer_(HostProfiler::EHostCall::Name)
+	#define PROFILE_SUBSYSTEM(Name) HostProfiler::ScopedSubsystem SubsystemScope_(HostProfiler::ESubsystem::Name)
+
+#else
+
+	template<typename LogFunction>
+	void LogReport(LogFunction&&) {}
+
+	inline void Reset() {}
+
+#if CLOUDWALKER_COUNT_HOST_CALLS
+	#define PROFILE_HOST_CALL(Name) HostProfiler::HostCallCount++
+#else
+	#define PROFILE_HOST_CALL(Name)
+#endif
+	#define PROFILE_SUBSYSTEM(Name)
+
+#endif
+
+}
@@ -70,6 +70,8 @@ void Internals::Init()
 
 	if (!InternalFunctions::I_Log) __debugbreak();
 
+	jobPool.Start();
+
 	Event_OnLoad();
 }
 
@@ -120,6 +122,8 @@ const void Internals::E_Event_Tick()
 
 const void Internals::E_Event_OnLoad()
 {
+	jobPool.Start(); // Joined in Event_OnExit, restart it if a world gets loaded again
+
 	Event_OnLoad();
 }
 
@@ -0,0 +1,276 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*******************************************************
+	Background job pool for pure computation.
+
+	Only the tick thread may call InternalFunctions (everything declared in GameAPI.h), so a Job is split in two:
+	Work runs on a worker thread and must never touch a game function, Complete runs later on the tick thread
+	when CollectCompletedJobs picks the finished job up.
+
+	The tick thread talks to every worker through a pair of lock-free single-producer/single-consumer queues
+	(Inbox: tick -> worker, Outbox: worker -> tick). Workers move their inbox into a local deque that idle
+	workers are allowed to steal from.
+*******************************************************/
+
+namespace Jobs {
+
+	// Lock-free ring buffer for exactly one producer thread and exactly one consumer thread.
+	template<typename T, size_t Capacity>
+	class SPSCQueue
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue Capacity must be a power of two");
+
+	public:
+		bool Push(T&& Item)
+		{
+			const size_t tail = Tail.load(std::memory_order_relaxed);
+			if (tail - Head.load(std::memory_order_acquire) == Capacity) return false;
+
+			Buffer[tail & (Capacity - 1)] = std::move(Item);
+			Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool Pop(T& ItemOut)
+		{
+			const size_t head = Head.load(std::memory_order_relaxed);
+			if (head == Tail.load(std::memory_order_acquire)) return false;
+
+			ItemOut = std::move(Buffer[head & (Capacity - 1)]);
+			Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool IsEmpty() const
+		{
+			return Head.load(std::memory_order_acquire) == Tail.load(std::memory_order_acquire);
+		}
+
+	private:
+		std::array<T, Capacity> Buffer;
+		alignas(64) std::atomic<size_t> Head = 0;
+		alignas(64) std::atomic<size_t> Tail = 0;
+	};
+
+	struct Job
+	{
+		std::function<void()> Work;			// Runs on a worker thread. Must not call any game function.
+		std::function<void()> Complete;		// Runs on the tick thread inside CollectCompletedJobs. Can be empty.
+	};
+
+	struct CompletedJob
+	{
+		std::function<void()> Complete;
+		int64_t WorkMicroseconds = 0;
+	};
+
+	class JobPool
+	{
+	public:
+		static constexpr size_t Queue_Capacity = 64;
+
+		// Event_OnExit joins the pool. A global is destroyed while the DLL unloads, under the loader lock, where
+		// waiting for a worker thread to end can deadlock, so the destructor only checks that nothing is left running.
+		~JobPool() { assert(!IsRunning() && "JobPool destroyed without Join"); }
+
+		// Starts the workers. WorkerCount 0 picks hardware_concurrency - 1, capped to 4 so the game keeps its cores.
+		void Start(unsigned WorkerCount = 0)
+		{
+			if (IsRunning()) return;
+
+			if (WorkerCount == 0) {
+				unsigned hardwareThreads = std::thread::hardware_concurrency();
+				WorkerCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+				if (WorkerCount > 4) WorkerCount = 4;
+			}
+
+			Stopping = false;
+			Pending = 0;
+			RunningWorkers = int(WorkerCount);
+			for (unsigned i = 0; i < WorkerCount; i++) {
+				Workers.push_back(std::make_unique<Worker>());
+			}
+			for (unsigned i = 0; i < WorkerCount; i++) {
+				Workers[i]->Thread = std::thread(&JobPool::WorkerLoop, this, i);
+			}
+		}
+
+		bool IsRunning() const
+		{
+			return !Workers.empty();
+		}
+
+		// Tick thread only. Returns false if the pool isn't running or the chosen inbox is full, the caller should then run the job inline.
+		bool Post(Job&& NewJob)
+		{
+			if (!IsRunning() || Stopping) return false;
+
+			for (size_t attempt = 0; attempt < Workers.size(); attempt++) {
+				Worker& worker = *Workers[NextWorker];
+				NextWorker = (NextWorker + 1) % Workers.size();
+
+				if (worker.Inbox.Push(std::move(NewJob))) {
+					Pending.fetch_add(1, std::memory_order_release);
+					{
+						std::lock_guard<std::mutex> lock(WakeMutex);
+					}
+					WakeCondition.notify_all();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Tick thread only. Runs Complete for every finished job and returns how many microseconds of Work were done off the tick thread.
+		int64_t CollectCompletedJobs()
+		{
+			int64_t offloadedMicroseconds = 0;
+			CompletedJob completed;
+
+			for (auto& worker : Workers) {
+				while (worker->Outbox.Pop(completed)) {
+					offloadedMicroseconds += completed.WorkMicroseconds;
+					if (completed.Complete) completed.Complete();
+				}
+			}
+			return offloadedMicroseconds;
+		}
+
+		// Tick thread only. Lets the workers finish everything already posted, runs the remaining completions and joins the threads.
+		int64_t Join()
+		{
+			if (!IsRunning()) return 0;
+
+			{
+				std::lock_guard<std::mutex> lock(WakeMutex);
+				Stopping = true;
+			}
+			WakeCondition.notify_all();
+
+			// Keep draining, a worker blocks on a full outbox until we make room.
+			int64_t offloadedMicroseconds = 0;
+			while (RunningWorkers.load(std::memory_order_acquire) > 0 || !AllOutboxesEmpty()) {
+				offloadedMicroseconds += CollectCompletedJobs();
+				std::this_thread::yield();
+			}
+
+			for (auto& worker : Workers) {
+				if (worker->Thread.joinable()) worker->Thread.join();
+			}
+			offloadedMicroseconds += CollectCompletedJobs();
+
+			Workers.clear();
+			NextWorker = 0;
+			return offloadedMicroseconds;
+		}
+
+	private:
+		struct Worker
+		{
+			SPSCQueue<Job, Queue_Capacity> Inbox;
+			SPSCQueue<CompletedJob, Queue_Capacity> Outbox;
+
+			std::mutex LocalMutex;
+			std::deque<Job> Local;		// Owner pops from the back, thieves take from the front
+
+			std::thread Thread;
+		};
+
+		bool AllOutboxesEmpty() const
+		{
+			for (auto& worker : Workers) {
+				if (!worker->Outbox.IsEmpty()) return false;
+			}
+			return true;
+		}
+
+		bool TakeJob(size_t Index, Job& JobOut)
+		{
+			Worker& self = *Workers[Index];
+			{
+				std::lock_guard<std::mutex> lock(self.LocalMutex);
+
+				Job incoming;
+				while (self.Inbox.Pop(incoming)) {
+					self.Local.push_back(std::move(incoming));
+				}
+
+				if (!self.Local.empty()) {
+					JobOut = std::move(self.Local.back());
+					self.Local.pop_back();
+					return true;
+				}
+			}
+
+			for (size_t offset = 1; offset < Workers.size(); offset++) {
+				Worker& victim = *Workers[(Index + offset) % Workers.size()];
+
+				std::unique_lock<std::mutex> lock(victim.LocalMutex, std::try_to_lock);
+				if (lock.owns_lock() && !victim.Local.empty()) {
+					JobOut = std::move(victim.Local.front());
+					victim.Local.pop_front();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void WorkerLoop(size_t Index)
+		{
+			Worker& self = *Workers[Index];
+
+			while (true) {
+				Job job;
+				if (TakeJob(Index, job)) {
+					Pending.fetch_sub(1, std::memory_order_acq_rel);
+
+					auto start = std::chrono::steady_clock::now();
+					if (job.Work) job.Work();
+					auto end = std::chrono::steady_clock::now();
+
+					CompletedJob completed;
+					completed.Complete = std::move(job.Complete);
+					completed.WorkMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+					while (!self.Outbox.Push(std::move(completed))) {
+						std::this_thread::yield();
+					}
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(WakeMutex);
+				if (Stopping && Pending.load(std::memory_order_acquire) == 0) break;
+				if (!self.Inbox.IsEmpty()) continue;
+
+				// Jobs sitting in another worker's inbox can't be stolen until that worker moves them to its deque, so only nap briefly
+				WakeCondition.wait_for(lock, std::chrono::milliseconds(1));
+			}
+
+			RunningWorkers.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		std::vector<std::unique_ptr<Worker>> Workers;
+		size_t NextWorker = 0;
+
+		std::mutex WakeMutex;
+		std::condition_variable WakeCondition;
+		bool Stopping = false;
+
+		std::atomic<int64_t> Pending = 0;
+		std::atomic<int> RunningWorkers = 0;
+	};
+
+}
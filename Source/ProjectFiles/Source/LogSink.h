@@ -0,0 +1,230 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/*******************************************************
+	Buffered log sink.
+
+	LOG_INFO(...) and friends format straight into a fixed size entry (no heap allocation) and push it into a
+	lock-free ring, so they are cheap on the tick and safe to use from job workers. Only the tick thread calls
+	into the game to write the log: Drain is called every few ticks and Flush once in Event_OnExit.
+
+	The _EVERY variants are rate limited per call site, messages within IntervalMs of the last one from the same
+	line are counted and the count is added to the next message that gets through.
+
+	Example:	LOG_WARNING_EVERY(5000, L"Could not find the save folder for ", GetWorldName());
+*******************************************************/
+
+namespace LogSink {
+
+	enum class ESeverity : uint8_t { Debug, Info, Warning, Error };
+
+	inline constexpr size_t Entry_Length = 256;
+	inline constexpr size_t Ring_Capacity = 256;
+
+	struct Entry
+	{
+		ESeverity Severity = ESeverity::Info;
+		uint16_t Length = 0;
+		wchar_t Text[Entry_Length];
+
+		void Append(const wchar_t* String)
+		{
+			while (*String && Length < Entry_Length - 1) Text[Length++] = *String++;
+			Text[Length] = 0;
+		}
+
+		void Append(const std::wstring& String) { Append(String.c_str()); }
+		void Append(wchar_t* String) { Append(static_cast<const wchar_t*>(String)); }
+		void Append(bool Value) { Append(Value ? L"true" : L"false"); }
+
+		template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+		void Append(T Value)
+		{
+			wchar_t Digits[24];
+			int Count = 0;
+			bool Negative = false;
+			uint64_t Magnitude;
+
+			if constexpr (std::is_signed_v<T>) {
+				Negative = Value < 0;
+				Magnitude = Negative ? uint64_t(0) - uint64_t(int64_t(Value)) : uint64_t(Value);
+			}
+			else {
+				Magnitude = uint64_t(Value);
+			}
+
+			do {
+				Digits[Count++] = wchar_t(L'0' + Magnitude % 10);
+				Magnitude /= 10;
+			} while (Magnitude != 0);
+
+			if (Negative) Digits[Count++] = L'-';
+
+			while (Count > 0 && Length < Entry_Length - 1) Text[Length++] = Digits[--Count];
+			Text[Length] = 0;
+		}
+	};
+
+	inline const wchar_t* SeverityPrefix(ESeverity Severity)
+	{
+		switch (Severity) {
+		case ESeverity::Debug:		return L"[Cloud Walker][Debug] ";
+		case ESeverity::Info:		return L"[Cloud Walker] ";
+		case ESeverity::Warning:	return L"[Cloud Walker][Warning] ";
+		default:					return L"[Cloud Walker][Error] ";
+		}
+	}
+
+	// Bounded multi-producer ring (Vyukov), single consumer on the tick thread
+	class Ring
+	{
+	public:
+		Ring()
+		{
+			for (size_t i = 0; i < Ring_Capacity; i++) Cells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+
+		bool Push(const Entry& NewEntry)
+		{
+			size_t Position = Tail.load(std::memory_order_relaxed);
+			while (true) {
+				Cell& Target = Cells[Position & (Ring_Capacity - 1)];
+				size_t Sequence = Target.Sequence.load(std::memory_order_acquire);
+				intptr_t Difference = intptr_t(Sequence) - intptr_t(Position);
+
+				if (Difference == 0) {
+					if (Tail.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) {
+						Target.Value = NewEntry;
+						Target.Sequence.store(Position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (Difference < 0) {
+					Dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else {
+					Position = Tail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		bool Pop(Entry& EntryOut)
+		{
+			Cell& Source = Cells[Head & (Ring_Capacity - 1)];
+			if (Source.Sequence.load(std::memory_order_acquire) != Head + 1) return false;
+
+			EntryOut = Source.Value;
+			Source.Sequence.store(Head + Ring_Capacity, std::memory_order_release);
+			Head++;
+			return true;
+		}
+
+		uint64_t TakeDropped()
+		{
+			return Dropped.exchange(0, std::memory_order_relaxed);
+		}
+
+	private:
+		static_assert((Ring_Capacity & (Ring_Capacity - 1)) == 0, "Ring_Capacity must be a power of two");
+
+		struct Cell
+		{
+			std::atomic<size_t> Sequence;
+			Entry Value;
+		};
+
+		std::array<Cell, Ring_Capacity> Cells;
+		alignas(64) std::atomic<size_t> Tail = 0;
+		alignas(64) size_t Head = 0;
+		std::atomic<uint64_t> Dropped = 0;
+	};
+
+	inline Ring Messages;
+
+	struct Site
+	{
+		int64_t IntervalMilliseconds;
+		std::atomic<int64_t> NextAllowed = 0;
+		std::atomic<uint32_t> Suppressed = 0;
+
+		explicit Site(int64_t IntervalMilliseconds_) : IntervalMilliseconds(IntervalMilliseconds_) {}
+	};
+
+	inline int64_t NowMilliseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	template<typename... Args>
+	bool Write(ESeverity Severity, const Args&... Parts)
+	{
+		Entry NewEntry;
+		NewEntry.Severity = Severity;
+		NewEntry.Text[0] = 0;
+		NewEntry.Append(SeverityPrefix(Severity));
+		(NewEntry.Append(Parts), ...);
+
+		return Messages.Push(NewEntry);
+	}
+
+	template<typename... Args>
+	bool WriteRateLimited(Site& CallSite, ESeverity Severity, const Args&... Parts)
+	{
+		int64_t Now = NowMilliseconds();
+		int64_t NextAllowed = CallSite.NextAllowed.load(std::memory_order_relaxed);
+
+		if (Now < NextAllowed || !CallSite.NextAllowed.compare_exchange_strong(NextAllowed, Now + CallSite.IntervalMilliseconds, std::memory_order_relaxed)) {
+			CallSite.Suppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		uint32_t Suppressed = CallSite.Suppressed.exchange(0, std::memory_order_relaxed);
+		if (Suppressed == 0) return Write(Severity, Parts...);
+
+		return Write(Severity, Parts..., L" (", Suppressed, L" more suppressed)");
+	}
+
+	// Tick thread only. Hands at most MaxMessages entries to Emit(ESeverity, const wchar_t*), returns how many were emitted.
+	template<typename EmitFunction>
+	size_t Drain(EmitFunction&& Emit, size_t MaxMessages = SIZE_MAX)
+	{
+		if (uint64_t Dropped = Messages.TakeDropped()) {
+			Entry Notice;
+			Notice.Text[0] = 0;
+			Notice.Append(SeverityPrefix(ESeverity::Warning));
+			Notice.Append(L"log ring full, dropped ");
+			Notice.Append(Dropped);
+			Notice.Append(L" messages");
+			Emit(ESeverity::Warning, Notice.Text);
+		}
+
+		size_t Emitted = 0;
+		Entry Next;
+		while (Emitted < MaxMessages && Messages.Pop(Next)) {
+			Emit(Next.Severity, Next.Text);
+			Emitted++;
+		}
+		return Emitted;
+	}
+
+	template<typename EmitFunction>
+	size_t Flush(EmitFunction&& Emit)
+	{
+		return Drain(Emit);
+	}
+}
+
+#define LOG_DEBUG(...)		LogSink::Write(LogSink::ESeverity::Debug, __VA_ARGS__)
+#define LOG_INFO(...)		LogSink::Write(LogSink::ESeverity::Info, __VA_ARGS__)
+#define LOG_WARNING(...)	LogSink::Write(LogSink::ESeverity::Warning, __VA_ARGS__)
+#define LOG_ERROR(...)		LogSink::Write(LogSink::ESeverity::Error, __VA_ARGS__)
+
+#define LOG_WARNING_EVERY(IntervalMilliseconds, ...)	do { static LogSink::Site LogSite_(IntervalMilliseconds); LogSink::WriteRateLimited(LogSite_, LogSink::ESeverity::Warning, __VA_ARGS__); } while (0)
+#define LOG_ERROR_EVERY(IntervalMilliseconds, ...)		do { static LogSink::Site LogSite_(IntervalMilliseconds); LogSink::WriteRateLimited(LogSite_, LogSink::ESeverity::Error, __VA_ARGS__); } while (0)
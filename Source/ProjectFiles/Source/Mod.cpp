@@ -1,89 +1,266 @@
 #include "GameAPI.h"
+#include "BlockProperties.h"
+#include "BridgeIndex.h"
+#include "CommandRing.h"
+#include "Coroutines.h"
+#include "FlightRecorder.h"
+#include "Footprint.h"
+#include "GestureEngine.h"
+#include "HostCallProfiler.h"
+#include "JobSystem.h"
+#include "LogSink.h"
+#include "Pathfinding.h"
+#include "TickScheduler.h"
+#include "ToolNames.h"
+#include "WorldSlice.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 /************************************************************
 	Config Variables (Set these to whatever you need. They are automatically read by the game.)
 *************************************************************/
-float TickRate = 10;
+float TickRate = 40;
 
 const int Cloud_Walker_Block = 3037;
 const int Height_Calibrator_Block = 3038;
 const int Cloud_Block = 3039;
 const int Minimum_Platform_Radius = 2;
 const int Maximum_Platform_Radius = 4;
-const int World_Max_Height = 720;
-const int World_Min_Height = 0;
-const int Save_Tick_Interval = 10;
-const int Decent_Tick_Interval = 5;
-const int Accent_Tick_Interval = 5;
+const Footprints::Shape Default_Platform_Shape = Footprints::Shape::Disc;	// The original circle, the calibrator hit with an arrow cycles the others
+const bool Single_Plane_Platform = false;	// Two planes, the calibrator hit with a pickaxe switches to one (see GeneratePlatform)
+const int Save_Tick_Interval = 40;
+const int Fall_Guard_Tick_Interval = 1;
+const int Gesture_Tick_Interval = 2;
+const int Platform_Tick_Interval = 4;
+const int Tick_Budget_Microseconds = 4000;
+const double Legacy_Tick_Rate = 10;
 const int Hand_Trigger_Distance_Threshold = 15;
+const int Hand_Release_Distance_Threshold = 20;
 const double Rise_Height_Trigger_Threshold = .30;
+const int Rise_Dead_Zone = 5;
+const int Full_Rate_Rise_Offset = 40;
+const int Minimum_Climb_Rate = 100;	// milliblocks per gesture sample
+const int Maximum_Climb_Rate = 500;	// milliblocks per gesture sample
+const int Fast_Climb_Rate = 3000;	// milliblocks per gesture sample
+const int Fast_Climb_Hold_Samples = 20;
 const int Player_Sunk_Off_Platform_Threshold = -50;
+const int Player_Sinking_Threshold = 15;	// Standing on the platform the player is at 25
+const int Operation_Budget_Microseconds = 1000;
+const int Purge_Radius = 10;
+const int Purge_Batch_Size = 64;
+const int Teleport_Reads_Per_Tick = 64;
+const int Orphan_Sweep_Radius = Maximum_Platform_Radius + 4;
+const int Orphan_Sweep_Height = 12;
+const int Reconcile_Batch_Size = 32;
+const int Bridge_Removal_Batch_Size = 256;
+const int Autopilot_Speed = 10;	// centimeters per tick
+const int Autopilot_Cell_Tests_Per_Step = 4096;
+const int Autopilot_Max_Cached_Bricks = 1024;
+const int Slice_Chunks_Across = 8;	// 128 x 128 blocks around the player
+const int Slice_Chunks_High = 4;	// 64 blocks, half of them under the feet
+const int Slice_Cells_Per_Checkpoint = 256;
+const int Floor_Max_Radius = 8;
+const int Floor_Max_Ticks = int(TickRate) * 60 * 10;	// ten minutes
+const int Floor_Writes_Per_Tick = 256;
+const uint16_t Leftover_Floor_Client = UINT16_MAX;	// floors read back from the save, taken down straight away
+const int Log_Drain_Tick_Interval = 20;
+const int Log_Drain_Max_Messages = 32;
+const int Flight_Dump_Cooldown_Ticks = int(TickRate) * 60;	// a minute per kind of anomaly
 
 bool cloudWalkingEnabled = false;
 int playerHeight = 175;
 int platformRadius = 3;
-int progressToBlock = 0;
-int progressToSave = 0;
 int16_t platformHeight = 0;
+// How far under the top plane the bottom plane is, 1 except during a fast climb up (see RunGestures)
+int platformBottomDrop = 1;
+bool singlePlanePlatform = Single_Plane_Platform;
+uint64_t sinkCatches = 0;
+// Both planes take the footprint for the way the player is moving (see Footprint.h), the disc while standing still
+Footprints::Shape platformShape = Default_Platform_Shape;
+const Footprints::Config footprintConfig{ Platform_Tick_Interval };
+const Footprints::Tables platformFootprints(Minimum_Platform_Radius, Maximum_Platform_Radius, footprintConfig);
+Footprints::MotionTracker platformMotion(footprintConfig);
 
 UniqueID ThisModUniqueIDs[] = { Cloud_Walker_Block, Height_Calibrator_Block, Cloud_Block };
 
+// All block classification goes through this table (see BlockProperties.h)
+constexpr auto blockProperties = BlockProperty::MakeBlockPropertyTable<3>({ {
+	{ Cloud_Walker_Block, BlockProperty::Solid },
+	{ Height_Calibrator_Block, BlockProperty::Solid },
+	{ Cloud_Block, BlockProperty::Cloud | BlockProperty::Transparent },
+} });
+
+// Our own writes make the game fire Event_AnyBlockPlaced/Destroyed too, those must not be treated as external changes
+int ownWriteDepth = 0;
+
+struct OwnWriteScope 
+{
+	OwnWriteScope() { ownWriteDepth++; }
+	~OwnWriteScope() { ownWriteDepth--; }
+};
+
+// The last few hundred ticks, written next to the save when something goes wrong (see FlightRecorder.h)
+FlightRecorder::Recorder flightRecorder(Flight_Dump_Cooldown_Ticks);
+uint64_t flightDumps = 0;
+
 struct Cloud 
 {
 	CoordinateInBlocks location;
 	BlockInfo originalBlock;
 
 	void RestoreBlock() {
-		SetBlock(location, originalBlock);
+		OwnWriteScope ownWrite;
+		if (SetBlock(location, originalBlock)) 
+		{
+			flightRecorder.RecordEdit(FlightRecorder::EditKind::Restored, location, originalBlock);
+			return;
+		}
+		flightRecorder.RecordEdit(FlightRecorder::EditKind::Failed, location, originalBlock);
+		flightRecorder.Flag(FlightRecorder::Anomaly::SetBlockFailed);
 	}
 };
 
 std::vector<Cloud> platformCoords;
 
+// Bounding box of platformCoords, lets the AnyBlock events throw away everything that isn't near the platform
+struct PlatformBounds 
+{
+	CoordinateInBlocks min;
+	CoordinateInBlocks max;
+	bool empty = true;
+
+	bool Contains(CoordinateInBlocks At) const {
+		return !empty && At.X >= min.X && At.X <= max.X && At.Y >= min.Y && At.Y <= max.Y && At.Z >= min.Z && At.Z <= max.Z;
+	}
+};
+PlatformBounds platformBounds;
+bool platformBoundsDirty = false;
+uint64_t externalCloudRemovals = 0;
+uint64_t externalCloudOverwrites = 0;
+
+// What the platform knows about cells in its range without asking the game: a block SetCloudBlock found that can't be
+// replaced, so GeneratePlatformPlane doesn't ask about it again every platform tick, or air left by a block destroyed
+// there, which is worth a write without reading first. Every other cell is read before it is written. Dropped once out
+// of range, or when the game tells us the block there changed.
+enum class KnownCell : uint8_t { Blocked, Air };
+struct KnownCellEntry 
+{
+	CoordinateInBlocks location;
+	KnownCell state;
+};
+std::unordered_map<uint64_t, KnownCellEntry> knownCells;
+CoordinateInBlocks knownCellsCenter;
+
+// Scratch for GeneratePlatformPlane, a lookup per cell instead of a scan of platformCoords
+std::unordered_set<uint64_t> platformCellKeys;
+
+// Clouds loaded from the save that haven't been checked against the world yet, nearest to the player first
+std::vector<Cloud> savedClouds;
+size_t savedCloudsReconciled = 0;
+uint64_t orphanedCloudsSwept = 0;
+// How long reconciliation took, on its own rather than lumped in with the orphan sweep like the operation report
+int reconcileTicks = 0;
+int64_t reconcileMicrosecondsTotal = 0;
+int64_t reconcileMicrosecondsMax = 0;
+
+// In bridge mode the clouds the platform leaves behind stay in the world as a bridge instead of being restored (see BridgeIndex.h)
+bool bridgeMode = false;
+Bridges::Index bridges;
+uint64_t externalBridgeRemovals = 0;
+
+// The autopilot flies the platform to the block last marked with a sledgehammer (see Pathfinding.h). Only a hit while
+// armed marks one, so that mining with a sledgehammer doesn't move the target.
+bool autopilotArmed = false;
+bool autopilotTargetSet = false;
+CoordinateInBlocks autopilotTarget;
+Pathfinding::OccupancyCache occupancy(Autopilot_Max_Cached_Bricks);
+Pathfinding::RouteFollower autopilot;
+CoordinateInBlocks autopilotLastBlock;
+uint64_t autopilotArrivals = 0;
+
+// Temporary floors other mods asked for through the command ring (see CommandRing.h)
+struct ExternalFloor 
+{
+	uint16_t client;
+	uint32_t tag;
+	int64_t expiresAtTick;
+	bool released = false;
+	std::vector<Cloud> clouds;
+};
+CommandRing::Ring commandRing;
+bool commandRingPublished = false;
+std::vector<ExternalFloor> externalFloors;
+int64_t floorTick = 0;
+
+// Jobs too big for one tick run as coroutines over several (see Coroutines.h), starting one cancels the last one of its group
+namespace LongOperation {
+	enum Group : uint32_t { PlatformRemoval, Purge, Teleport, Reconcile, BridgeRemoval, RoutePlanning, SliceCapture };
+}
+Coroutines::Runner operations;
+
+// Altitude control (see GestureEngine.h)
+Gestures::Engine gestureEngine;
+int64_t gestureTick = 0;
+
+// Everything Event_Tick does runs as a task at its own rate (see TickScheduler.h)
+Scheduling::Scheduler scheduler(Tick_Budget_Microseconds, HostProfiler::Counts_Host_Calls ? &HostProfiler::HostCallCount : nullptr);
+size_t fallGuardTask = 0;
+uint64_t fallRescues = 0;
+
+// Background work (see JobSystem.h). Only pure computation and file IO may be posted here, never game functions.
+Jobs::JobPool jobPool;
+bool saveInFlight = false;
+int64_t offloadedMicrosecondsLastTick = 0;
+int64_t offloadedMicrosecondsTotal = 0;
+int64_t ticksMeasured = 0;
+uint64_t toolHitsInWorld[size_t(Tools::Tool::Count)] = {};
+
 // Utility methods
 //********************************
-static bool IsBlockCloudReplacable(CoordinateInBlocks At) 
+static bool IsCloudBlock(const BlockInfo& block) 
 {
-	BlockInfo block = GetBlock(At);
+	return blockProperties.Is(block, BlockProperty::Cloud);
+}
 
-	if (block.Type == EBlockType::Air
-		|| block.Type == EBlockType::GrassFoliage
-		|| block.Type == EBlockType::Flower1
-		|| block.Type == EBlockType::Flower2
-		|| block.Type == EBlockType::Flower3
-		|| block.Type == EBlockType::Flower4
-		|| block.Type == EBlockType::FlowerRainbow)
+bool IsFloorCloud(CoordinateInBlocks location) 
+{
+	for (const ExternalFloor& floor : externalFloors) 
 	{
-		return true;
+		for (const Cloud& cloud : floor.clouds) 
+		{
+			if (cloud.location == location) return true;
+		}
 	}
 	return false;
 }
 
-std::wstring GetFilePath() 
+// Writes buffered LogSink messages to the game log, tick thread only
+size_t DrainLog(size_t maxMessages) 
 {
-	wchar_t path[MAX_PATH];
-	HMODULE hm = NULL;
+	return LogSink::Drain([](LogSink::ESeverity /*severity*/, const wchar_t* text) { Log(text); }, maxMessages);
+}
 
-	if (GetModuleHandleEx(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
-		GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-		(LPCWSTR)&IsBlockCloudReplacable, &hm) == 0)
-	{
-		Log(L"Failed");
+void FlushLog() 
+{
+	LogSink::Flush([](LogSink::ESeverity /*severity*/, const wchar_t* text) { Log(text); });
+}
 
-	}
-	if (GetModuleFileNameW(hm, path, sizeof(path)) == 0)
+// The save file sits next to the mod DLL
+std::wstring GetFilePath() 
+{
+	std::wstring folder = GetThisModInstallFolderPath();
+	if (folder == L"Error") 
 	{
-		Log(L"Failed");
+		LOG_ERROR_EVERY(60000, L"can't find the mod folder, the save file goes in the working directory");
+		folder.clear();
 	}
-	
-	std::wstring p = path;
-	size_t found = p.find_last_of(L"/\\");
-	std::wstring p1 = p.substr(0, found);
-	p1 = p1 + std::wstring(L"\\") + GetWorldName() + L".txt";
-	return p1;
+	return folder + GetWorldName() + L".txt";
 }
 
 CoordinateInBlocks GetBlockUnderPlayerFoot() 
@@ -113,21 +290,77 @@ std::vector<CoordinateInBlocks> GetAllPointsInCircle(CoordinateInBlocks At, int
 	return circleCords;
 }
 
-int GetDistanceBetweenHands() 
+const Footprints::Footprint& GetPlatformFootprint() 
+{
+	return platformFootprints.Get(platformShape, platformRadius, platformMotion.GetMotion());
+}
+
+std::vector<CoordinateInBlocks> GetAllPointsInFootprint(CoordinateInBlocks At, const Footprints::Footprint& footprint) 
+{
+	std::vector<CoordinateInBlocks> footprintCords;
+	footprintCords.reserve(footprint.Cells.size());
+	for (const Footprints::Offset& cell : footprint.Cells) 
+	{
+		footprintCords.push_back(At + CoordinateInBlocks(cell.X, cell.Y, 0));
+	}
+	return footprintCords;
+}
+
+// The cells of the footprint at its edge in the direction the player is moving, the ones around their block while
+// they stand still
+std::vector<CoordinateInBlocks> GetLeadingEdgePoints(CoordinateInBlocks At, const Footprints::Footprint& footprint) 
 {
-	CoordinateInCentimeters rightHandLocation = GetHandLocation(false);
-	CoordinateInCentimeters leftHandLocation = GetHandLocation(true);
+	std::vector<CoordinateInBlocks> edgeCords;
+	const Footprints::Motion& motion = platformMotion.GetMotion();
+	if (motion.Band == 0) 
+	{
+		for (int y = -1; y <= 1; y++) 
+		{
+			for (int x = -1; x <= 1; x++) 
+			{
+				if (footprint.Contains(x, y)) edgeCords.push_back(At + CoordinateInBlocks(x, y, 0));
+			}
+		}
+		return edgeCords;
+	}
 
-	int64_t distanceX = rightHandLocation.X - leftHandLocation.X;
-	int64_t distanceY = rightHandLocation.Y - leftHandLocation.Y;
-	int16_t distanceZ = rightHandLocation.Z - leftHandLocation.Z;
+	const double angle = Footprints::HeadingAngle(motion.Heading);
+	const int stepX = int(std::lround(std::cos(angle)));
+	const int stepY = int(std::lround(std::sin(angle)));
+	for (const Footprints::Offset& cell : footprint.Cells) 
+	{
+		if (cell.X * stepX + cell.Y * stepY < 0 || footprint.Contains(cell.X + stepX, cell.Y + stepY)) continue;
+		edgeCords.push_back(At + CoordinateInBlocks(cell.X, cell.Y, 0));
+	}
+	return edgeCords;
+}
 
-	return sqrt((distanceX * distanceX) + (distanceY * distanceY) + (distanceZ * distanceZ));
+Gestures::HandSample SampleHands() 
+{
+	PROFILE_SUBSYSTEM(Gesture);
+	Gestures::HandSample sample;
+	sample.Tick = gestureTick++;
+	sample.LeftHand = GetHandLocation(true);
+	sample.RightHand = GetHandLocation(false);
+	sample.Head = GetPlayerLocationHead();
+	flightRecorder.RecordHands(sample.LeftHand, sample.RightHand, sample.Head);
+	return sample;
 }
 
-bool IsHandAboveRiseThreshold() 
+// Needs to run again whenever playerHeight changes
+void ConfigureGestures() 
 {
-	return GetHandLocation(false).Z >= GetPlayerLocationHead().Z - (playerHeight * Rise_Height_Trigger_Threshold);
+	Gestures::Config config;
+	config.TriggerDistance = Hand_Trigger_Distance_Threshold;
+	config.ReleaseDistance = Hand_Release_Distance_Threshold;
+	config.RiseOffset = int64_t(playerHeight * Rise_Height_Trigger_Threshold);
+	config.DeadZone = Rise_Dead_Zone;
+	config.FullRateOffset = Full_Rate_Rise_Offset;
+	config.MinimumRate = Minimum_Climb_Rate;
+	config.MaximumRate = Maximum_Climb_Rate;
+	config.FastRate = Fast_Climb_Rate;
+	config.FastAfter = Fast_Climb_Hold_Samples;
+	gestureEngine.Settings = config;
 }
 
 // File Methods
@@ -192,35 +425,154 @@ Cloud StringToBlockCoord(std::string text)
 	return Cloud(coord, block);
 }
 
-std::string PlatformToString() 
+std::string PlatformToString(const std::vector<Cloud>& clouds) 
 {
 	std::string platformString;
-	for (int i = 0; i <= platformCoords.size(); i++) 
+	for (size_t i = 0; i < clouds.size(); i++) 
 	{
-		platformString += BlockCordToString(platformCoords[i]) + std::string("\n");
+		platformString += BlockCordToString(clouds[i]) + std::string("\n");
 	}
 	return platformString;
 }
 
-void SaveData() 
+// One line per run of bridge cells along X: "bridge x,y,z length type"
+std::string BridgeRunsToString(const std::vector<std::shared_ptr<const Bridges::RunList>>& chunks) 
+{
+	std::string bridgeString;
+	for (const std::shared_ptr<const Bridges::RunList>& runs : chunks) 
+	{
+		for (const Bridges::Run& run : *runs) 
+		{
+			bridgeString += "bridge " + CoordinateToString(run.Start) + " " + std::to_string(run.Length) + " " + BlockInfoToString(run.Original) + "\n";
+		}
+	}
+	return bridgeString;
+}
+void StringToBridgeRun(std::string text) 
+{
+	text.erase(0, text.find(' ') + 1);
+	size_t pos = text.find(' ');
+	CoordinateInBlocks start = StringToCoordinate(text.substr(0, pos));
+	text.erase(0, pos + 1);
+
+	pos = text.find(' ');
+	int length = std::stoi(text.substr(0, pos));
+	BlockInfo original = StringToBlockInfo(text.substr(pos + 1));
+
+	for (int i = 0; i < length; i++) 
+	{
+		bridges.Add(start + CoordinateInBlocks(i, 0, 0), original);
+	}
+}
+
+// Runs on a job worker, must not call any game function
+void WriteSaveFile(const std::wstring& path, int height, bool enabled, int radius, Footprints::Shape shape, bool singlePlane, const std::vector<Cloud>& clouds,
+	bool bridging, const std::vector<std::shared_ptr<const Bridges::RunList>>& bridgeRuns, bool hasTarget, CoordinateInBlocks target,
+	const std::vector<Cloud>& floorClouds) 
 {
+	std::string contents = std::to_string(height) + "\n";
+	contents += BoolToString(enabled) + "\n";
+	contents += std::to_string(radius) + "\n";
+	contents += "footprint " + std::to_string(int(shape)) + "\n";
+	if (singlePlane)
+		contents += "single-plane 1\n";
+	if (clouds.size() > 0)
+		contents += PlatformToString(clouds);
+	if (bridging)
+		contents += "bridge-mode 1\n";
+	contents += BridgeRunsToString(bridgeRuns);
+	if (hasTarget)
+		contents += "autopilot-target " + CoordinateToString(target) + "\n";
+	for (const Cloud& cloud : floorClouds)
+		contents += "floor " + BlockCordToString(cloud) + "\n";
+
 	std::fstream saveFile;
-	saveFile.open(GetFilePath(), std::ios::out);
+	saveFile.open(std::filesystem::path(path), std::ios::out);
 	if (saveFile.is_open()) 
 	{
-		saveFile << std::to_string(playerHeight) + "\n";
-		saveFile << BoolToString(cloudWalkingEnabled) + "\n";
-		saveFile << std::to_string(platformRadius) + "\n";
-		if(platformCoords.size() > 0)
-			saveFile << PlatformToString();
+		saveFile << contents;
 		saveFile.close();
 	}
 }
 
+void SaveData() 
+{
+	PROFILE_SUBSYSTEM(Save);
+	// The previous save is still being written, the next interval will pick up the changes
+	if (saveInFlight) return;
+	auto snapshotStart = std::chrono::steady_clock::now();
+
+	// Snapshot everything on the tick thread, GetFilePath needs GetWorldName
+	std::wstring path = GetFilePath();
+	int height = playerHeight;
+	bool enabled = cloudWalkingEnabled;
+	int radius = platformRadius;
+	Footprints::Shape shape = platformShape;
+	bool singlePlane = singlePlanePlatform;
+
+	// Saved clouds that are still waiting for reconciliation must survive this save too
+	std::vector<Cloud> clouds = platformCoords;
+	clouds.insert(clouds.end(), savedClouds.begin() + savedCloudsReconciled, savedClouds.end());
+
+	// Only chunks that changed since the last save get encoded again, the rest are shared with it
+	bool bridging = bridgeMode;
+	std::vector<std::shared_ptr<const Bridges::RunList>> bridgeRuns = bridges.SnapshotRuns();
+	bool hasTarget = autopilotTargetSet;
+	CoordinateInBlocks target = autopilotTarget;
+
+	// Floors other mods asked for are only temporary, after a crash they are taken down again
+	std::vector<Cloud> floorClouds;
+	for (const ExternalFloor& floor : externalFloors) 
+	{
+		floorClouds.insert(floorClouds.end(), floor.clouds.begin(), floor.clouds.end());
+	}
+
+	flightRecorder.Now().SaveSnapshotMicroseconds = int32_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - snapshotStart).count());
+
+	// The worker times the write, the flight recorder gets it on the tick the job completes
+	std::shared_ptr<int64_t> writeMicroseconds = std::make_shared<int64_t>(0);
+	Jobs::Job saveJob;
+	saveJob.Work = [path, height, enabled, radius, shape, singlePlane, clouds, bridging, bridgeRuns, hasTarget, target, floorClouds, writeMicroseconds]() {
+		auto writeStart = std::chrono::steady_clock::now();
+		WriteSaveFile(path, height, enabled, radius, shape, singlePlane, clouds, bridging, bridgeRuns, hasTarget, target, floorClouds);
+		*writeMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - writeStart).count();
+	};
+	saveJob.Complete = [writeMicroseconds]() {
+		saveInFlight = false;
+		flightRecorder.Now().SaveWriteMicroseconds = int32_t(*writeMicroseconds);
+	};
+
+	saveInFlight = true;
+	if (!jobPool.Post(std::move(saveJob))) 
+	{
+		saveInFlight = false;
+		auto writeStart = std::chrono::steady_clock::now();
+		WriteSaveFile(path, height, enabled, radius, shape, singlePlane, clouds, bridging, bridgeRuns, hasTarget, target, floorClouds);
+		flightRecorder.Now().SaveWriteMicroseconds = int32_t(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - writeStart).count());
+	}
+}
+
 void LoadData() 
 {
+	PROFILE_SUBSYSTEM(Load);
+	bridges.Clear();
+	bridgeMode = false;
+	platformShape = Default_Platform_Shape;
+	singlePlanePlatform = Single_Plane_Platform;
+	autopilotArmed = false;
+	autopilotTargetSet = false;
+	autopilot = Pathfinding::RouteFollower();
+
+	// Floors still up from before a reload come down straight away, with the ones read back from the save
+	ExternalFloor leftoverFloor{ Leftover_Floor_Client, 0, 0, false, {} };
+	for (const ExternalFloor& floor : externalFloors) 
+	{
+		leftoverFloor.clouds.insert(leftoverFloor.clouds.end(), floor.clouds.begin(), floor.clouds.end());
+	}
+	externalFloors.clear();
+
 	std::fstream saveFile;
-	saveFile.open(GetFilePath(), std::ios::in);
+	saveFile.open(std::filesystem::path(GetFilePath()), std::ios::in);
 	if (saveFile.is_open()) 
 	{
 		std::string line;
@@ -235,11 +587,41 @@ void LoadData()
 
 		while (std::getline(saveFile, line)) 
 		{
-			platformCoords.push_back(StringToBlockCoord(line));
+			if (line.rfind("bridge-mode ", 0) == 0) 
+			{
+				bridgeMode = true;
+			}
+			else if (line.rfind("footprint ", 0) == 0) 
+			{
+				platformShape = Footprints::Shape(std::clamp(std::stoi(line.substr(line.find(' ') + 1)), 0, int(Footprints::Shape::Count) - 1));
+			}
+			else if (line.rfind("single-plane ", 0) == 0) 
+			{
+				singlePlanePlatform = true;
+			}
+			else if (line.rfind("bridge ", 0) == 0) 
+			{
+				StringToBridgeRun(line);
+			}
+			else if (line.rfind("autopilot-target ", 0) == 0) 
+			{
+				autopilotTarget = StringToCoordinate(line.substr(line.find(' ') + 1));
+				autopilotTargetSet = true;
+			}
+			else if (line.rfind("floor ", 0) == 0) 
+			{
+				leftoverFloor.clouds.push_back(StringToBlockCoord(line.substr(line.find(' ') + 1)));
+			}
+			else 
+			{
+				savedClouds.push_back(StringToBlockCoord(line));
+			}
 		}
 
 		saveFile.close();
 	}
+
+	if (!leftoverFloor.clouds.empty()) externalFloors.push_back(std::move(leftoverFloor));
 }
 
 // Height Calibration
@@ -255,6 +637,7 @@ bool SetPlayerHeightFromCalibrator(CoordinateInBlocks calibratorLocation) {
 	else 
 	{
 		playerHeight = newPlayerHeight;
+		ConfigureGestures();
 		SpawnHintText(calibratorLocation + CoordinateInBlocks(0, 0, 1), L"Calibration Sucessful.", 1, 1);
 		return true;
 	}
@@ -262,72 +645,335 @@ bool SetPlayerHeightFromCalibrator(CoordinateInBlocks calibratorLocation) {
 
 // Platform Control Methods
 //********************************
-void RemovePlatform() 
+void UpdatePlatformBounds() 
+{
+	platformBounds.empty = platformCoords.empty();
+	if (platformBounds.empty) return;
+
+	platformBounds.min = platformCoords[0].location;
+	platformBounds.max = platformCoords[0].location;
+	for (size_t i = 1; i < platformCoords.size(); i++) 
+	{
+		const CoordinateInBlocks& location = platformCoords[i].location;
+		platformBounds.min = CoordinateInBlocks(std::min(platformBounds.min.X, location.X), std::min(platformBounds.min.Y, location.Y), std::min(platformBounds.min.Z, location.Z));
+		platformBounds.max = CoordinateInBlocks(std::max(platformBounds.max.X, location.X), std::max(platformBounds.max.Y, location.Y), std::max(platformBounds.max.Z, location.Z));
+	}
+}
+
+// Forgets a cloud the player changed, so we never restore over whatever is there now
+bool ForgetCloudAt(CoordinateInBlocks location) 
 {
-	for (int i = 0; i < platformCoords.size(); i++) 
+	for (size_t i = 0; i < platformCoords.size(); i++) 
 	{
-		platformCoords[i].RestoreBlock();
+		if (platformCoords[i].location == location) 
+		{
+			platformCoords[i] = platformCoords.back();
+			platformCoords.pop_back();
+			platformBoundsDirty = true;
+			return true;
+		}
 	}
-	platformCoords.clear();
+	return false;
 }
 
-void SetCloudBlock(CoordinateInBlocks location) 
+Coroutines::Operation RemovePlatform() 
 {
-	BlockInfo currentBlock = GetAndSetBlock(location, Cloud_Block);
-	platformCoords.push_back( Cloud(location, currentBlock));
+	knownCells.clear();
+	while (!platformCoords.empty()) 
+	{
+		platformCoords.back().RestoreBlock();
+		platformCoords.pop_back();
+		platformBoundsDirty = true;
+		co_await operations.Checkpoint();
+	}
 }
 
-void PruneOldClouds(CoordinateInBlocks centerBlock) 
+uint64_t CellKey(CoordinateInBlocks location) 
 {
-	if (platformCoords.size() != 0) {
-		for (int i = 0; i < platformCoords.size(); i++) {
-			bool IsOnAcceptableZLevel = platformCoords[i].location.Z == centerBlock.Z || platformCoords[i].location.Z == centerBlock.Z - 1;
+	return (uint64_t(location.X) & 0xFFFFFF) | ((uint64_t(location.Y) & 0xFFFFFF) << 24) | (uint64_t(uint16_t(location.Z)) << 48);
+}
 
-			if (!IsOnAcceptableZLevel ||
-				!IsPointInCircle(centerBlock.X, centerBlock.Y, platformRadius, platformCoords[i].location.X, platformCoords[i].location.Y)) 
-			{
+bool IsKnownCell(CoordinateInBlocks location, KnownCell state) 
+{
+	auto found = knownCells.find(CellKey(location));
+	return found != knownCells.end() && found->second.state == state;
+}
 
-				platformCoords[i].RestoreBlock();
-				platformCoords.erase(platformCoords.begin() + i);
-			}
-		}
+// Without expectAir the cell is read first, only a cell known to be air is worth the write that might have to be undone
+bool SetCloudBlock(CoordinateInBlocks location, bool expectAir) 
+{
+	OwnWriteScope ownWrite;
+	BlockInfo currentBlock;
+	uint64_t failedBefore = GetPlaceIfReplaceableStats().Failed;
+	bool placed = PlaceIfReplaceable(location, Cloud_Block, [](const BlockInfo& block) {
+		return blockProperties.Is(block, BlockProperty::Replaceable);
+	}, currentBlock, expectAir);
+
+	if (placed) 
+	{
+		knownCells.erase(CellKey(location));
+		platformCoords.push_back( Cloud(location, currentBlock));
+		platformBoundsDirty = true;
+		flightRecorder.RecordEdit(FlightRecorder::EditKind::Placed, location, currentBlock);
+	}
+	else if (GetPlaceIfReplaceableStats().Failed != failedBefore) 
+	{
+		flightRecorder.RecordEdit(FlightRecorder::EditKind::Failed, location, Cloud_Block);
+		flightRecorder.Flag(FlightRecorder::Anomaly::SetBlockFailed);
+	}
+	// A chunk that isn't loaded reads as Invalid, and nothing tells us when it loads
+	else if (currentBlock.Type != EBlockType::Invalid) 
+	{
+		knownCells[CellKey(location)] = KnownCellEntry{ location, KnownCell::Blocked };
+	}
+	return placed;
+}
+
+bool IsCloudInPlatform(CoordinateInBlocks location) 
+{
+	for (size_t i = 0; i < platformCoords.size(); i++) 
+	{
+		if (platformCoords[i].location == location) return true;
 	}
+	return false;
+}
+
+bool IsInPlatformRange(CoordinateInBlocks centerBlock, CoordinateInBlocks location) 
+{
+	bool IsOnAcceptableZLevel = location.Z == centerBlock.Z || location.Z == centerBlock.Z - platformBottomDrop;
+
+	return IsOnAcceptableZLevel && GetPlatformFootprint().Contains(location.X - centerBlock.X, location.Y - centerBlock.Y);
 }
-void GeneratePlatformPlane(std::vector<CoordinateInBlocks> coords) 
+
+void PruneOldClouds(CoordinateInBlocks centerBlock) 
 {
-	for (int i = 0; i < coords.size(); i++) 
+	// Only advance when nothing was removed, the cloud moved into slot i still has to be checked
+	for (size_t i = 0; i < platformCoords.size();) 
 	{
-		BlockInfo currentBlock = GetBlock(coords[i]);
-		if (IsBlockCloudReplacable(coords[i])) 
+		if (IsInPlatformRange(centerBlock, platformCoords[i].location)) 
 		{
-			SetCloudBlock(coords[i]);
+			i++;
+			continue;
 		}
+
+		if (bridgeMode) bridges.Add(platformCoords[i].location, platformCoords[i].originalBlock);
+		else platformCoords[i].RestoreBlock();
+		platformCoords[i] = platformCoords.back();
+		platformCoords.pop_back();
+		platformBoundsDirty = true;
+	}
+
+	knownCellsCenter = centerBlock;
+	for (auto known = knownCells.begin(); known != knownCells.end();) 
+	{
+		if (IsInPlatformRange(centerBlock, known->second.location)) ++known;
+		else known = knownCells.erase(known);
+	}
+}
+void GeneratePlatformPlane(const std::vector<CoordinateInBlocks>& coords) 
+{
+	platformCellKeys.clear();
+	for (const Cloud& cloud : platformCoords) platformCellKeys.insert(CellKey(cloud.location));
+
+	for (const CoordinateInBlocks& location : coords) 
+	{
+		// Cells kept by PruneOldClouds are already ours, and blocked ones are still blocked, no need to ask the game about them
+		if (platformCellKeys.count(CellKey(location)) > 0 || IsKnownCell(location, KnownCell::Blocked)) continue;
+
+		SetCloudBlock(location, IsKnownCell(location, KnownCell::Air));
 	}
 }
 
 void GeneratePlatform(CoordinateInBlocks centerBlock) 
 {
-	std::vector newPlatformTopPlaneCoords = GetAllPointsInCircle(centerBlock, platformRadius);
-	std::vector newPlatformBottomPlaneCoords = GetAllPointsInCircle(centerBlock - CoordinateInBlocks(0,0,1), platformRadius);
+	PROFILE_SUBSYSTEM(Platform);
+	const Footprints::Footprint& footprint = GetPlatformFootprint();
+	std::vector newPlatformTopPlaneCoords = GetAllPointsInFootprint(centerBlock, footprint);
 
 	PruneOldClouds(centerBlock);
 
-	GeneratePlatformPlane(newPlatformBottomPlaneCoords);
+	// With a single plane, the cells of the bottom plane that are already there stay while they are in range (the old
+	// top plane after a climb, or cells CatchSinkingPlayer put in), but new ones only go in ahead of a descent
+	CoordinateInBlocks bottomCenter = centerBlock - CoordinateInBlocks(0, 0, int16_t(platformBottomDrop));
+	if (!singlePlanePlatform) GeneratePlatformPlane(GetAllPointsInFootprint(bottomCenter, footprint));
+	else if (gestureEngine.IsEngaged() && gestureEngine.GetDirection() < 0) GeneratePlatformPlane(GetLeadingEdgePoints(bottomCenter, footprint));
 	GeneratePlatformPlane(newPlatformTopPlaneCoords);
 }
 
-void PurgeClouds(CoordinateInBlocks At)
+// Single plane mode has nothing under the top plane to land on, so a player going down through it (a cell broken
+// under them, or walking off the edge) gets the cells around their feet one block down before they sink as far as
+// Player_Sunk_Off_Platform_Threshold. The fall guard then moves the platform down onto them, as with two planes.
+void CatchSinkingPlayer(CoordinateInBlocks blockUnderFoot) 
+{
+	CoordinateInBlocks centerBlock(blockUnderFoot.X, blockUnderFoot.Y, platformHeight);
+	bool caught = false;
+	for (int y = -1; y <= 1; y++) 
+	{
+		for (int x = -1; x <= 1; x++) 
+		{
+			CoordinateInBlocks cell(blockUnderFoot.X + x, blockUnderFoot.Y + y, int16_t(platformHeight - platformBottomDrop));
+			if (!IsInPlatformRange(centerBlock, cell) || IsCloudInPlatform(cell) || IsKnownCell(cell, KnownCell::Blocked)) continue;
+			caught = SetCloudBlock(cell, IsKnownCell(cell, KnownCell::Air)) || caught;
+		}
+	}
+	if (caught) 
+	{
+		sinkCatches++;
+		flightRecorder.Now().Flags |= FlightRecorder::Caught;
+	}
+}
+
+Coroutines::Operation PurgeClouds(CoordinateInBlocks At)
+{
+	co_await RemovePlatform();
+
+	BlockSearch search;
+	std::vector<CoordinateInBlocks> clouds;
+	while (!search.Finished) 
+	{
+		clouds.clear();
+		FindAllWithin(At, Purge_Radius, blockProperties.Matching(BlockProperty::Cloud), clouds, SIZE_MAX, SearchShape::Ball, search, Purge_Batch_Size);
+
+		{
+			OwnWriteScope ownWrite;
+			for (const CoordinateInBlocks& cloud : clouds) 
+			{
+				// The platform task may have rebuilt the platform since RemovePlatform, those cells stay
+				if (IsCloudInPlatform(cloud)) continue;
+
+				SetBlock(cloud, EBlockType::Air);
+				bridges.Remove(cloud);
+			}
+		}
+		co_await operations.Checkpoint();
+	}
+}
+
+// Saved Cloud Reconciliation
+//********************************
+// Checks saved clouds against the world a batch at a time, nearest first, for as many ticks as it takes.
+// Clouds that are still in place either become part of the platform again or get restored, anything else was changed while we were away and is left alone.
+Coroutines::Operation ReconcileSavedClouds() 
+{
+	size_t savedCloudCount = savedClouds.size();
+	uint64_t lastTick = 0;
+	int64_t tickMicroseconds = 0;
+	reconcileTicks = 0;
+	reconcileMicrosecondsTotal = 0;
+	reconcileMicrosecondsMax = 0;
+
+	while (savedCloudsReconciled < savedClouds.size()) 
+	{
+		// A checkpoint only suspends once the tick is out of budget, so several batches can share a tick
+		auto batchStart = std::chrono::steady_clock::now();
+		if (reconcileTicks == 0 || scheduler.GetTicks() != lastTick) 
+		{
+			lastTick = scheduler.GetTicks();
+			reconcileTicks++;
+			tickMicroseconds = 0;
+		}
+
+		CoordinateInBlocks playerLocation = GetPlayerLocation();
+		CoordinateInBlocks centerBlock = CoordinateInBlocks(playerLocation.X, playerLocation.Y, platformHeight);
+		size_t batchEnd = std::min(savedCloudsReconciled + Reconcile_Batch_Size, savedClouds.size());
+
+		for (; savedCloudsReconciled < batchEnd; savedCloudsReconciled++) 
+		{
+			const Cloud& cloud = savedClouds[savedCloudsReconciled];
+
+			if (cloudWalkingEnabled && IsInPlatformRange(centerBlock, cloud.location)) 
+			{
+				if (!IsCloudInPlatform(cloud.location) && IsCloudBlock(GetBlock(cloud.location))) 
+				{
+					platformCoords.push_back(cloud);
+					platformBoundsDirty = true;
+				}
+			}
+			else if (bridgeMode) 
+			{
+				// Left behind while we were away, so it is part of the bridge now
+				if (IsCloudBlock(GetBlock(cloud.location))) bridges.Add(cloud.location, cloud.originalBlock);
+			}
+			else 
+			{
+				// Puts the original block back only if our cloud is still there
+				OwnWriteScope ownWrite;
+				BlockInfo replacedBlock;
+				PlaceIfReplaceable(cloud.location, cloud.originalBlock, IsCloudBlock, replacedBlock);
+			}
+		}
+
+		int64_t batchMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - batchStart).count();
+		tickMicroseconds += batchMicroseconds;
+		reconcileMicrosecondsTotal += batchMicroseconds;
+		reconcileMicrosecondsMax = std::max(reconcileMicrosecondsMax, tickMicroseconds);
+
+		co_await operations.Checkpoint();
+	}
+
+	LOG_INFO(L"reconciled ", savedCloudCount, L" saved clouds over ", reconcileTicks, L" ticks (", reconcileMicrosecondsTotal, L"us total, ",
+		reconcileMicrosecondsMax, L"us max per tick)");
+
+	savedClouds.clear();
+	savedClouds.shrink_to_fit();
+	savedCloudsReconciled = 0;
+}
+
+// A crash between two saves leaves the clouds placed since the last save in the world with no record of them. They can only be
+// close to where the player was, so once the saved clouds are reconciled every cloud around the player that isn't part of the platform is cleared.
+Coroutines::Operation SweepOrphanedClouds(CoordinateInBlocks playerLocation) 
 {
-	RemovePlatform();
-	auto coords = GetAllCoordinatesInRadius(At, 10);
-	for (int i = 0; i < coords.size(); i++) 
+	uint64_t orphans = 0;
+	std::vector<CoordinateInBlocks> layer = GetAllPointsInCircle(playerLocation, Orphan_Sweep_Radius);
+
+	for (int z = playerLocation.Z - Orphan_Sweep_Height; z <= playerLocation.Z + Orphan_Sweep_Height; z++) 
 	{
-		BlockInfo block = GetBlock(coords[i]);
-		if (block.CustomBlockID == Cloud_Block) 
+		if (z < World_Min_Height || z > World_Max_Height) continue;
+
+		for (size_t i = 0; i < layer.size(); i++) 
 		{
-			SetBlock(coords[i], EBlockType::Air);
+			CoordinateInBlocks location = CoordinateInBlocks(layer[i].X, layer[i].Y, int16_t(z));
+			if (IsCloudBlock(GetBlock(location)) && !IsCloudInPlatform(location) && !bridges.Contains(location) && !IsFloorCloud(location)) 
+			{
+				OwnWriteScope ownWrite;
+				SetBlock(location, EBlockType::Air);
+				orphans++;
+			}
 		}
+		co_await operations.Checkpoint();
 	}
+
+	orphanedCloudsSwept += orphans;
+	if (orphans > 0) 
+	{
+		LOG_WARNING(L"cleared ", orphans, L" clouds that were placed after the last save");
+	}
+}
+
+Coroutines::Operation RecoverSavedClouds(CoordinateInBlocks playerLocation) 
+{
+	co_await ReconcileSavedClouds();
+	co_await SweepOrphanedClouds(playerLocation);
+}
+
+void BeginSavedCloudReconciliation(CoordinateInBlocks playerLocation) 
+{
+	CoordinateInBlocks centerBlock = CoordinateInBlocks(playerLocation.X, playerLocation.Y, platformHeight);
+
+	auto distanceSquared = [centerBlock](const Cloud& cloud) {
+		int64_t x = cloud.location.X - centerBlock.X;
+		int64_t y = cloud.location.Y - centerBlock.Y;
+		int64_t z = cloud.location.Z - centerBlock.Z;
+		return x * x + y * y + z * z;
+	};
+	std::sort(savedClouds.begin(), savedClouds.end(), [&distanceSquared](const Cloud& a, const Cloud& b) {
+		return distanceSquared(a) < distanceSquared(b);
+	});
+
+	savedCloudsReconciled = 0;
+
+	operations.Cancel(LongOperation::Reconcile);
+	operations.Start(L"saved cloud recovery", LongOperation::Reconcile, RecoverSavedClouds(playerLocation));
 }
 
 // Setters and Variable Management
@@ -345,15 +991,33 @@ bool SetPlatformHeight(int16_t newHeight)
 void ToggleCloudWalking(CoordinateInBlocks At) 
 {
 	cloudWalkingEnabled = !cloudWalkingEnabled;
+	gestureEngine.Reset();
+	platformMotion.Reset();
 
+	// Toggling back on stops a removal that is still running, whatever is left of the platform is kept
+	operations.Cancel(LongOperation::PlatformRemoval);
 	if (!cloudWalkingEnabled) 
 	{
-		RemovePlatform();
+		operations.Start(L"platform removal", LongOperation::PlatformRemoval, RemovePlatform());
 	}
 	std::wstring message = (cloudWalkingEnabled) ? L"Cloud Walking Enabled" : L"Cloud Walking Disabled";
 	SpawnHintText(At + CoordinateInBlocks(0, 0, 1), message, 1, 1);
 }
 
+void ToggleBridgeMode(CoordinateInBlocks At) 
+{
+	bridgeMode = !bridgeMode;
+	std::wstring message = bridgeMode ? L"Bridge Mode Enabled" : L"Bridge Mode Disabled";
+	SpawnHintText(At + CoordinateInBlocks(0, 0, 1), message, 1, 1);
+}
+
+void ToggleSinglePlanePlatform(CoordinateInBlocks At) 
+{
+	singlePlanePlatform = !singlePlanePlatform;
+	std::wstring message = singlePlanePlatform ? L"Single Plane Platform Enabled" : L"Single Plane Platform Disabled";
+	SpawnHintText(At + CoordinateInBlocks(0, 0, 1), message, 1, 1);
+}
+
 void CyclePlatformRadius() 
 {
 	platformRadius++;
@@ -363,173 +1027,863 @@ void CyclePlatformRadius()
 	}
 }
 
+void CyclePlatformShape(CoordinateInBlocks At) 
+{
+	platformShape = Footprints::Shape((size_t(platformShape) + 1) % size_t(Footprints::Shape::Count));
+	SpawnHintText(At + CoordinateInBlocks(0, 0, 1), std::wstring(L"Platform Shape: ") + Footprints::Shape_Names[size_t(platformShape)], 1, 1);
+}
+
 // Must have access to Setters
 //********************************
-void TeleportToNearestSolidBlockBelow() {
+Coroutines::Operation TeleportToNearestSolidBlockBelow() {
 	CoordinateInBlocks playerLocation = GetPlayerLocation();
-	int i = 0;
-	BlockInfo block;
-	while (true) {
-		if (playerLocation.Z - i <= 0) break;
-		CoordinateInBlocks coord = CoordinateInBlocks(playerLocation.X, playerLocation.Y, playerLocation.Z - i);
-		block = GetBlock(coord);
-		if (block.Type != EBlockType::Air && block.CustomBlockID != Cloud_Block) {
-			SetPlayerLocation(coord + CoordinateInBlocks(0, 0, 1));
-			SetPlatformHeight(coord.Z);
-			break;
-		}
-		i++;
+	BlockSearch search;
+	std::vector<CoordinateInBlocks> ground;
+	while (ground.empty() && !search.Finished) {
+		FindAllWithin(playerLocation, playerLocation.Z - 1, blockProperties.Matching(BlockProperty::Solid), ground, 1, SearchShape::ColumnDown, search, Teleport_Reads_Per_Tick);
+		if (ground.empty()) co_await operations.Checkpoint();
 	}
+	if (ground.empty()) co_return;
+
+	SetPlayerLocation(ground[0] + CoordinateInBlocks(0, 0, 1));
+	SetPlatformHeight(ground[0].Z);
 }
 
-/************************************************************* 
-//	Functions (Run automatically by the game, you can put any code you want into them)
-*************************************************************/
+static bool IsClearForRoute(const CoordinateInBlocks& At) 
+{
+	return blockProperties.Is(GetBlock(At), BlockProperty::Replaceable | BlockProperty::Cloud);
+}
 
+Pathfinding::RouteLimits GetRouteLimits() 
+{
+	Pathfinding::RouteLimits limits;
+	limits.ClearanceAbove = (playerHeight + 49) / 50;
+	limits.MinHeight = World_Min_Height;
+	limits.MaxHeight = World_Max_Height;
+	return limits;
+}
 
-void Event_BlockHitByTool(CoordinateInBlocks At, UniqueID CustomBlockID, wString ToolName, CoordinateInCentimeters ExactHitLocation, bool ToolHeldByHandLeft)
+// Plans the route a few nodes at a time, reading the world into the occupancy cache only where the search looks
+Coroutines::Operation PlanAutopilotRoute(CoordinateInBlocks start, CoordinateInBlocks goal, CoordinateInBlocks hintAt) 
 {
-	if (CustomBlockID == Cloud_Block) 
+	// A fresh cache for every route, blocks in chunks that were not loaded last time would still be refused
+	occupancy.Clear();
+	Pathfinding::RouteSearch search(start, goal, GetRouteLimits());
+	size_t cellsLoaded = 0;
+
+	Pathfinding::Status status;
+	while ((status = search.Step(occupancy, Autopilot_Cell_Tests_Per_Step)) != Pathfinding::Status::Found && status != Pathfinding::Status::NoRoute) 
 	{
-		if ( ToolName == L"T_Axe_Stone" || ToolName == L"T_Axe_Copper" || ToolName == L"T_Axe_Iron") {
-			PurgeClouds(At);
-		}
-		if (ToolName == L"T_Pickaxe_Stone" || ToolName == L"T_Pickaxe_Copper" || ToolName == L"T_Pickaxe_Iron") {
-			TeleportToNearestSolidBlockBelow();
-		}
-		else if (ToolName == L"T_Arrow") 
+		if (status == Pathfinding::Status::NeedCells) 
 		{
-			CyclePlatformRadius();
-		}
-		else if (ToolName == L"T_Stick")
-		{
-			ToggleCloudWalking(At);
+			cellsLoaded += occupancy.FillTile(search.GetMissingCell(), IsClearForRoute);
 		}
+		co_await operations.Checkpoint();
 	}
 
-	if (CustomBlockID == Height_Calibrator_Block) {
-		if (ToolName == L"T_Stick") 
-		{
-			SetPlayerHeightFromCalibrator(At);
-		}
+	LOG_INFO(L"autopilot route search: ", search.GetExpandedCount(), L" nodes expanded, ", cellsLoaded, L" cells loaded, ",
+		occupancy.GetMemoryBytes() / 1024, L" KB cached, altitude ", search.GetCruiseAltitude(), L" after ", search.GetAltitudesTried(), L" tried");
+	occupancy.Clear();
+
+	if (status == Pathfinding::Status::NoRoute) 
+	{
+		SpawnHintText(hintAt + CoordinateInBlocks(0, 0, 1), search.GetFailure(), 1, 1);
+		co_return;
 	}
 
-	if (CustomBlockID == Cloud_Walker_Block) 
+	autopilot = Pathfinding::RouteFollower(search.GetRoute());
+	autopilotLastBlock = start;
+}
+
+void StopAutopilot() 
+{
+	operations.Cancel(LongOperation::RoutePlanning);
+	autopilot = Pathfinding::RouteFollower();
+}
+
+void MarkAutopilotTarget(CoordinateInBlocks At) 
+{
+	autopilotTarget = At;
+	autopilotTargetSet = true;
+	autopilotArmed = false;
+	SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Autopilot Target Marked", 1, 1);
+}
+
+void ToggleAutopilot(CoordinateInBlocks At) 
+{
+	if (autopilot.IsActive() || operations.IsRunning(LongOperation::RoutePlanning)) 
+	{
+		StopAutopilot();
+		SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Autopilot Disengaged", 1, 1);
+		return;
+	}
+
+	if (!cloudWalkingEnabled) 
+	{
+		SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Cloud Walking is disabled", 1, 1);
+		return;
+	}
+	if (!autopilotTargetSet) 
+	{
+		autopilotArmed = true;
+		SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Autopilot Armed, mark a block with a sledgehammer", 1, 1);
+		return;
+	}
+
+	// Each flight needs a target of its own, the next hit arms the autopilot again
+	autopilotTargetSet = false;
+	CoordinateInBlocks playerLocation = GetPlayerLocation();
+	operations.Start(L"autopilot route", LongOperation::RoutePlanning,
+		PlanAutopilotRoute(CoordinateInBlocks(playerLocation.X, playerLocation.Y, platformHeight), autopilotTarget, At));
+}
+
+static void RestoreBridgeCell(const CoordinateInBlocks& location, const BlockInfo& originalBlock) 
+{
+	// Puts the original block back only if our cloud is still there
+	OwnWriteScope ownWrite;
+	BlockInfo replacedBlock;
+	PlaceIfReplaceable(location, originalBlock, IsCloudBlock, replacedBlock);
+}
+
+// Takes down every bridge cell connected to At
+Coroutines::Operation RemoveBridgeSegment(CoordinateInBlocks At) 
+{
+	Bridges::SegmentRemoval removal(bridges, At);
+	bool done = false;
+	while (!done) 
 	{
-		if (ToolName == L"T_Stick") 
+		done = removal.Step(bridges, Bridge_Removal_Batch_Size, RestoreBridgeCell);
+		co_await operations.Checkpoint();
+	}
+
+	LOG_INFO(L"removed a bridge segment of ", removal.GetRemovedCount(), L" clouds, ", bridges.Size(), L" bridge clouds left");
+}
+
+void StartRemoveBridgeSegment(CoordinateInBlocks At) 
+{
+	if (!bridges.Contains(At)) 
+	{
+		SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Not part of a bridge", 1, 1);
+		return;
+	}
+	operations.Start(L"bridge segment removal", LongOperation::BridgeRemoval, RemoveBridgeSegment(At));
+}
+
+void StartPurgeClouds(CoordinateInBlocks At) 
+{
+	operations.Cancel(LongOperation::Purge);
+	operations.Start(L"cloud purge", LongOperation::Purge, PurgeClouds(At));
+}
+
+void StartTeleportToNearestSolidBlockBelow() 
+{
+	StopAutopilot();
+	operations.Cancel(LongOperation::Teleport);
+	operations.Start(L"teleport to ground", LongOperation::Teleport, TeleportToNearestSolidBlockBelow());
+}
+
+// Runs on a job worker, must not call any game function
+void WriteSliceFile(const std::wstring& path, const Slices::Builder& slice) 
+{
+	std::vector<uint8_t> bytes = slice.Encode();
+
+	std::fstream sliceFile;
+	sliceFile.open(std::filesystem::path(path), std::ios::out | std::ios::binary);
+	if (!sliceFile.is_open()) 
+	{
+		LOG_ERROR(L"can't write the world slice to ", path.c_str());
+		return;
+	}
+	sliceFile.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+	sliceFile.close();
+
+	LOG_INFO(L"world slice: ", slice.GetCellCount(), L" blocks, ", slice.GetPaletteSize(), L" kinds, ", bytes.size() / 1024, L" KB in ", path.c_str());
+	if (slice.GetDroppedCount() > 0) 
+	{
+		LOG_WARNING(L"world slice: ", slice.GetDroppedCount(), L" blocks didn't fit the palette and were saved as Invalid");
+	}
+}
+
+// Reads the world around the player, one chunk of GetAllCoordinatesInBox at a time, into a slice file next to the
+// save file (see WorldSlice.h). Benchmarks/SoakTest.cpp can fly over it instead of its own terrain.
+Coroutines::Operation CaptureWorldSlice(CoordinateInBlocks center) 
+{
+	const int half = Slice_Chunks_Across * Slices::Chunk_Size / 2;
+	const int height = Slice_Chunks_High * Slices::Chunk_Size;
+	const int bottom = std::clamp(int(center.Z) - height / 2, World_Min_Height, World_Max_Height - height);
+	const CoordinateInBlocks origin(center.X - half, center.Y - half, int16_t(bottom));
+	auto slice = std::make_shared<Slices::Builder>(origin, Slice_Chunks_Across, Slice_Chunks_Across, Slice_Chunks_High, center);
+
+	const int chunkHalf = Slices::Chunk_Size / 2;
+	const CoordinateInBlocks chunkExtent(chunkHalf, chunkHalf, int16_t(chunkHalf));
+	size_t cellsRead = 0;
+	for (int z = 0; z < Slice_Chunks_High; z++) 
+	{
+		for (int y = 0; y < Slice_Chunks_Across; y++) 
 		{
-			ToggleCloudWalking(At);
+			for (int x = 0; x < Slice_Chunks_Across; x++) 
+			{
+				CoordinateInBlocks chunkCenter = origin + CoordinateInBlocks(x * Slices::Chunk_Size + chunkHalf, y * Slices::Chunk_Size + chunkHalf,
+					int16_t(z * Slices::Chunk_Size + chunkHalf));
+				for (const CoordinateInBlocks& at : GetAllCoordinatesInBox(chunkCenter, chunkExtent)) 
+				{
+					slice->Set(at, GetBlock(at));
+					if (++cellsRead % Slice_Cells_Per_Checkpoint == 0) co_await operations.Checkpoint();
+				}
+			}
 		}
-		if (ToolName == L"T_Axe_Stone" || ToolName == L"T_Axe_Copper" || ToolName == L"T_Axe_Iron") 
+	}
+
+	std::wstring path = std::filesystem::path(GetFilePath()).replace_extension(L".slice").wstring();
+	Jobs::Job sliceJob;
+	sliceJob.Work = [path, slice]() {
+		WriteSliceFile(path, *slice);
+	};
+	sliceJob.Complete = [center]() {
+		SpawnHintText(center + CoordinateInBlocks(0, 0, 2), L"World Slice Saved", 1, 1);
+	};
+	if (!jobPool.Post(std::move(sliceJob))) 
+	{
+		WriteSliceFile(path, *slice);
+		SpawnHintText(center + CoordinateInBlocks(0, 0, 2), L"World Slice Saved", 1, 1);
+	}
+}
+
+void StartWorldSliceCapture(CoordinateInBlocks At) 
+{
+	operations.Cancel(LongOperation::SliceCapture);
+	SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Capturing World Slice", 1, 1);
+	operations.Start(L"world slice capture", LongOperation::SliceCapture, CaptureWorldSlice(CoordinateInBlocks(GetPlayerLocation())));
+}
+
+// External Floors
+//********************************
+// Puts the ring where other mods find it. The ring lives as long as the mod, clients keep the pointer until Event_OnExit takes it down.
+void PublishCommandRing() 
+{
+	if (commandRingPublished) return;
+
+	ScopedSharedMemoryHandle handle = GetSharedMemoryPointer(CommandRing::Shared_Memory_Key, true, false);
+	if (!handle.Valid) return;
+
+	if (handle.Pointer != nullptr && handle.Pointer != &commandRing) 
+	{
+		LOG_WARNING(L"another command ring is already published, other mods can't ask for floors");
+		return;
+	}
+	handle.Pointer = &commandRing;
+	commandRingPublished = true;
+}
+
+// The ring goes away with the mod, so the key mustn't keep pointing at it. Leaves a ring some other mod published alone.
+void WithdrawCommandRing() 
+{
+	if (!commandRingPublished) return;
+	commandRingPublished = false;
+
+	ScopedSharedMemoryHandle handle = GetSharedMemoryPointer(CommandRing::Shared_Memory_Key, false, false);
+	if (handle.Valid && handle.Pointer == &commandRing) handle.Pointer = nullptr;
+}
+
+CommandRing::ClientStats* FloorClientStats(uint16_t client) 
+{
+	return client < CommandRing::Max_Clients ? &commandRing.Clients[client] : nullptr;
+}
+
+// Restores up to maxWrites clouds of the floor, returns how many it wrote
+int TakeDownFloor(ExternalFloor& floor, int maxWrites) 
+{
+	OwnWriteScope ownWrite;
+	int writes = 0;
+	while (!floor.clouds.empty() && writes < maxWrites) 
+	{
+		// Puts the original block back only if our cloud is still there, and hasn't become part of the platform or a bridge since
+		const Cloud& cloud = floor.clouds.back();
+		if (!IsCloudInPlatform(cloud.location) && !bridges.Contains(cloud.location)) 
 		{
-			PurgeClouds(At);
+			BlockInfo replacedBlock;
+			PlaceIfReplaceable(cloud.location, cloud.originalBlock, IsCloudBlock, replacedBlock);
 		}
-		if (ToolName == L"T_Arrow") 
+		floor.clouds.pop_back();
+		writes++;
+	}
+	return writes;
+}
+
+ExternalFloor* FindFloor(uint16_t client, uint32_t tag) 
+{
+	for (ExternalFloor& floor : externalFloors) 
+	{
+		if (floor.client == client && floor.tag == tag && !floor.released) return &floor;
+	}
+	return nullptr;
+}
+
+bool IsFloorCommandValid(const CommandRing::Command& command) 
+{
+	switch (command.Type) 
+	{
+	case CommandRing::Kind::PlaceFootprint:
+		return command.Radius <= Floor_Max_Radius && command.Ticks > 0 && command.Ticks <= uint32_t(Floor_Max_Ticks)
+			&& command.Z >= World_Min_Height && command.Z <= World_Max_Height;
+	case CommandRing::Kind::Release:
+		return FindFloor(command.Client, command.Tag) != nullptr;
+	default:
+		return false;
+	}
+}
+
+// Carries out one command, returns the number of blocks written
+int ApplyFloorCommand(const CommandRing::Command& command, const std::vector<CoordinateInBlocks>& cells) 
+{
+	CommandRing::ClientStats* stats = FloorClientStats(command.Client);
+	ExternalFloor* existing = FindFloor(command.Client, command.Tag);
+	int writes = 0;
+
+	if (command.Type == CommandRing::Kind::Release) 
+	{
+		// Comes down over the next ticks with the expired floors
+		existing->released = true;
+		existing->expiresAtTick = 0;
+		stats->Released.fetch_add(1, std::memory_order_relaxed);
+		return 0;
+	}
+
+	// Moving a floor takes the old one down first, its clouds would leave holes in the new one
+	if (existing != nullptr) 
+	{
+		writes += TakeDownFloor(*existing, INT32_MAX);
+		existing->released = true;
+		existing->expiresAtTick = 0;
+	}
+
+	ExternalFloor floor{ command.Client, command.Tag, floorTick + int64_t(command.Ticks), false, {} };
+	{
+		OwnWriteScope ownWrite;
+		for (const CoordinateInBlocks& cell : cells) 
 		{
-			CoordinateInBlocks HeightCalibratorLocation = At + CoordinateInBlocks(1, 0, 0);
-			BlockInfo currentBlock = GetBlock(HeightCalibratorLocation);
-			if (currentBlock.Type == EBlockType::Air) 
-			{
-				SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Please remember to stand up straight before calibrating your height.", 1, 1);
-				SetBlock(HeightCalibratorLocation, Height_Calibrator_Block);
-			}
-			else if (currentBlock.CustomBlockID == Height_Calibrator_Block) 
+			BlockInfo replacedBlock;
+			if (PlaceIfReplaceable(cell, Cloud_Block, [](const BlockInfo& block) { return blockProperties.Is(block, BlockProperty::Replaceable); }, replacedBlock)) 
 			{
-				SetBlock(HeightCalibratorLocation, EBlockType::Air);
+				floor.clouds.push_back(Cloud(cell, replacedBlock));
 			}
-			
+			writes++;
 		}
 	}
+	stats->Placed.fetch_add(1, std::memory_order_relaxed);
+	stats->Cells.fetch_add(floor.clouds.size(), std::memory_order_relaxed);
+	externalFloors.push_back(std::move(floor));
+	return writes;
 }
 
-void Event_Tick()
+// Takes floors down once they expire, then drains the command ring, both within Floor_Writes_Per_Tick
+void RunCommandRing() 
 {
-	if (cloudWalkingEnabled) 
-	{
-		BlockInfo blockUnderFoot = GetBlock(GetBlockUnderPlayerFoot());
+	floorTick++;
+	int budget = Floor_Writes_Per_Tick;
 
-		if (blockUnderFoot.CustomBlockID != Cloud_Block &&
-			blockUnderFoot.Type != EBlockType::Air) 
+	for (size_t i = 0; i < externalFloors.size() && budget > 0;) 
+	{
+		ExternalFloor& floor = externalFloors[i];
+		if (floor.expiresAtTick > floorTick) 
 		{
-			SetPlatformHeight(GetBlockUnderPlayerFoot().Z);
+			i++;
+			continue;
 		}
 
-		if (GetDistanceBetweenHands() <= Hand_Trigger_Distance_Threshold) 
+		budget -= TakeDownFloor(floor, budget);
+		if (!floor.clouds.empty()) break;
+
+		CommandRing::ClientStats* stats = FloorClientStats(floor.client);
+		if (stats != nullptr && !floor.released) stats->Expired.fetch_add(1, std::memory_order_relaxed);
+		externalFloors[i] = std::move(externalFloors.back());
+		externalFloors.pop_back();
+	}
+
+	while (const CommandRing::Command* next = commandRing.Peek()) 
+	{
+		CommandRing::Command command = *next;
+		CommandRing::ClientStats* stats = FloorClientStats(command.Client);
+		if (!IsFloorCommandValid(command)) 
 		{
-			if (IsHandAboveRiseThreshold()) 
-			{
-				progressToBlock++;
-				if (progressToBlock >= Accent_Tick_Interval) 
-				{
-					progressToBlock = 0;
-					platformHeight++;
-				}
-			}
-			else {
-				progressToBlock++;
-				if (progressToBlock >= Decent_Tick_Interval)
-				{
-					progressToBlock = 0;
-					platformHeight--;
-				}
-			}
+			if (stats != nullptr) stats->Refused.fetch_add(1, std::memory_order_relaxed);
+			commandRing.Pop();
+			continue;
 		}
 
-		CoordinateInCentimeters playerLocation = GetPlayerLocation();
-		if ( playerLocation.Z - (platformHeight * 50) < Player_Sunk_Off_Platform_Threshold ) {
-			SetPlayerLocation(CoordinateInCentimeters(playerLocation.X, playerLocation.Y, (platformHeight*50) + 25));
+		std::vector<CoordinateInBlocks> cells;
+		if (command.Type == CommandRing::Kind::PlaceFootprint) 
+		{
+			cells = GetAllPointsInCircle(CoordinateInBlocks(command.X, command.Y, int16_t(command.Z)), command.Radius);
 		}
-		CoordinateInBlocks playerLocationInBlocks = GetPlayerLocation();
-		CoordinateInBlocks platformCenter = CoordinateInBlocks(playerLocationInBlocks.X, playerLocationInBlocks.Y, platformHeight);
 
-		GeneratePlatform(platformCenter);
+		// Waits for the next tick if it doesn't fit, a floor bigger than the whole budget gets a tick to itself
+		if (int(cells.size()) > budget && budget < Floor_Writes_Per_Tick) break;
+
+		commandRing.Pop();
+		budget -= ApplyFloorCommand(command, cells);
+		if (budget <= 0) break;
+	}
+}
+
+// Flight Recorder
+//********************************
+void WriteFlightDump(const std::wstring& path, const FlightRecorder::Dump& dump) 
+{
+	std::vector<uint8_t> bytes = FlightRecorder::Encode(dump);
+
+	std::fstream dumpFile;
+	dumpFile.open(std::filesystem::path(path), std::ios::out | std::ios::binary);
+	if (!dumpFile.is_open()) 
+	{
+		LOG_ERROR(L"can't write the flight recorder dump to ", path.c_str());
+		return;
+	}
+	dumpFile.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+	dumpFile.close();
+
+	LOG_WARNING(L"flight recorder: ", FlightRecorder::Anomaly_Names[dump.Header.Reason], L" at tick ", dump.Header.ReasonTick, L", the last ",
+		dump.Ticks.size(), L" ticks and ", dump.Edits.size(), L" writes are in ", path.c_str());
+}
+
+// The state the tasks don't record themselves, as it is at the end of the tick
+void RecordPlatformState() 
+{
+	FlightRecorder::TickRecord& record = flightRecorder.Now();
+	record.PlatformHeight = platformHeight;
+	record.PlatformRadius = uint8_t(platformRadius);
+	record.PlatformShape = uint8_t(platformShape);
+	if (cloudWalkingEnabled) record.Flags |= FlightRecorder::CloudWalking;
+	if (singlePlanePlatform) record.Flags |= FlightRecorder::SinglePlane;
+	if (gestureEngine.IsEngaged()) record.Flags |= FlightRecorder::GestureEngaged;
+	if (gestureEngine.GetDirection() < 0) record.Flags |= FlightRecorder::Descending;
+	if (autopilot.IsActive()) record.Flags |= FlightRecorder::Autopilot;
+	if (bridgeMode) record.Flags |= FlightRecorder::Bridging;
+}
+
+// One file per kind of anomaly next to the save, each dump replaces the last one of its kind
+void DumpFlightRecorder() 
+{
+	if (!flightRecorder.IsDumpPending()) return;
+	std::shared_ptr<FlightRecorder::Dump> dump = std::make_shared<FlightRecorder::Dump>();
+	flightRecorder.TakeDump(*dump);
+
+	dump->Platform.reserve(platformCoords.size());
+	for (const Cloud& cloud : platformCoords) 
+	{
+		dump->Platform.push_back(FlightRecorder::MakeCell(cloud.location, cloud.originalBlock));
 	}
 
-	
+	std::filesystem::path savePath(GetFilePath());
+	std::wstring path = (savePath.parent_path() / (savePath.stem().wstring() + L"." + FlightRecorder::Anomaly_Names[dump->Header.Reason] + L".flight")).wstring();
+	flightDumps++;
+
+	Jobs::Job dumpJob;
+	dumpJob.Work = [path, dump]() {
+		WriteFlightDump(path, *dump);
+	};
+	if (!jobPool.Post(std::move(dumpJob))) WriteFlightDump(path, *dump);
+}
+
+// Scheduled Tasks
+//********************************
+// Runs on every host tick, so it sticks to the three host calls it needs (more only while catching a sinking player)
+void RunFallGuard() 
+{
+	PROFILE_SUBSYSTEM(Tick);
+	if (!cloudWalkingEnabled) return;
+
+	CoordinateInCentimeters playerLocation = GetPlayerLocation();
+	CoordinateInBlocks blockUnderFoot = playerLocation - CoordinateInCentimeters(0, 0, 25);
+	BlockInfo underFoot = GetBlock(blockUnderFoot);
+	flightRecorder.RecordPlayer(playerLocation, underFoot);
 
-	progressToSave++;
-	if (progressToSave >= Save_Tick_Interval) 
+	if (blockProperties.Is(underFoot, BlockProperty::Solid)) 
 	{
-		progressToSave = 0;
-		SaveData();
+		SetPlatformHeight(blockUnderFoot.Z);
+	}
+	else if (singlePlanePlatform && playerLocation.Z - (platformHeight * 50) < Player_Sinking_Threshold) 
+	{
+		CatchSinkingPlayer(blockUnderFoot);
 	}
 
+	if (playerLocation.Z - (platformHeight * 50) < Player_Sunk_Off_Platform_Threshold) 
+	{
+		SetPlayerLocation(CoordinateInCentimeters(playerLocation.X, playerLocation.Y, (platformHeight * 50) + 25));
+		fallRescues++;
 
+		// Climbing leaves the player under the new platform on purpose, the rescue is what lifts them onto it
+		flightRecorder.Now().Flags |= FlightRecorder::Rescued;
+		if (!gestureEngine.IsEngaged() || gestureEngine.GetDirection() <= 0) flightRecorder.Flag(FlightRecorder::Anomaly::SinkRescue);
+	}
+}
+
+void RunPlatformMaintenance() 
+{
+	if (!cloudWalkingEnabled) return;
+
+	// The heading and speed come from the exact position, the block alone can't tell a stroll from standing still
+	CoordinateInCentimeters playerPosition = GetPlayerLocation();
+	platformMotion.Update(int64_t(scheduler.GetTicks()), playerPosition.X, playerPosition.Y);
+
+	CoordinateInBlocks playerLocation = playerPosition;
+	GeneratePlatform(CoordinateInBlocks(playerLocation.X, playerLocation.Y, platformHeight));
+}
+
+void RunGestures() 
+{
+	platformBottomDrop = 1;
+	if (!cloudWalkingEnabled || autopilot.IsActive()) return;
+
+	int climbBlocks = gestureEngine.Update(SampleHands());
+
+	// Going down the player has to fall onto each new platform, so it never gets more than a block under their feet.
+	// A fast climb down is only as fast as they fall, a platform that ran away would leave them (and it) behind.
+	if (climbBlocks < 0) 
+	{
+		CoordinateInBlocks blockUnderFoot = GetPlayerLocation() - CoordinateInCentimeters(0, 0, 25);
+		climbBlocks = std::min(0, std::max(climbBlocks, int(blockUnderFoot.Z) - 1 - platformHeight));
+	}
+	flightRecorder.Now().ClimbBlocks = int8_t(std::clamp(climbBlocks, -128, 127));
+
+	if (climbBlocks != 0 && SetPlatformHeight(int16_t(platformHeight + climbBlocks))) 
+	{
+		// A step of several blocks up leaves no plane of the old platform in range. The plane the player stood on stays
+		// as the bottom plane, so only the new top plane is written.
+		if (climbBlocks > 1) platformBottomDrop = climbBlocks;
+
+		// The fall guard puts platformHeight back on the block under foot every tick, the new layer has to exist before it runs again
+		RunPlatformMaintenance();
+	}
+}
+
+// Moves the player and the platform along the route, Autopilot_Speed at a time
+void RunAutopilot() 
+{
+	if (!autopilot.IsActive()) return;
+	if (!cloudWalkingEnabled) 
+	{
+		StopAutopilot();
+		return;
+	}
+
+	bool flying = autopilot.Advance(Autopilot_Speed);
+	const Pathfinding::RouteFollower::Position& position = autopilot.GetPosition();
+	int16_t height = int16_t(DivideRoundNearest<50>(position.Z));
+	SetPlatformHeight(height);
+	SetPlayerLocation(CoordinateInCentimeters(position.X, position.Y, uint16_t(height * 50 + 25)));
+
+	// As after a climb gesture, the platform under the new position has to exist before the fall guard runs again
+	CoordinateInBlocks block = CoordinateInBlocks(DivideRoundNearest<50>(position.X), DivideRoundNearest<50>(position.Y), height);
+	if (!(block == autopilotLastBlock)) 
+	{
+		autopilotLastBlock = block;
+		RunPlatformMaintenance();
+	}
+
+	if (!flying) 
+	{
+		autopilotArrivals++;
+		SpawnHintText(block + CoordinateInBlocks(0, 0, 2), L"Arrived", 1, 1);
+	}
+}
+
+void RunOperations() 
+{
+	PROFILE_SUBSYSTEM(Operations);
+	if (operations.IsEmpty()) return;
+
+	operations.Resume(Operation_Budget_Microseconds);
+}
+
+void LogOperationFinished(const Coroutines::OperationStats& stats) 
+{
+	const wchar_t* outcome = stats.Cancelled ? L" cancelled" : (stats.Failed ? L" failed" : L" finished");
+	LOG_INFO(stats.Name, outcome, L" after ", stats.Ticks, L" ticks (", stats.TotalMicroseconds, L"us total, ",
+		stats.MaxMicroseconds, L"us max per tick)");
+}
+
+// Tasks run in the order they are added, fall protection first. The rates are what this work ran at when everything was done every tick at 10 Hz, they are only used by LogSchedulerReport.
+void ScheduleTasks() 
+{
+	operations.OnFinished = LogOperationFinished;
+
+	fallGuardTask = scheduler.Add(L"fall guard", Fall_Guard_Tick_Interval, 0, 300, false, Legacy_Tick_Rate, RunFallGuard);
+	scheduler.Add(L"gestures", Gesture_Tick_Interval, 1, 300, false, Legacy_Tick_Rate, RunGestures);
+	scheduler.Add(L"autopilot", 1, 0, 1000, false, Legacy_Tick_Rate, RunAutopilot);
+	scheduler.Add(L"platform", Platform_Tick_Interval, 0, 3000, true, Legacy_Tick_Rate, RunPlatformMaintenance);
+	scheduler.Add(L"command ring", 1, 0, 1000, true, Legacy_Tick_Rate, RunCommandRing);
+	scheduler.Add(L"operations", 1, 0, Operation_Budget_Microseconds, true, Legacy_Tick_Rate, RunOperations);
+	scheduler.Add(L"save", Save_Tick_Interval, 3, 1000, true, Legacy_Tick_Rate / 10, SaveData);
+	scheduler.Add(L"log drain", Log_Drain_Tick_Interval, 1, 1000, true, Legacy_Tick_Rate / 5, []() { DrainLog(Log_Drain_Max_Messages); });
+}
+
+void ToggleHeightCalibrator(CoordinateInBlocks At) 
+{
+	CoordinateInBlocks HeightCalibratorLocation = At + CoordinateInBlocks(1, 0, 0);
+	BlockInfo currentBlock = GetBlock(HeightCalibratorLocation);
+	if (blockProperties.Is(currentBlock, BlockProperty::Empty)) 
+	{
+		SpawnHintText(At + CoordinateInBlocks(0, 0, 1), L"Please remember to stand up straight before calibrating your height.", 1, 1);
+		OwnWriteScope ownWrite;
+		SetBlock(HeightCalibratorLocation, Height_Calibrator_Block);
+	}
+	else if (currentBlock.CustomBlockID == Height_Calibrator_Block) 
+	{
+		OwnWriteScope ownWrite;
+		SetBlock(HeightCalibratorLocation, EBlockType::Air);
+	}
+}
+
+// Only does something in builds with CLOUDWALKER_PROFILE_HOST_CALLS
+void LogHostCallReport(CoordinateInBlocks) 
+{
+	HostProfiler::LogReport([](const std::wstring& line) { Log(line); });
+	HostProfiler::Reset();
+}
+
+// What each tool does to each of our blocks, every material of a tool does the same
+constexpr auto toolActions = Tools::MakeActionTable<3, 15>({ Cloud_Block, Height_Calibrator_Block, Cloud_Walker_Block }, { {
+	{ Cloud_Block, Tools::Family::Axe, &StartPurgeClouds },
+	{ Cloud_Block, Tools::Family::Pickaxe, [](CoordinateInBlocks) { StartTeleportToNearestSolidBlockBelow(); } },
+	{ Cloud_Block, Tools::Family::Arrow, [](CoordinateInBlocks) { CyclePlatformRadius(); } },
+	{ Cloud_Block, Tools::Family::Stick, &ToggleCloudWalking },
+	{ Cloud_Block, Tools::Family::Shovel, &StartRemoveBridgeSegment },
+	{ Cloud_Block, Tools::Family::Sledgehammer, &ToggleAutopilot },
+
+	{ Height_Calibrator_Block, Tools::Family::Stick, [](CoordinateInBlocks At) { SetPlayerHeightFromCalibrator(At); } },
+	{ Height_Calibrator_Block, Tools::Family::Arrow, &CyclePlatformShape },
+	{ Height_Calibrator_Block, Tools::Family::Pickaxe, &ToggleSinglePlanePlatform },
+
+	{ Cloud_Walker_Block, Tools::Family::Stick, &ToggleCloudWalking },
+	{ Cloud_Walker_Block, Tools::Family::Axe, &StartPurgeClouds },
+	{ Cloud_Walker_Block, Tools::Family::Pickaxe, &ToggleBridgeMode },
+	{ Cloud_Walker_Block, Tools::Family::Shovel, &LogHostCallReport },
+	{ Cloud_Walker_Block, Tools::Family::Arrow, &ToggleHeightCalibrator },
+	{ Cloud_Walker_Block, Tools::Family::Sledgehammer, &StartWorldSliceCapture },
+} });
+
+static_assert(toolActions.Valid, "A tool action names a block that isn't in the table, or binds the same block and tool twice");
+
+void LogSchedulerReport() 
+{
+	double seconds = scheduler.GetElapsedSeconds();
+	if (seconds <= 0) return;
+
+	double hostCallsPerSecond = 0;
+	double legacyHostCallsPerSecond = 0;
+
+	for (const Scheduling::Task& task : scheduler.GetTasks()) 
+	{
+		const Scheduling::TaskStats& stats = task.Stats;
+		if (stats.Runs == 0) continue;
+
+		hostCallsPerSecond += double(stats.HostCalls) / seconds;
+		legacyHostCallsPerSecond += double(stats.HostCalls) / double(stats.Runs) * task.ReferenceRunsPerSecond;
+
+		LOG_INFO(task.Name, L": ", stats.Runs, L" runs, ", stats.HostCalls, L" host calls, ", stats.TotalMicroseconds / int64_t(stats.Runs),
+			L"us avg, ", stats.MaxMicroseconds, L"us max, ", stats.OverBudget, L" over budget, ", stats.Deferrals, L" deferred");
+	}
+
+	// A fall can start at any moment, so the guard catches it within one interval and on average half of one
+	const Scheduling::TaskStats& guard = scheduler.GetTasks()[fallGuardTask].Stats;
+	if (guard.Intervals > 0) 
+	{
+		int64_t legacyIntervalMilliseconds = int64_t(1000 / Legacy_Tick_Rate);
+		LOG_INFO(L"fall rescue latency avg/max ", guard.IntervalTotalMicroseconds / int64_t(guard.Intervals) / 2000, L"/",
+			guard.IntervalMaxMicroseconds / 1000, L"ms (", legacyIntervalMilliseconds / 2, L"/", legacyIntervalMilliseconds,
+			L"ms at a single ", int64_t(Legacy_Tick_Rate), L" Hz tick), ", fallRescues, L" rescues, ", sinkCatches, L" sinking players caught");
+	}
+	if (flightDumps > 0) LOG_INFO(L"flight recorder: ", flightDumps, L" dumps written");
+
+	// Without CLOUDWALKER_COUNT_HOST_CALLS the tasks' host calls are all 0
+	if (HostProfiler::Counts_Host_Calls) 
+	{
+		LOG_INFO(L"host calls per second ", int64_t(hostCallsPerSecond), L" (", int64_t(legacyHostCallsPerSecond),
+			L" for the same work at a single ", int64_t(Legacy_Tick_Rate), L" Hz tick)");
+	}
+}
+
+/************************************************************* 
+//	Functions (Run automatically by the game, you can put any code you want into them)
+*************************************************************/
+
+
+void Event_BlockHitByTool(CoordinateInBlocks At, UniqueID CustomBlockID, const wchar_t* ToolName, CoordinateInCentimeters /*ExactHitLocation*/, bool /*ToolHeldByHandLeft*/)
+{
+	PROFILE_SUBSYSTEM(Tools);
+	toolActions.Dispatch(CustomBlockID, Tools::Classify(ToolName), At);
+}
+
+void Event_Tick()
+{
+	PROFILE_SUBSYSTEM(Tick);
+	auto tickStart = std::chrono::steady_clock::now();
+	uint64_t hostCallsBefore = HostProfiler::HostCallCount;
+	flightRecorder.BeginTick(scheduler.GetTicks());
+
+	offloadedMicrosecondsLastTick = jobPool.CollectCompletedJobs();
+	offloadedMicrosecondsTotal += offloadedMicrosecondsLastTick;
+	ticksMeasured++;
+
+	scheduler.RunTick();
+
+	int64_t tickMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tickStart).count();
+	if (tickMicroseconds > Tick_Budget_Microseconds) flightRecorder.Flag(FlightRecorder::Anomaly::TickOverBudget);
+	RecordPlatformState();
+	flightRecorder.EndTick(tickMicroseconds, HostProfiler::HostCallCount - hostCallsBefore);
+	DumpFlightRecorder();
 }
 
 void Event_OnLoad()
 {
+	PROFILE_SUBSYSTEM(Load);
+	auto loadStart = std::chrono::steady_clock::now();
+
+	if (scheduler.IsEmpty()) ScheduleTasks();
+
 	LoadData();
+	ConfigureGestures();
+	PublishCommandRing();
 	if (cloudWalkingEnabled) {
 		CoordinateInBlocks blockUnderFoot = GetBlockUnderPlayerFoot();
 		SetPlatformHeight(blockUnderFoot.Z);
-		
-		CoordinateInBlocks playerLocation = GetPlayerLocation();
-		PruneOldClouds(CoordinateInBlocks(playerLocation.X, playerLocation.Y, platformHeight));
 	}
+
+	// Stale clouds are restored, and clouds left behind by a crash cleared, over the next ticks by the RecoverSavedClouds operation
+	BeginSavedCloudReconciliation(GetPlayerLocation());
+
+	int64_t loadMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - loadStart).count();
+	LOG_INFO(L"loaded ", savedClouds.size(), L" saved clouds in ", loadMicroseconds, L"us");
 }
 
 void Event_OnExit()
 {
-	// Only used for memory cleanup
+	// Joins the job pool, logs the session reports (host calls, external edits, bridges, autopilot, floors, tools,
+	// placement, gestures, background jobs, scheduler), takes the command ring down and flushes the log.
+	// Doesn't save, the next load reads whatever the last periodic save wrote.
+	// The job pool's destructor doesn't join it (see JobSystem.h), Internals starts it again on the next load.
+	offloadedMicrosecondsTotal += jobPool.Join();
+
+	HostProfiler::LogReport([](const std::wstring& line) { Log(line); });
+
+	if (externalCloudRemovals > 0 || externalCloudOverwrites > 0) 
+	{
+		LOG_INFO(L"players removed ", externalCloudRemovals, L" clouds and built over ", externalCloudOverwrites, L" platform cells");
+	}
+
+	if (bridges.Size() > 0 || externalBridgeRemovals > 0) 
+	{
+		LOG_INFO(L"bridges: ", bridges.Size(), L" clouds in ", bridges.ChunkCount(), L" chunks, players removed ", externalBridgeRemovals);
+	}
+
+	if (autopilotArrivals > 0) 
+	{
+		LOG_INFO(L"autopilot arrived ", autopilotArrivals, L" times");
+	}
+
+	for (const CommandRing::ClientStats& client : commandRing.Clients) 
+	{
+		if (client.InUse.load() != CommandRing::Client_Registered) continue;
+		LOG_INFO(L"floors for ", std::wstring(client.Name), L": ", client.Queued.load(), L" commands queued, ", client.Full.load(), L" ring full, ",
+			client.Throttled.load(), L" throttled, ", client.Refused.load(), L" refused, ", client.Placed.load(), L" placed with ", client.Cells.load(),
+			L" clouds, ", client.Released.load(), L" released, ", client.Expired.load(), L" expired");
+	}
+
+	for (size_t tool = 0; tool < size_t(Tools::Tool::Count); tool++) 
+	{
+		if (toolHitsInWorld[tool] == 0) continue;
+		LOG_INFO(std::wstring(Tools::NameOf(Tools::Tool(tool))), L" hit ", toolHitsInWorld[tool], L" blocks in the world");
+	}
+
+	const PlaceIfReplaceableStats& placeStats = GetPlaceIfReplaceableStats();
+	if (placeStats.Attempts > 0) 
+	{
+		LOG_INFO(L"PlaceIfReplaceable placed ", placeStats.Placed, L" of ", placeStats.Attempts,
+			L" cells, declined ", placeStats.Declined, L" without writing, reverted ", placeStats.Reverted, L", refused ", placeStats.Failed);
+	}
+
+	const Gestures::LatencyStats& gestureLatency = gestureEngine.GetLatency();
+	if (gestureLatency.Gestures > 0) 
+	{
+		LOG_INFO(L"altitude gestures: ", gestureLatency.Gestures, L", ticks from hands to first block min/avg/max ",
+			gestureLatency.MinTicks, L"/", gestureLatency.TotalTicks / int64_t(gestureLatency.Gestures), L"/", gestureLatency.MaxTicks);
+	}
+
+	if (ticksMeasured > 0) 
+	{
+		LOG_INFO(L"background jobs took ", offloadedMicrosecondsTotal, L"us off the tick thread over ",
+			ticksMeasured, L" ticks (", offloadedMicrosecondsTotal / ticksMeasured, L"us per tick)");
+	}
+
+	LogSchedulerReport();
+
+	WithdrawCommandRing();
+
+	// Everything still buffered goes out now, the workers are already joined
+	FlushLog();
 }
 
-void Event_BlockPlaced(CoordinateInBlocks At, UniqueID CustomBlockID, bool Moved)
+void Event_BlockPlaced(CoordinateInBlocks /*At*/, UniqueID /*CustomBlockID*/, bool /*Moved*/)
 {}
-void Event_BlockDestroyed(CoordinateInBlocks At, UniqueID CustomBlockID, bool Moved)
+void Event_BlockDestroyed(CoordinateInBlocks At, UniqueID CustomBlockID, bool /*Moved*/)
 {
 	if (CustomBlockID == Cloud_Walker_Block) 
 	{
-		if (GetBlock(At + CoordinateInBlocks(1, 0, 0)).CustomBlockID == Height_Calibrator_Block)
+		if (GetBlock(At + CoordinateInBlocks(1, 0, 0)).CustomBlockID == Height_Calibrator_Block) 
+		{
+			OwnWriteScope ownWrite;
 			SetBlock(At + CoordinateInBlocks(1, 0, 0), EBlockType::Air);
+		}
 	}
 }
 /*******************************************************
 Advanced functions
 *******************************************************/
-void Event_AnyBlockPlaced(CoordinateInBlocks At, BlockInfo Type, bool Moved)
-{}
-void Event_AnyBlockDestroyed(CoordinateInBlocks At, BlockInfo Type, bool Moved)
-{}
-void Event_AnyBlockHitByTool(CoordinateInBlocks At, BlockInfo Type, wString ToolName, CoordinateInCentimeters ExactHitLocation, bool ToolHeldByHandLeft)
-{}
+void Event_AnyBlockPlaced(CoordinateInBlocks At, BlockInfo Type, bool /*Moved*/)
+{
+	// Fires for every block placed anywhere in the world, keep the common path to a few compares
+	if (ownWriteDepth > 0) return;
+	if (!knownCells.empty()) knownCells.erase(CellKey(At));
+	if (blockProperties.Is(Type, BlockProperty::Cloud)) return;
+	if (bridges.Remove(At)) externalBridgeRemovals++;
+	occupancy.Invalidate(At);
+
+	if (platformBoundsDirty) 
+	{
+		UpdatePlatformBounds();
+		platformBoundsDirty = false;
+	}
+	if (!platformBounds.Contains(At)) return;
+
+	if (ForgetCloudAt(At)) externalCloudOverwrites++;
+}
+void Event_AnyBlockDestroyed(CoordinateInBlocks At, BlockInfo Type, bool /*Moved*/)
+{
+	if (ownWriteDepth > 0) return;
+	// Whatever was in the platform's way there is gone, the next rebuild can put a cloud in without reading first
+	if (cloudWalkingEnabled && IsInPlatformRange(knownCellsCenter, At)) knownCells[CellKey(At)] = KnownCellEntry{ At, KnownCell::Air };
+	if (!blockProperties.Is(Type, BlockProperty::Cloud)) return;
+	if (bridges.Remove(At)) externalBridgeRemovals++;
+
+	if (platformBoundsDirty) 
+	{
+		UpdatePlatformBounds();
+		platformBoundsDirty = false;
+	}
+	if (!platformBounds.Contains(At)) return;
+
+	if (ForgetCloudAt(At)) externalCloudRemovals++;
+}
+void Event_AnyBlockHitByTool(CoordinateInBlocks At, BlockInfo Type, const wchar_t* ToolName, CoordinateInCentimeters /*ExactHitLocation*/, bool /*ToolHeldByHandLeft*/)
+{
+	// Fires for every hit anywhere in the world, so it only counts the tool unless the autopilot is waiting for a target
+	Tools::Tool tool = Tools::Classify(ToolName);
+	toolHitsInWorld[size_t(tool)]++;
+
+	// Our own blocks are handled by Event_BlockHitByTool
+	if (autopilotArmed && cloudWalkingEnabled && Tools::FamilyOf(tool) == Tools::Family::Sledgehammer && Type.Type != EBlockType::ModBlock) 
+	{
+		MarkAutopilotTarget(At);
+	}
+}
@@ -0,0 +1,573 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/*******************************************************
+	Route planning for the autopilot.
+
+	OccupancyCache keeps one bit per block, clear or not, for the parts of the world a search looked at. Blocks
+	are grouped in 16x16x16 bricks (512 bytes of bits each) and loaded 4x4x4 tiles at a time, only when a search
+	first asks about a cell in them. Each block costs the game a host call to look up, so tiles are kept small enough
+	that loading one fits in a tick's budget. At most MaxBricks bricks are kept, the least recently used one goes first.
+
+	RouteSearch plots a route for the platform from Start (the current platformHeight under the player) to Goal
+	(the block to land on). It climbs straight up to a cruise altitude, flies level at that altitude and descends
+	straight onto Goal. The level part is a jump point search over 8 connected cells, diagonal moves only where
+	both side cells are free. A cell is free when ClearanceBelow cells under it (the platform) and ClearanceAbove
+	cells over it (the player) are all clear. If the cruise altitude has no route within MaxNodes nodes, it
+	tries again AltitudeStep blocks higher, so hills and trees are flown over rather than around when that is
+	the only way.
+
+	Nothing here calls into the game. Step stops with NeedCells when it needs a cell the cache doesn't have yet,
+	the caller loads it with OccupancyCache::FillTile and calls Step again, which repeats the interrupted expansion.
+	Step also stops after the expansion that used up its budget of cell tests. Jumps are capped at MaxJump cells
+	(MaxSideJump for the looks to the side during a diagonal jump), so one expansion costs a few thousand cell tests
+	at most, even over open ground. That way the caller decides how much work and how many host calls happen per tick:
+
+		while ((Status = Search.Step(Cache, 4096)) != Status::Found && Status != Status::NoRoute) {
+			if (Status == Status::NeedCells) Cache.FillTile(Search.GetMissingCell(), IsClearAt);
+			co_await Checkpoint();
+		}
+
+	RouteFollower moves along the finished route at a fixed speed, in centimeters.
+*******************************************************/
+
+namespace Pathfinding {
+
+	using ModAPI::CoordinateInBlocks;
+
+	enum class Cell : uint8_t { Unknown, Blocked, Clear };
+
+	inline constexpr int Brick_Bits = 4;
+	inline constexpr int Brick_Size = 1 << Brick_Bits;
+	inline constexpr int Brick_Volume = Brick_Size * Brick_Size * Brick_Size;
+	inline constexpr int Tile_Bits = 2;
+	inline constexpr int Tile_Size = 1 << Tile_Bits;
+	inline constexpr int Tiles_Per_Side = Brick_Size / Tile_Size;
+
+	static_assert(Tiles_Per_Side * Tiles_Per_Side * Tiles_Per_Side <= 64, "A brick's tiles must fit its KnownTiles bits");
+
+	class OccupancyCache
+	{
+	public:
+		explicit OccupancyCache(size_t MaxBricks_) : MaxBricks(std::max<size_t>(MaxBricks_, 1)) {}
+
+		Cell Get(const CoordinateInBlocks& At)
+		{
+			const Brick* Found = FindBrick(KeyOf(At));
+			if (Found == nullptr || (Found->KnownTiles & TileBit(At)) == 0) return Cell::Unknown;
+			return Found->Clear.test(LocalOf(At)) ? Cell::Clear : Cell::Blocked;
+		}
+
+		// Loads the 4x4x4 tile At is in, IsClearAt(const CoordinateInBlocks&) -> bool. Returns how many cells it asked about.
+		template<typename Function>
+		size_t FillTile(const CoordinateInBlocks& At, Function&& IsClearAt)
+		{
+			Brick& Target = GetOrAddBrick(KeyOf(At));
+			const uint64_t Tile = TileBit(At);
+			if (Target.KnownTiles & Tile) return 0;
+
+			const int64_t Mask = ~int64_t(Tile_Size - 1);
+			const CoordinateInBlocks Origin(At.X & Mask, At.Y & Mask, int16_t(int64_t(At.Z) & Mask));
+			for (int Z = 0; Z < Tile_Size; Z++) {
+				for (int Y = 0; Y < Tile_Size; Y++) {
+					for (int X = 0; X < Tile_Size; X++) {
+						const CoordinateInBlocks Location = Origin + CoordinateInBlocks(X, Y, int16_t(Z));
+						Target.Clear.set(LocalOf(Location), IsClearAt(Location));
+					}
+				}
+			}
+			Target.KnownTiles |= Tile;
+			return size_t(Tile_Size) * Tile_Size * Tile_Size;
+		}
+
+		// Something changed At, the tile it is in gets loaded again when it is next needed
+		void Invalidate(const CoordinateInBlocks& At)
+		{
+			if (Bricks.empty()) return;
+			auto Found = Bricks.find(KeyOf(At));
+			if (Found != Bricks.end()) Found->second.KnownTiles &= ~TileBit(At);
+		}
+
+		void Clear()
+		{
+			Bricks.clear();
+			LastBrick = nullptr;
+		}
+
+		size_t GetBrickCount() const { return Bricks.size(); }
+		size_t GetMemoryBytes() const { return Bricks.size() * sizeof(Brick); }
+
+	private:
+		struct Brick {
+			std::bitset<Brick_Volume> Clear;
+			uint64_t KnownTiles = 0;		// One bit per 4x4x4 tile that was loaded
+			uint64_t LastUse = 0;
+		};
+
+		std::unordered_map<uint64_t, Brick> Bricks;
+		size_t MaxBricks;
+		uint64_t UseClock = 0;
+
+		// Searches look at the same brick many times in a row
+		uint64_t LastKey = 0;
+		Brick* LastBrick = nullptr;
+
+		Brick* FindBrick(uint64_t Key)
+		{
+			if (LastBrick != nullptr && LastKey == Key) return LastBrick;
+
+			auto Found = Bricks.find(Key);
+			if (Found == Bricks.end()) return nullptr;
+
+			Found->second.LastUse = ++UseClock;
+			LastKey = Key;
+			LastBrick = &Found->second;
+			return LastBrick;
+		}
+
+		Brick& GetOrAddBrick(uint64_t Key)
+		{
+			if (Brick* Found = FindBrick(Key)) return *Found;
+
+			if (Bricks.size() >= MaxBricks) {
+				auto Oldest = std::min_element(Bricks.begin(), Bricks.end(), [](const auto& A, const auto& B) { return A.second.LastUse < B.second.LastUse; });
+				Bricks.erase(Oldest);
+				LastBrick = nullptr;
+			}
+
+			Brick& Added = Bricks[Key];
+			Added.LastUse = ++UseClock;
+			LastKey = Key;
+			LastBrick = &Added;
+			return Added;
+		}
+
+		// 26 bits per horizontal brick coordinate, 12 for Z
+		static uint64_t KeyOf(const CoordinateInBlocks& At)
+		{
+			return (uint64_t(At.X >> Brick_Bits) & 0x3FFFFFF) | ((uint64_t(At.Y >> Brick_Bits) & 0x3FFFFFF) << 26) |
+				((uint64_t(int64_t(At.Z) >> Brick_Bits) & 0xFFF) << 52);
+		}
+
+		static uint16_t LocalOf(const CoordinateInBlocks& At)
+		{
+			const int Mask = Brick_Size - 1;
+			return uint16_t((int(At.Z) & Mask) << (2 * Brick_Bits) | (int(At.Y & Mask) << Brick_Bits) | int(At.X & Mask));
+		}
+
+		static uint64_t TileBit(const CoordinateInBlocks& At)
+		{
+			const int Mask = Tiles_Per_Side - 1;
+			const int Index = int(At.X >> Tile_Bits & Mask) | int(At.Y >> Tile_Bits & Mask) << (Brick_Bits - Tile_Bits) |
+				int(int64_t(At.Z) >> Tile_Bits & Mask) << (2 * (Brick_Bits - Tile_Bits));
+			return uint64_t(1) << Index;
+		}
+	};
+
+	enum class Status : uint8_t { Searching, NeedCells, Found, NoRoute };
+
+	struct RouteLimits {
+		int ClearanceBelow = 1;			// Clear cells needed under a route cell
+		int ClearanceAbove = 4;			// And over it
+		int CorridorMargin = 32;		// How far outside the box around start and goal the level part may go
+		int MaxDistance = 512;			// In blocks, along X or Y
+		int MaxJump = 32;				// Longest jump, the cell where it stops becomes a node
+		int MaxSideJump = 8;			// How far a diagonal jump looks to its sides
+		size_t MaxNodes = 1 << 14;		// Per cruise altitude
+		int AltitudeStep = 6;
+		int MaxAltitudes = 8;
+		int MinHeight = 0;
+		int MaxHeight = 720;
+	};
+
+	class RouteSearch
+	{
+	public:
+		RouteSearch(const CoordinateInBlocks& Start_, const CoordinateInBlocks& Goal_, const RouteLimits& Limits_)
+			: Start(Start_), Goal(Goal_), Limits(Limits_)
+		{
+			Cruise = std::max<int>(Start.Z, Goal.Z + 1);
+			Low = CoordinateInBlocks(std::min(Start.X, Goal.X) - Limits.CorridorMargin, std::min(Start.Y, Goal.Y) - Limits.CorridorMargin, 0);
+			High = CoordinateInBlocks(std::max(Start.X, Goal.X) + Limits.CorridorMargin, std::max(Start.Y, Goal.Y) + Limits.CorridorMargin, 0);
+
+			if (std::max(std::abs(Start.X - Goal.X), std::abs(Start.Y - Goal.Y)) > Limits.MaxDistance) {
+				Fail(L"Too far away for the autopilot");
+			}
+			else BeginAltitude();
+		}
+
+		// Expands nodes until MaxCellTests cells were tested
+		Status Step(OccupancyCache& Cache, size_t MaxCellTests)
+		{
+			if (Result == Status::Found || Result == Status::NoRoute) return Result;
+			Result = Status::Searching;
+			Missing = false;
+
+			if (!ColumnsChecked) {
+				// Going higher doesn't get past something over the start or the goal, it only adds cells to those columns
+				const Cell Climb = ColumnClear(Cache, Start.X, Start.Y, Start.Z + 1, Cruise + Limits.ClearanceAbove);
+				const Cell Descent = ColumnClear(Cache, Goal.X, Goal.Y, Goal.Z + 1, Cruise + Limits.ClearanceAbove);
+				if (Climb == Cell::Unknown || Descent == Cell::Unknown) return Result = Status::NeedCells;
+				if (Climb == Cell::Blocked) return Fail(L"No room to climb here");
+				if (Descent == Cell::Blocked) return Fail(L"No room to land on the target");
+				ColumnsChecked = true;
+			}
+
+			for (const uint64_t Budget = CellTests + MaxCellTests; CellTests < Budget;) {
+				if (Open.empty() || Nodes.size() > Limits.MaxNodes) {
+					if (!NextAltitude()) return Fail(L"No route found");
+					return Result;
+				}
+
+				const OpenEntry Best = Open.top();
+				Open.pop();
+				Node& Current = Nodes[Best.Key];
+				if (Current.Closed || Best.G != Current.G) continue;
+
+				const int64_t X = UnpackX(Best.Key), Y = UnpackY(Best.Key);
+				if (X == Goal.X && Y == Goal.Y) {
+					BuildRoute(Best.Key);
+					return Result = Status::Found;
+				}
+
+				if (!Expand(Cache, X, Y, Current)) {
+					// Nothing of the expansion was kept, it runs again once the missing cell is loaded
+					Open.push(Best);
+					return Result = Status::NeedCells;
+				}
+				Expanded++;
+			}
+			return Result;
+		}
+
+		// The cell Step returned NeedCells for
+		const CoordinateInBlocks& GetMissingCell() const { return MissingCell; }
+
+		// Start, the top of the climb, the jump points at cruise altitude, the top of the descent and Goal.
+		// Consecutive waypoints are always on a straight or diagonal line.
+		const std::vector<CoordinateInBlocks>& GetRoute() const { return Route; }
+
+		const wchar_t* GetFailure() const { return Failure; }
+		int GetCruiseAltitude() const { return Cruise; }
+		int GetAltitudesTried() const { return AltitudesTried; }
+		size_t GetExpandedCount() const { return Expanded; }
+		uint64_t GetCellTestCount() const { return CellTests; }
+
+	private:
+		static constexpr int64_t Straight_Cost = 1000;
+		static constexpr int64_t Diagonal_Cost = 1414;
+
+		struct Node {
+			int64_t G = 0;
+			uint64_t Parent = 0;
+			bool Closed = false;
+		};
+
+		struct OpenEntry {
+			int64_t F;
+			int64_t G;
+			uint64_t Key;
+
+			// Lowest F first, then the one furthest along
+			bool operator<(const OpenEntry& Other) const { return F > Other.F || (F == Other.F && G < Other.G); }
+		};
+
+		struct Successor {
+			int64_t X, Y;
+		};
+
+		CoordinateInBlocks Start;
+		CoordinateInBlocks Goal;
+		RouteLimits Limits;
+		CoordinateInBlocks Low, High;
+		int Cruise = 0;
+		int AltitudesTried = 0;
+		bool ColumnsChecked = false;
+
+		std::unordered_map<uint64_t, Node> Nodes;
+		std::priority_queue<OpenEntry> Open;
+
+		// Walkable answers at the current altitude, one bit per column in 8x8 tiles, so the jumps that look across the
+		// same columns again and again don't test their cells every time
+		struct LayerTile {
+			uint64_t Known = 0;
+			uint64_t Clear = 0;
+		};
+		std::unordered_map<uint64_t, LayerTile> Layer;
+		uint64_t LastLayerKey = UINT64_MAX;
+		LayerTile* LastLayer = nullptr;
+
+		size_t Expanded = 0;
+		uint64_t CellTests = 0;
+
+		Status Result = Status::Searching;
+		const wchar_t* Failure = L"";
+		std::vector<CoordinateInBlocks> Route;
+
+		bool Missing = false;
+		CoordinateInBlocks MissingCell;
+
+		static uint64_t Pack(int64_t X, int64_t Y) { return uint64_t(uint32_t(int32_t(X))) | uint64_t(uint32_t(int32_t(Y))) << 32; }
+		static int64_t UnpackX(uint64_t Key) { return int32_t(uint32_t(Key)); }
+		static int64_t UnpackY(uint64_t Key) { return int32_t(uint32_t(Key >> 32)); }
+
+		static int64_t Octile(int64_t DX, int64_t DY)
+		{
+			DX = std::abs(DX);
+			DY = std::abs(DY);
+			return Straight_Cost * (std::max(DX, DY) - std::min(DX, DY)) + Diagonal_Cost * std::min(DX, DY);
+		}
+
+		Status Fail(const wchar_t* Reason)
+		{
+			Failure = Reason;
+			Nodes.clear();
+			Open = {};
+			return Result = Status::NoRoute;
+		}
+
+		void BeginAltitude()
+		{
+			Nodes.clear();
+			Open = {};
+			Layer.clear();
+			LastLayerKey = UINT64_MAX;
+			ColumnsChecked = false;
+			AltitudesTried++;
+
+			const uint64_t StartKey = Pack(Start.X, Start.Y);
+			Nodes[StartKey] = Node{ 0, StartKey, false };
+			Open.push(OpenEntry{ Octile(Goal.X - Start.X, Goal.Y - Start.Y), 0, StartKey });
+		}
+
+		bool NextAltitude()
+		{
+			Cruise += Limits.AltitudeStep;
+			if (AltitudesTried >= Limits.MaxAltitudes || Cruise + Limits.ClearanceAbove > Limits.MaxHeight) return false;
+			BeginAltitude();
+			return true;
+		}
+
+		Cell Get(OccupancyCache& Cache, const CoordinateInBlocks& At)
+		{
+			if (At.Z < Limits.MinHeight || At.Z > Limits.MaxHeight) return Cell::Blocked;
+			CellTests++;
+			const Cell Found = Cache.Get(At);
+			if (Found == Cell::Unknown && !Missing) {
+				Missing = true;
+				MissingCell = At;
+			}
+			return Found;
+		}
+
+		Cell ColumnClear(OccupancyCache& Cache, int64_t X, int64_t Y, int Bottom, int Top)
+		{
+			for (int Z = Bottom; Z <= Top; Z++) {
+				const Cell Found = Get(Cache, CoordinateInBlocks(X, Y, int16_t(Z)));
+				if (Found != Cell::Clear) return Found;
+			}
+			return Cell::Clear;
+		}
+
+		// False for unknown cells too, Missing says which
+		bool Walkable(OccupancyCache& Cache, int64_t X, int64_t Y)
+		{
+			if (X < Low.X || X > High.X || Y < Low.Y || Y > High.Y) return false;
+
+			CellTests++;
+			const uint64_t Key = Pack(X >> 3, Y >> 3);
+			if (Key != LastLayerKey) {
+				LastLayer = &Layer[Key];
+				LastLayerKey = Key;
+			}
+			const uint64_t Bit = uint64_t(1) << ((X & 7) | (Y & 7) << 3);
+			if (LastLayer->Known & Bit) return (LastLayer->Clear & Bit) != 0;
+
+			const Cell Found = ColumnClear(Cache, X, Y, Cruise - Limits.ClearanceBelow, Cruise + Limits.ClearanceAbove);
+			if (Found == Cell::Unknown) return false;
+			LastLayer->Known |= Bit;
+			if (Found == Cell::Clear) LastLayer->Clear |= Bit;
+			return Found == Cell::Clear;
+		}
+
+		// Follows (DX, DY) from (X, Y) until a jump point, false if it runs into something first. After Limit cells
+		// the cell it got to is the jump point, unless it is only looking to the side of a diagonal jump.
+		bool Jump(OccupancyCache& Cache, int64_t X, int64_t Y, int DX, int DY, int Limit, bool Sideways, Successor& Out)
+		{
+			for (int Steps = 1;; Steps++) {
+				if (Missing || !Walkable(Cache, X, Y)) return false;
+				if (X == Goal.X && Y == Goal.Y) break;
+
+				if (DX != 0 && DY != 0) {
+					Successor Ignored;
+					if (Jump(Cache, X + DX, Y, DX, 0, Limits.MaxSideJump, true, Ignored) || Jump(Cache, X, Y + DY, 0, DY, Limits.MaxSideJump, true, Ignored)) break;
+				}
+				else if (DX != 0) {
+					if ((Walkable(Cache, X, Y - 1) && !Walkable(Cache, X - DX, Y - 1)) || (Walkable(Cache, X, Y + 1) && !Walkable(Cache, X - DX, Y + 1))) break;
+				}
+				else {
+					if ((Walkable(Cache, X - 1, Y) && !Walkable(Cache, X - 1, Y - DY)) || (Walkable(Cache, X + 1, Y) && !Walkable(Cache, X + 1, Y - DY))) break;
+				}
+
+				if (Steps == Limit) {
+					if (Sideways) return false;
+					break;
+				}
+
+				// A diagonal step needs both cells beside it
+				if (!Walkable(Cache, X + DX, Y) || !Walkable(Cache, X, Y + DY)) return false;
+				X += DX;
+				Y += DY;
+			}
+			Out = Successor{ X, Y };
+			return !Missing;
+		}
+
+		// False if a cell was missing, then nothing was changed
+		bool Expand(OccupancyCache& Cache, int64_t X, int64_t Y, Node& Current)
+		{
+			// Directions worth following from here, only the ones the parent's direction doesn't make redundant
+			int Directions[8][2];
+			int Count = 0;
+			auto Add = [&](int DX, int DY) { Directions[Count][0] = DX; Directions[Count][1] = DY; Count++; };
+
+			const int64_t ParentX = UnpackX(Current.Parent), ParentY = UnpackY(Current.Parent);
+			const int DX = X > ParentX ? 1 : (X < ParentX ? -1 : 0);
+			const int DY = Y > ParentY ? 1 : (Y < ParentY ? -1 : 0);
+
+			if (DX == 0 && DY == 0) {
+				for (int NY = -1; NY <= 1; NY++) {
+					for (int NX = -1; NX <= 1; NX++) {
+						if (NX != 0 || NY != 0) Add(NX, NY);
+					}
+				}
+			}
+			else if (DX != 0 && DY != 0) {
+				Add(DX, 0);
+				Add(0, DY);
+				Add(DX, DY);
+			}
+			else if (DX != 0) {
+				Add(DX, 0);
+				Add(DX, 1);
+				Add(DX, -1);
+				Add(0, 1);
+				Add(0, -1);
+			}
+			else {
+				Add(0, DY);
+				Add(1, DY);
+				Add(-1, DY);
+				Add(1, 0);
+				Add(-1, 0);
+			}
+
+			Successor Found[8];
+			int FoundCount = 0;
+			for (int i = 0; i < Count; i++) {
+				const int NX = Directions[i][0], NY = Directions[i][1];
+				if (NX != 0 && NY != 0 && (!Walkable(Cache, X + NX, Y) || !Walkable(Cache, X, Y + NY))) continue;
+				if (Jump(Cache, X + NX, Y + NY, NX, NY, Limits.MaxJump, false, Found[FoundCount])) FoundCount++;
+			}
+			if (Missing) return false;
+
+			Current.Closed = true;
+			const int64_t CurrentG = Current.G;
+			const uint64_t CurrentKey = Pack(X, Y);
+			for (int i = 0; i < FoundCount; i++) {
+				const uint64_t Key = Pack(Found[i].X, Found[i].Y);
+				const int64_t G = CurrentG + Octile(Found[i].X - X, Found[i].Y - Y);
+
+				auto [Entry, Added] = Nodes.try_emplace(Key);
+				if (!Added && (Entry->second.Closed || Entry->second.G <= G)) continue;
+
+				Entry->second = Node{ G, CurrentKey, false };
+				Open.push(OpenEntry{ G + Octile(Goal.X - Found[i].X, Goal.Y - Found[i].Y), G, Key });
+			}
+			return true;
+		}
+
+		void BuildRoute(uint64_t GoalKey)
+		{
+			std::vector<CoordinateInBlocks> Level;
+			const uint64_t StartKey = Pack(Start.X, Start.Y);
+			for (uint64_t Key = GoalKey;; Key = Nodes[Key].Parent) {
+				Level.push_back(CoordinateInBlocks(UnpackX(Key), UnpackY(Key), int16_t(Cruise)));
+				if (Key == StartKey) break;
+			}
+			std::reverse(Level.begin(), Level.end());
+
+			auto Append = [this](const CoordinateInBlocks& Waypoint) {
+				if (Route.empty() || !(Route.back() == Waypoint)) Route.push_back(Waypoint);
+			};
+			Append(Start);
+			for (const CoordinateInBlocks& Waypoint : Level) Append(Waypoint);
+			Append(Goal);
+
+			Nodes.clear();
+			Open = {};
+		}
+	};
+
+	// A position along a route of block coordinates, in centimeters (50 to a block, block centers at multiples of 50)
+	class RouteFollower
+	{
+	public:
+		struct Position {
+			int64_t X = 0, Y = 0, Z = 0;
+		};
+
+		RouteFollower() = default;
+
+		explicit RouteFollower(std::vector<CoordinateInBlocks> Route_) : Route(std::move(Route_))
+		{
+			if (!Route.empty()) Current = ToCentimeters(Route[0]);
+		}
+
+		// Moves up to Centimeters along the route, false once the end was reached
+		bool Advance(int64_t Centimeters)
+		{
+			while (Centimeters > 0 && Next < Route.size()) {
+				const Position From = ToCentimeters(Route[Next - 1]);
+				const Position Target = ToCentimeters(Route[Next]);
+				const int64_t DX = Target.X - From.X, DY = Target.Y - From.Y, DZ = Target.Z - From.Z;
+				const int64_t LegLength = int64_t(std::llround(std::sqrt(double(DX * DX + DY * DY + DZ * DZ))));
+
+				if (LegLength - Travelled <= Centimeters) {
+					Centimeters -= LegLength - Travelled;
+					Current = Target;
+					Travelled = 0;
+					Next++;
+					continue;
+				}
+
+				// Always measured from the start of the leg, so rounding never adds up
+				Travelled += Centimeters;
+				Centimeters = 0;
+				Current = Position{ From.X + DX * Travelled / LegLength, From.Y + DY * Travelled / LegLength, From.Z + DZ * Travelled / LegLength };
+			}
+			return Next < Route.size();
+		}
+
+		bool IsActive() const { return Next < Route.size(); }
+		const Position& GetPosition() const { return Current; }
+		const std::vector<CoordinateInBlocks>& GetRoute() const { return Route; }
+
+	private:
+		std::vector<CoordinateInBlocks> Route;
+		size_t Next = 1;
+		Position Current;
+		int64_t Travelled = 0;		// Along the current leg
+
+		static Position ToCentimeters(const CoordinateInBlocks& At) { return Position{ At.X * 50, At.Y * 50, int64_t(At.Z) * 50 }; }
+	};
+}
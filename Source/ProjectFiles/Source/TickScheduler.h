@@ -0,0 +1,155 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*******************************************************
+	Multi-rate tick scheduler.
+
+	The game calls Event_Tick at TickRate, the scheduler then runs every task whose period has come around. A task
+	runs every PeriodTicks host ticks, on the ticks where (Tick % PeriodTicks) == Phase, so expensive tasks with
+	the same period can be spread over different ticks.
+
+	Tasks run in the order they were added. A Deferrable task is pushed to the next tick while the current tick
+	has already used up TickBudgetMicroseconds, but never for longer than its own period. Runs that take longer
+	than the task's BudgetMicroseconds are counted, not interrupted.
+
+	If HostCallCounter is set, the number of host calls each task makes is counted from it as well.
+
+	Example:	scheduler.Add(L"save", 40, 2, 1000, true, 1, SaveData);
+				scheduler.RunTick();		every Event_Tick
+*******************************************************/
+
+namespace Scheduling {
+
+	using Clock = std::chrono::steady_clock;
+
+	struct TaskStats {
+		uint64_t Runs = 0;
+		uint64_t Deferrals = 0;
+		uint64_t OverBudget = 0;
+		uint64_t HostCalls = 0;
+		int64_t TotalMicroseconds = 0;
+		int64_t MaxMicroseconds = 0;
+
+		// Time between the starts of consecutive runs, this bounds how late the task can react to anything
+		uint64_t Intervals = 0;
+		int64_t IntervalTotalMicroseconds = 0;
+		int64_t IntervalMaxMicroseconds = 0;
+	};
+
+	struct Task {
+		const wchar_t* Name = L"";
+		uint32_t PeriodTicks = 1;
+		uint32_t Phase = 0;
+		int64_t BudgetMicroseconds = 0;
+		bool Deferrable = false;
+		double ReferenceRunsPerSecond = 0;	// How often this work ran before it was scheduled, only used for reports
+		std::function<void()> Run;
+
+		uint64_t DueTick = 0;
+		Clock::time_point LastStart;
+		TaskStats Stats;
+	};
+
+	class Scheduler
+	{
+	public:
+		explicit Scheduler(int64_t TickBudgetMicroseconds_, const uint64_t* HostCallCounter_ = nullptr)
+			: TickBudgetMicroseconds(TickBudgetMicroseconds_), HostCallCounter(HostCallCounter_) {}
+
+		size_t Add(const wchar_t* Name, uint32_t PeriodTicks, uint32_t Phase, int64_t BudgetMicroseconds, bool Deferrable,
+			double ReferenceRunsPerSecond, std::function<void()> Run)
+		{
+			Task NewTask;
+			NewTask.Name = Name;
+			NewTask.PeriodTicks = PeriodTicks > 0 ? PeriodTicks : 1;
+			NewTask.Phase = Phase % NewTask.PeriodTicks;
+			NewTask.BudgetMicroseconds = BudgetMicroseconds;
+			NewTask.Deferrable = Deferrable;
+			NewTask.ReferenceRunsPerSecond = ReferenceRunsPerSecond;
+			NewTask.Run = std::move(Run);
+			NewTask.DueTick = NextDueTick(NewTask, Tick);
+			Tasks.push_back(std::move(NewTask));
+			return Tasks.size() - 1;
+		}
+
+		void RunTick()
+		{
+			const Clock::time_point TickStart = Clock::now();
+			if (Tick == 0) FirstTick = TickStart;
+			LastTick = TickStart;
+
+			for (Task& Current : Tasks) {
+				if (Tick < Current.DueTick) continue;
+
+				const bool TickOverBudget = Microseconds(TickStart, Clock::now()) > TickBudgetMicroseconds;
+				if (Current.Deferrable && TickOverBudget && Tick - Current.DueTick < Current.PeriodTicks) {
+					Current.Stats.Deferrals++;
+					continue;
+				}
+
+				RunTask(Current);
+				Current.DueTick = NextDueTick(Current, Tick + 1);
+			}
+			Tick++;
+		}
+
+		const std::vector<Task>& GetTasks() const { return Tasks; }
+		bool IsEmpty() const { return Tasks.empty(); }
+		uint64_t GetTicks() const { return Tick; }
+
+		// Wall time from the first to the latest tick
+		double GetElapsedSeconds() const
+		{
+			return Tick < 2 ? 0.0 : double(Microseconds(FirstTick, LastTick)) / 1000000.0;
+		}
+
+	private:
+		std::vector<Task> Tasks;
+		uint64_t Tick = 0;
+		int64_t TickBudgetMicroseconds;
+		const uint64_t* HostCallCounter;
+		Clock::time_point FirstTick;
+		Clock::time_point LastTick;
+
+		static int64_t Microseconds(Clock::time_point From, Clock::time_point To)
+		{
+			return std::chrono::duration_cast<std::chrono::microseconds>(To - From).count();
+		}
+
+		// First tick at or after From that is on the task's phase
+		static uint64_t NextDueTick(const Task& Current, uint64_t From)
+		{
+			uint64_t Due = From - From % Current.PeriodTicks + Current.Phase;
+			return Due >= From ? Due : Due + Current.PeriodTicks;
+		}
+
+		void RunTask(Task& Current)
+		{
+			const uint64_t CallsBefore = HostCallCounter ? *HostCallCounter : 0;
+			const Clock::time_point Start = Clock::now();
+
+			Current.Run();
+
+			const int64_t Took = Microseconds(Start, Clock::now());
+			TaskStats& Stats = Current.Stats;
+
+			if (Stats.Runs > 0) {
+				const int64_t Interval = Microseconds(Current.LastStart, Start);
+				Stats.Intervals++;
+				Stats.IntervalTotalMicroseconds += Interval;
+				if (Interval > Stats.IntervalMaxMicroseconds) Stats.IntervalMaxMicroseconds = Interval;
+			}
+			Current.LastStart = Start;
+
+			Stats.Runs++;
+			Stats.TotalMicroseconds += Took;
+			if (Took > Stats.MaxMicroseconds) Stats.MaxMicroseconds = Took;
+			if (Current.BudgetMicroseconds > 0 && Took > Current.BudgetMicroseconds) Stats.OverBudget++;
+			if (HostCallCounter) Stats.HostCalls += *HostCallCounter - CallsBefore;
+		}
+	};
+}
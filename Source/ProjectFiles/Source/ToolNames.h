@@ -0,0 +1,229 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/*******************************************************
+	Compile time tool name lookup and (block, tool) dispatch.
+
+	The game names the tool in Event_BlockHitByTool and Event_AnyBlockHitByTool with a raw wchar_t string.
+	Classify maps it to a Tool with one pass over the characters, a perfect hash into a 32 slot table and a single
+	comparison against the one name that can be in that slot. The hash seed is searched for at compile time, so
+	adding a name that collides just picks another seed. Nothing is allocated.
+
+	ActionTable binds a function to a mod block and a tool family (every material of a tool does the same thing):
+
+		constexpr auto Table = Tools::MakeActionTable<1, 1>({ 50000 }, { { { 50000, Tools::Family::Stick, &Toggle } } });
+		static_assert(Table.Valid);
+		Table.Dispatch(CustomBlockID, Tools::Classify(ToolName), At);
+*******************************************************/
+
+namespace Tools {
+
+	enum class Tool : uint8_t {
+		Unknown,
+		Stick,
+		Arrow,
+		Pickaxe_Stone,
+		Pickaxe_Copper,
+		Pickaxe_Iron,
+		Axe_Stone,
+		Axe_Copper,
+		Axe_Iron,
+		Shovel_Stone,
+		Shovel_Copper,
+		Shovel_Iron,
+		Sledgehammer_Copper,
+		Sledgehammer_Iron,
+		Count
+	};
+
+	enum class Family : uint8_t {
+		None,
+		Stick,
+		Arrow,
+		Pickaxe,
+		Axe,
+		Shovel,
+		Sledgehammer,
+		Count
+	};
+
+	struct Name {
+		std::wstring_view Text;
+		Tool Kind;
+		Family Group;
+	};
+
+	// In Tool order, after Unknown
+	inline constexpr std::array<Name, size_t(Tool::Count) - 1> Names = { {
+		{ L"T_Stick", Tool::Stick, Family::Stick },
+		{ L"T_Arrow", Tool::Arrow, Family::Arrow },
+		{ L"T_Pickaxe_Stone", Tool::Pickaxe_Stone, Family::Pickaxe },
+		{ L"T_Pickaxe_Copper", Tool::Pickaxe_Copper, Family::Pickaxe },
+		{ L"T_Pickaxe_Iron", Tool::Pickaxe_Iron, Family::Pickaxe },
+		{ L"T_Axe_Stone", Tool::Axe_Stone, Family::Axe },
+		{ L"T_Axe_Copper", Tool::Axe_Copper, Family::Axe },
+		{ L"T_Axe_Iron", Tool::Axe_Iron, Family::Axe },
+		{ L"T_Shovel_Stone", Tool::Shovel_Stone, Family::Shovel },
+		{ L"T_Shovel_Copper", Tool::Shovel_Copper, Family::Shovel },
+		{ L"T_Shovel_Iron", Tool::Shovel_Iron, Family::Shovel },
+		{ L"T_Sledgehammer_Copper", Tool::Sledgehammer_Copper, Family::Sledgehammer },
+		{ L"T_Sledgehammer_Iron", Tool::Sledgehammer_Iron, Family::Sledgehammer },
+	} };
+
+	inline constexpr size_t Table_Bits = 5;
+	inline constexpr size_t Table_Size = size_t(1) << Table_Bits;
+	inline constexpr uint8_t Empty_Slot = 0xFF;
+
+	constexpr size_t MakeMaxNameLength()
+	{
+		size_t longest = 0;
+		for (const Name& entry : Names) longest = entry.Text.size() > longest ? entry.Text.size() : longest;
+		return longest;
+	}
+
+	inline constexpr size_t Max_Name_Length = MakeMaxNameLength();
+
+	// FNV-1a over the characters, then the top Table_Bits of a multiply by the seed
+	constexpr uint32_t Mix(uint32_t Hash, wchar_t Character)
+	{
+		return (Hash ^ uint32_t(Character)) * 16777619u;
+	}
+
+	constexpr size_t SlotOf(uint32_t Hash, uint32_t Seed)
+	{
+		return size_t((Hash * (Seed | 1)) >> (32 - Table_Bits));
+	}
+
+	constexpr uint32_t HashOf(std::wstring_view Text)
+	{
+		uint32_t hash = 2166136261u;
+		for (wchar_t character : Text) hash = Mix(hash, character);
+		return hash;
+	}
+
+	struct HashTable {
+		uint32_t Seed = 0;
+		std::array<uint8_t, Table_Size> Slots = {};		// Index into Names, or Empty_Slot
+		bool Found = false;
+	};
+
+	constexpr HashTable MakeHashTable()
+	{
+		HashTable table;
+		for (uint32_t seed = 1; seed < 100000; seed += 2) {
+			table.Slots.fill(Empty_Slot);
+			bool collided = false;
+			for (size_t i = 0; i < Names.size() && !collided; i++) {
+				uint8_t& slot = table.Slots[SlotOf(HashOf(Names[i].Text), seed)];
+				collided = slot != Empty_Slot;
+				slot = uint8_t(i);
+			}
+			if (!collided) {
+				table.Seed = seed;
+				table.Found = true;
+				return table;
+			}
+		}
+		return table;
+	}
+
+	inline constexpr HashTable Hashes = MakeHashTable();
+
+	static_assert(Hashes.Found, "No perfect hash seed for the tool names, raise Table_Bits");
+
+	constexpr Tool Classify(const wchar_t* ToolName)
+	{
+		if (ToolName == nullptr) return Tool::Unknown;
+
+		uint32_t hash = 2166136261u;
+		size_t length = 0;
+		for (; ToolName[length] != L'\0'; length++) {
+			if (length == Max_Name_Length) return Tool::Unknown;
+			hash = Mix(hash, ToolName[length]);
+		}
+
+		const uint8_t index = Hashes.Slots[SlotOf(hash, Hashes.Seed)];
+		if (index == Empty_Slot || Names[index].Text != std::wstring_view(ToolName, length)) return Tool::Unknown;
+		return Names[index].Kind;
+	}
+
+	constexpr Family FamilyOf(Tool Kind)
+	{
+		return Kind == Tool::Unknown || Kind == Tool::Count ? Family::None : Names[size_t(Kind) - 1].Group;
+	}
+
+	constexpr std::wstring_view NameOf(Tool Kind)
+	{
+		return Kind == Tool::Unknown || Kind == Tool::Count ? std::wstring_view(L"unknown") : Names[size_t(Kind) - 1].Text;
+	}
+
+	using Action = void (*)(ModAPI::CoordinateInBlocks At);
+
+	struct Binding {
+		ModAPI::UniqueID Block;
+		Family Tool;
+		Action Run;
+	};
+
+	template<size_t BlockCount>
+	struct ActionTable {
+		std::array<ModAPI::UniqueID, BlockCount> Blocks = {};
+		std::array<std::array<Action, size_t(Family::Count)>, BlockCount> Actions = {};
+		bool Valid = true;		// False if a binding names a block not in Blocks, or a (block, tool) is bound twice
+
+		// Runs what is bound to the block and tool, false if nothing is
+		bool Dispatch(ModAPI::UniqueID Block, Tool Kind, ModAPI::CoordinateInBlocks At) const
+		{
+			for (size_t row = 0; row < BlockCount; row++) {
+				if (Blocks[row] != Block) continue;
+
+				const Action run = Actions[row][size_t(FamilyOf(Kind))];
+				if (run == nullptr) return false;
+				run(At);
+				return true;
+			}
+			return false;
+		}
+	};
+
+	template<size_t BlockCount, size_t BindingCount>
+	constexpr ActionTable<BlockCount> MakeActionTable(const std::array<ModAPI::UniqueID, BlockCount>& Blocks, const std::array<Binding, BindingCount>& Bindings)
+	{
+		ActionTable<BlockCount> table;
+		table.Blocks = Blocks;
+
+		for (const Binding& binding : Bindings) {
+			size_t row = 0;
+			while (row < BlockCount && Blocks[row] != binding.Block) row++;
+
+			if (row == BlockCount || binding.Tool == Family::None || table.Actions[row][size_t(binding.Tool)] != nullptr) {
+				table.Valid = false;
+				continue;
+			}
+			table.Actions[row][size_t(binding.Tool)] = binding.Run;
+		}
+		return table;
+	}
+
+	constexpr bool NamesInToolOrder()
+	{
+		for (size_t i = 0; i < Names.size(); i++) {
+			if (Names[i].Kind != Tool(i + 1)) return false;
+		}
+		return true;
+	}
+
+	static_assert(NamesInToolOrder());
+	static_assert(Classify(L"T_Axe_Iron") == Tool::Axe_Iron);
+	static_assert(Classify(L"T_Sledgehammer_Copper") == Tool::Sledgehammer_Copper);
+	static_assert(Classify(L"T_Axe") == Tool::Unknown);
+	static_assert(Classify(L"T_Axe_Iron_") == Tool::Unknown);
+	static_assert(Classify(L"T_Sledgehammer_Copper_And_More") == Tool::Unknown);
+	static_assert(Classify(L"") == Tool::Unknown);
+	static_assert(FamilyOf(Tool::Shovel_Copper) == Family::Shovel);
+}
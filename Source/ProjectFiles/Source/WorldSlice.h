@@ -0,0 +1,306 @@
+#pragma once
+
+#include "GameFunctions.h"
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+/*******************************************************
+	World slices: a box of the real world saved to a file, so the benchmarks and the soak test can fly over the
+	block mix players actually have instead of generated terrain.
+
+	The box is cut into 16x16x16 chunks. The file has one palette of every distinct block in the slice, and each
+	chunk stores its own short list of palette indices plus one 0, 1, 2, 4, 8 or 16 bit index per cell, whichever
+	is the fewest bits that can tell its blocks apart. A chunk of nothing but air or stone is its 16 byte record
+	and one index. Bit widths are powers of two, so no index straddles two 64 bit words.
+
+	All offsets are from the start of the file and every part starts on 8 bytes, so Reader works directly on a
+	memory mapped file: Open only checks the header and the chunk records, and Get is a couple of loads.
+
+	Builder collects the blocks on the tick thread, Encode makes the file bytes and calls nothing in the game, so
+	it can run on a job worker:
+
+		Slices::Builder Slice(Origin, 8, 8, 4, PlayerAt);
+		Slice.Set(At, GetBlock(At));						for every cell
+		std::vector<uint8_t> Bytes = Slice.Encode();
+
+		Slices::Reader Reader;
+		if (Reader.Open(Mapped, MappedSize)) Block = Reader.Get(At);
+
+	Little endian only, like everything the game runs on.
+*******************************************************/
+
+namespace Slices {
+
+	using ModAPI::BlockInfo;
+	using ModAPI::CoordinateInBlocks;
+
+	inline constexpr int Chunk_Bits = 4;
+	inline constexpr int Chunk_Size = 1 << Chunk_Bits;
+	inline constexpr int Chunk_Volume = Chunk_Size * Chunk_Size * Chunk_Size;
+	inline constexpr uint32_t File_Magic = 0x4C535743;		// "CWSL"
+	inline constexpr uint32_t File_Version = 1;
+	inline constexpr size_t Max_Palette_Size = 65536;
+	inline constexpr uint32_t Max_Chunks_Across = 1 << 16;
+	inline constexpr uint32_t Max_Chunks_High = 1024;
+
+	struct FileHeader {
+		uint32_t Magic;
+		uint32_t Version;
+		int64_t OriginX;				// Lowest corner of the box, in blocks
+		int64_t OriginY;
+		int32_t OriginZ;
+		uint32_t PaletteSize;
+		uint32_t ChunksX;				// Size of the box, in chunks
+		uint32_t ChunksY;
+		uint32_t ChunksZ;
+		int32_t CenterZ;
+		int64_t CenterX;				// Where the player stood when it was captured
+		int64_t CenterY;
+		uint64_t PaletteOffset;			// PaletteSize PaletteEntry
+		uint64_t ChunksOffset;			// ChunksX * ChunksY * ChunksZ ChunkRecord, X fastest
+	};
+
+	struct PaletteEntry {
+		uint8_t Type;
+		uint8_t Rotation;
+		uint16_t Unused;
+		uint32_t CustomBlockID;
+	};
+
+	struct ChunkRecord {
+		uint64_t Offset;				// PaletteSize uint16_t palette indices, padded to 8 bytes, then the packed cells
+		uint32_t PaletteSize;
+		uint32_t Bits;
+	};
+
+	static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(PaletteEntry) == 8 && sizeof(ChunkRecord) == 16);
+
+	inline constexpr uint64_t AlignTo8(uint64_t Bytes) { return (Bytes + 7) & ~uint64_t(7); }
+
+	// Bytes after ChunkRecord::Offset
+	inline constexpr uint64_t ChunkBytes(uint32_t PaletteSize, uint32_t Bits)
+	{
+		return AlignTo8(uint64_t(PaletteSize) * sizeof(uint16_t)) + uint64_t(Chunk_Volume) * Bits / 8;
+	}
+
+	// Cell index inside its chunk, X fastest
+	inline constexpr uint32_t CellOf(int64_t X, int64_t Y, int64_t Z)
+	{
+		const int64_t Mask = Chunk_Size - 1;
+		return uint32_t((Z & Mask) << (2 * Chunk_Bits) | (Y & Mask) << Chunk_Bits | (X & Mask));
+	}
+
+	class Builder
+	{
+	public:
+		// Every cell starts out Invalid, the same as what GetBlock returns for chunks the game hasn't loaded
+		Builder(const CoordinateInBlocks& Origin_, uint32_t ChunksX_, uint32_t ChunksY_, uint32_t ChunksZ_, const CoordinateInBlocks& Center_)
+			: Origin(Origin_), Center(Center_), ChunksX(ChunksX_), ChunksY(ChunksY_), ChunksZ(ChunksZ_),
+			Cells(size_t(ChunksX_) * ChunksY_ * ChunksZ_ * Chunk_Volume, 0)
+		{
+			Palette.push_back(ToEntry(BlockInfo()));
+			PaletteIndex.emplace(KeyOf(Palette[0]), uint16_t(0));
+		}
+
+		bool Contains(const CoordinateInBlocks& At) const
+		{
+			const int64_t X = At.X - Origin.X, Y = At.Y - Origin.Y, Z = int64_t(At.Z) - Origin.Z;
+			return X >= 0 && Y >= 0 && Z >= 0 && X < int64_t(ChunksX) * Chunk_Size && Y < int64_t(ChunksY) * Chunk_Size &&
+				Z < int64_t(ChunksZ) * Chunk_Size;
+		}
+
+		// Outside the box it does nothing. Past Max_Palette_Size distinct blocks the new ones are stored as Invalid.
+		void Set(const CoordinateInBlocks& At, const BlockInfo& Block)
+		{
+			if (!Contains(At)) return;
+
+			const PaletteEntry Entry = ToEntry(Block);
+			auto [Found, Added] = PaletteIndex.try_emplace(KeyOf(Entry), uint16_t(Palette.size()));
+			if (Added) {
+				if (Palette.size() == Max_Palette_Size) {
+					PaletteIndex.erase(Found);
+					Dropped++;
+					return;
+				}
+				Palette.push_back(Entry);
+			}
+
+			const int64_t X = At.X - Origin.X, Y = At.Y - Origin.Y, Z = int64_t(At.Z) - Origin.Z;
+			const size_t Chunk = size_t(((Z >> Chunk_Bits) * ChunksY + (Y >> Chunk_Bits)) * ChunksX + (X >> Chunk_Bits));
+			Cells[Chunk * Chunk_Volume + CellOf(X, Y, Z)] = Found->second;
+		}
+
+		std::vector<uint8_t> Encode() const
+		{
+			const size_t ChunkCount = size_t(ChunksX) * ChunksY * ChunksZ;
+			FileHeader Header = {};
+			Header.Magic = File_Magic;
+			Header.Version = File_Version;
+			Header.OriginX = Origin.X;
+			Header.OriginY = Origin.Y;
+			Header.OriginZ = Origin.Z;
+			Header.PaletteSize = uint32_t(Palette.size());
+			Header.ChunksX = ChunksX;
+			Header.ChunksY = ChunksY;
+			Header.ChunksZ = ChunksZ;
+			Header.CenterX = Center.X;
+			Header.CenterY = Center.Y;
+			Header.CenterZ = Center.Z;
+			Header.PaletteOffset = sizeof(FileHeader);
+			Header.ChunksOffset = Header.PaletteOffset + Palette.size() * sizeof(PaletteEntry);
+
+			std::vector<uint8_t> Bytes(Header.ChunksOffset + ChunkCount * sizeof(ChunkRecord));
+			std::memcpy(Bytes.data(), &Header, sizeof(Header));
+			std::memcpy(Bytes.data() + Header.PaletteOffset, Palette.data(), Palette.size() * sizeof(PaletteEntry));
+
+			// Local index of each palette entry in the chunk being encoded, reset through Used after every chunk
+			std::vector<uint16_t> Local(Palette.size(), UINT16_MAX);
+			std::vector<uint16_t> Used;
+
+			for (size_t Chunk = 0; Chunk < ChunkCount; Chunk++) {
+				const uint16_t* Source = Cells.data() + Chunk * Chunk_Volume;
+				Used.clear();
+				for (int Cell = 0; Cell < Chunk_Volume; Cell++) {
+					if (Local[Source[Cell]] != UINT16_MAX) continue;
+					Local[Source[Cell]] = uint16_t(Used.size());
+					Used.push_back(Source[Cell]);
+				}
+
+				uint32_t Bits = 0;
+				while ((size_t(1) << Bits) < Used.size()) Bits = Bits == 0 ? 1 : Bits * 2;
+
+				const ChunkRecord Record = { Bytes.size(), uint32_t(Used.size()), Bits };
+				std::memcpy(Bytes.data() + Header.ChunksOffset + Chunk * sizeof(ChunkRecord), &Record, sizeof(Record));
+
+				Bytes.resize(Bytes.size() + ChunkBytes(Record.PaletteSize, Bits), 0);
+				uint8_t* Out = Bytes.data() + Record.Offset;
+				std::memcpy(Out, Used.data(), Used.size() * sizeof(uint16_t));
+
+				if (Bits > 0) {
+					uint64_t* Words = reinterpret_cast<uint64_t*>(Out + AlignTo8(Used.size() * sizeof(uint16_t)));
+					for (int Cell = 0; Cell < Chunk_Volume; Cell++) {
+						const uint64_t Position = uint64_t(Cell) * Bits;
+						Words[Position >> 6] |= uint64_t(Local[Source[Cell]]) << (Position & 63);
+					}
+				}
+				for (uint16_t Entry : Used) Local[Entry] = UINT16_MAX;
+			}
+			return Bytes;
+		}
+
+		size_t GetCellCount() const { return Cells.size(); }
+		size_t GetPaletteSize() const { return Palette.size(); }
+		size_t GetDroppedCount() const { return Dropped; }
+
+	private:
+		CoordinateInBlocks Origin;
+		CoordinateInBlocks Center;
+		uint32_t ChunksX, ChunksY, ChunksZ;
+
+		std::vector<uint16_t> Cells;		// Palette index of every cell, chunk by chunk
+		std::vector<PaletteEntry> Palette;
+		std::unordered_map<uint64_t, uint16_t> PaletteIndex;
+		size_t Dropped = 0;
+
+		static PaletteEntry ToEntry(const BlockInfo& Block)
+		{
+			return PaletteEntry{ uint8_t(Block.Type), uint8_t(Block.Rotation), 0, Block.CustomBlockID };
+		}
+
+		static uint64_t KeyOf(const PaletteEntry& Entry)
+		{
+			return uint64_t(Entry.Type) | uint64_t(Entry.Rotation) << 8 | uint64_t(Entry.CustomBlockID) << 32;
+		}
+	};
+
+	class Reader
+	{
+	public:
+		// False if Data isn't a whole slice file. Data is used where it is and has to outlive the Reader.
+		bool Open(const uint8_t* Data_, size_t Size)
+		{
+			Data = nullptr;
+			if (Data_ == nullptr || Size < sizeof(FileHeader) || reinterpret_cast<uintptr_t>(Data_) % 8 != 0) return false;
+
+			const FileHeader& Candidate = *reinterpret_cast<const FileHeader*>(Data_);
+			if (Candidate.Magic != File_Magic || Candidate.Version != File_Version) return false;
+			if (Candidate.PaletteSize == 0 || Candidate.PaletteSize > Max_Palette_Size) return false;
+			if (Candidate.PaletteOffset % 8 != 0 || Candidate.PaletteOffset > Size || (Size - Candidate.PaletteOffset) / sizeof(PaletteEntry) < Candidate.PaletteSize) return false;
+
+			const uint64_t ChunkCount = uint64_t(Candidate.ChunksX) * Candidate.ChunksY * Candidate.ChunksZ;
+			if (Candidate.ChunksX == 0 || Candidate.ChunksY == 0 || Candidate.ChunksZ == 0) return false;
+			if (Candidate.ChunksX > Max_Chunks_Across || Candidate.ChunksY > Max_Chunks_Across || Candidate.ChunksZ > Max_Chunks_High) return false;
+			if (Candidate.ChunksOffset % 8 != 0 || Candidate.ChunksOffset > Size || (Size - Candidate.ChunksOffset) / sizeof(ChunkRecord) < ChunkCount) return false;
+
+			const ChunkRecord* Records = reinterpret_cast<const ChunkRecord*>(Data_ + Candidate.ChunksOffset);
+			for (uint64_t Chunk = 0; Chunk < ChunkCount; Chunk++) {
+				const ChunkRecord& Record = Records[Chunk];
+				if (Record.Bits > 16 || (Record.Bits & (Record.Bits - 1)) != 0) return false;
+				if (Record.PaletteSize == 0 || Record.PaletteSize > (uint64_t(1) << Record.Bits)) return false;
+				if (Record.Offset % 8 != 0 || Record.Offset > Size || Size - Record.Offset < ChunkBytes(Record.PaletteSize, Record.Bits)) return false;
+
+				const uint16_t* Local = reinterpret_cast<const uint16_t*>(Data_ + Record.Offset);
+				for (uint32_t i = 0; i < Record.PaletteSize; i++) {
+					if (Local[i] >= Candidate.PaletteSize) return false;
+				}
+			}
+
+			Data = Data_;
+			Header = &Candidate;
+			Palette = reinterpret_cast<const PaletteEntry*>(Data_ + Candidate.PaletteOffset);
+			Chunks = Records;
+			return true;
+		}
+
+		bool IsOpen() const { return Data != nullptr; }
+
+		bool Contains(const CoordinateInBlocks& At) const
+		{
+			if (Data == nullptr) return false;
+			const int64_t X = At.X - Header->OriginX, Y = At.Y - Header->OriginY, Z = int64_t(At.Z) - Header->OriginZ;
+			return X >= 0 && Y >= 0 && Z >= 0 && X < int64_t(Header->ChunksX) * Chunk_Size && Y < int64_t(Header->ChunksY) * Chunk_Size &&
+				Z < int64_t(Header->ChunksZ) * Chunk_Size;
+		}
+
+		// Invalid outside the box
+		BlockInfo Get(const CoordinateInBlocks& At) const
+		{
+			if (!Contains(At)) return BlockInfo();
+
+			const int64_t X = At.X - Header->OriginX, Y = At.Y - Header->OriginY, Z = int64_t(At.Z) - Header->OriginZ;
+			const ChunkRecord& Record = Chunks[((Z >> Chunk_Bits) * Header->ChunksY + (Y >> Chunk_Bits)) * Header->ChunksX + (X >> Chunk_Bits)];
+			const uint16_t* Local = reinterpret_cast<const uint16_t*>(Data + Record.Offset);
+
+			uint32_t Index = 0;
+			if (Record.Bits > 0) {
+				const uint64_t* Words = reinterpret_cast<const uint64_t*>(Data + Record.Offset + AlignTo8(uint64_t(Record.PaletteSize) * sizeof(uint16_t)));
+				const uint64_t Position = uint64_t(CellOf(X, Y, Z)) * Record.Bits;
+				Index = uint32_t(Words[Position >> 6] >> (Position & 63)) & ((uint32_t(1) << Record.Bits) - 1);
+
+				// Open doesn't look at every cell, a damaged file still can't read past the chunk's palette
+				if (Index >= Record.PaletteSize) return BlockInfo();
+			}
+
+			const PaletteEntry& Entry = Palette[Local[Index]];
+			return BlockInfo(ModAPI::EBlockType(Entry.Type), ModAPI::ERotation(Entry.Rotation), Entry.CustomBlockID);
+		}
+
+		CoordinateInBlocks GetOrigin() const { return CoordinateInBlocks(Header->OriginX, Header->OriginY, int16_t(Header->OriginZ)); }
+		CoordinateInBlocks GetCenter() const { return CoordinateInBlocks(Header->CenterX, Header->CenterY, int16_t(Header->CenterZ)); }
+		CoordinateInBlocks GetSize() const
+		{
+			return CoordinateInBlocks(int64_t(Header->ChunksX) * Chunk_Size, int64_t(Header->ChunksY) * Chunk_Size, int16_t(Header->ChunksZ * Chunk_Size));
+		}
+		size_t GetPaletteSize() const { return Header->PaletteSize; }
+		size_t GetChunkCount() const { return size_t(Header->ChunksX) * Header->ChunksY * Header->ChunksZ; }
+
+	private:
+		const uint8_t* Data = nullptr;
+		const FileHeader* Header = nullptr;
+		const PaletteEntry* Palette = nullptr;
+		const ChunkRecord* Chunks = nullptr;
+	};
+}